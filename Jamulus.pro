@@ -377,6 +377,13 @@ FORMS_GUI = src/aboutdlgbase.ui \
 HEADERS += src/buffer.h \
     src/channel.h \
     src/global.h \
+    src/mixkernels.h \
+    src/mixmatrix.h \
+    src/channelmap.h \
+    src/iouring.h \
+    src/playout.h \
+    src/codecpool.h \
+    src/audioarena.h \
     src/protocol.h \
     src/recorder/jamcontroller.h \
     src/threadpool.h \
@@ -485,6 +492,12 @@ HEADERS_OPUS_X86 = libs/opus/celt/x86/celt_lpc_sse.h \
 SOURCES += src/buffer.cpp \
     src/channel.cpp \
     src/main.cpp \
+    src/mixkernels.cpp \
+    src/mixmatrix.cpp \
+    src/channelmap.cpp \
+    src/iouring.cpp \
+    src/codecpool.cpp \
+    src/audioarena.cpp \
     src/protocol.cpp \
     src/recorder/jamcontroller.cpp \
     src/server.cpp \
@@ -0,0 +1,69 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+
+#include "audioarena.h"
+
+/* Implementation *************************************************************/
+void CAudioArena::Allocate()
+{
+    // the memory is only allocated once
+    if ( pMemory != nullptr )
+    {
+        return;
+    }
+
+    // reserve one cache line more so that the first slab can be aligned
+    vecMemory.assign ( iSizeBytes + AUDIO_ARENA_ALIGNMENT_BYTES, 0 );
+
+    const uintptr_t iAddress = reinterpret_cast<uintptr_t> ( vecMemory.data() );
+
+    pMemory = vecMemory.data() + ( AlignUp ( iAddress ) - iAddress );
+
+    for ( size_t i = 0; i < vecRegions.size(); i++ )
+    {
+        vecRegions[i].SetBasePointer ( pMemory + vecRegions[i].iOffset );
+    }
+}
+
+QString CAudioArena::GetLayoutReport ( const int iNumChannels ) const
+{
+    QString strReport = QString ( "audio arena: %1 bytes in %2 regions, %3 bytes per channel\n" )
+                            .arg ( iSizeBytes )
+                            .arg ( vecRegions.size() )
+                            .arg ( iNumChannels > 0 ? iSizeBytes / iNumChannels : 0 );
+
+    for ( size_t i = 0; i < vecRegions.size(); i++ )
+    {
+        const SRegion& Region = vecRegions[i];
+
+        strReport += QString ( "  %1: offset %2, %3 slabs of %4 bytes\n" )
+                         .arg ( Region.strName, -28 )
+                         .arg ( Region.iOffset, 9 )
+                         .arg ( Region.iNumSlabs, 4 )
+                         .arg ( Region.iSlabBytes );
+    }
+
+    return strReport;
+}
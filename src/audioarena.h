@@ -0,0 +1,134 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+
+#pragma once
+
+#include <QString>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <cstdint>
+#include "global.h"
+
+/* Definitions ****************************************************************/
+// all slabs start at a cache line boundary
+#define AUDIO_ARENA_ALIGNMENT_BYTES 64
+
+/* Classes ********************************************************************/
+// Equally sized slabs of a region of the audio arena, the slab with index i is
+// accessed like a plain array with Slabs[i][j].
+template<typename TData>
+class CArenaSlabs
+{
+public:
+    CArenaSlabs() : pData ( nullptr ), iStride ( 0 ), iNumSlabs ( 0 ), iNumValues ( 0 ) {}
+
+    TData*       operator[] ( const int iIdx ) { return pData + static_cast<size_t> ( iIdx ) * iStride; }
+    const TData* operator[] ( const int iIdx ) const { return pData + static_cast<size_t> ( iIdx ) * iStride; }
+
+    int GetNumSlabs() const { return iNumSlabs; }
+    int GetNumValues() const { return iNumValues; }
+
+    // set all values of one slab to the given reset value
+    void Reset ( const int iIdx, const TData tResetVal ) { std::fill ( ( *this )[iIdx], ( *this )[iIdx] + iNumValues, tResetVal ); }
+
+protected:
+    friend class CAudioArena;
+
+    TData* pData;
+    int    iStride; // distance of the slabs in values
+    int    iNumSlabs;
+    int    iNumValues;
+};
+
+// Memory for the per-tick working set of the server. All buffers are placed in
+// a single allocation which is made at startup. Each kind of buffer is a
+// separate region (structure of arrays) and each slab of a region starts at a
+// cache line boundary, therefore threads which work on different channels or
+// use different scratch slabs never write to the same cache line.
+class CAudioArena
+{
+public:
+    CAudioArena() : pMemory ( nullptr ), iSizeBytes ( 0 ) {}
+
+    // add a region of iNumSlabs slabs with iNumValues values each, the slabs
+    // can only be accessed after Allocate() was called
+    template<typename TData>
+    void Reserve ( CArenaSlabs<TData>& Slabs, const QString& strName, const int iNumSlabs, const int iNumValues );
+
+    // allocate the memory for all reserved regions (initialized with zeros)
+    void Allocate();
+
+    size_t GetSizeBytes() const { return iSizeBytes; }
+
+    // human readable list of all regions
+    QString GetLayoutReport ( const int iNumChannels ) const;
+
+protected:
+    struct SRegion
+    {
+        QString                          strName;
+        int                              iNumSlabs;
+        size_t                           iSlabBytes;
+        size_t                           iOffset;
+        std::function<void ( uint8_t* )> SetBasePointer;
+    };
+
+    static size_t AlignUp ( const size_t iSize )
+    {
+        return ( iSize + AUDIO_ARENA_ALIGNMENT_BYTES - 1 ) / AUDIO_ARENA_ALIGNMENT_BYTES * AUDIO_ARENA_ALIGNMENT_BYTES;
+    }
+
+    std::vector<SRegion> vecRegions;
+    std::vector<uint8_t> vecMemory; // includes the space for the alignment of the first slab
+    uint8_t*             pMemory;
+    size_t               iSizeBytes;
+};
+
+/* Implementation *************************************************************/
+template<typename TData>
+void CAudioArena::Reserve ( CArenaSlabs<TData>& Slabs, const QString& strName, const int iNumSlabs, const int iNumValues )
+{
+    static_assert ( AUDIO_ARENA_ALIGNMENT_BYTES % sizeof ( TData ) == 0, "the values must not cross the slab alignment" );
+
+    SRegion Region;
+
+    Region.strName    = strName;
+    Region.iNumSlabs  = iNumSlabs;
+    Region.iSlabBytes = AlignUp ( iNumValues * sizeof ( TData ) );
+    Region.iOffset    = iSizeBytes;
+
+    const int iStride = static_cast<int> ( Region.iSlabBytes / sizeof ( TData ) );
+
+    Region.SetBasePointer = [&Slabs, iStride, iNumSlabs, iNumValues] ( uint8_t* pBase ) {
+        Slabs.pData      = reinterpret_cast<TData*> ( pBase );
+        Slabs.iStride    = iStride;
+        Slabs.iNumSlabs  = iNumSlabs;
+        Slabs.iNumValues = iNumValues;
+    };
+
+    iSizeBytes += Region.iSlabBytes * iNumSlabs;
+    vecRegions.push_back ( Region );
+}
@@ -35,68 +35,60 @@ void CNetBuf::Init ( const int iNewBlockSize, const int iNewNumBlocks, const boo
 
     // in simulation mode the size is not changed during operation -> we do
     // not have to implement special code for this case
-    // only enter the "preserve" branch, if object was already initialized
-    // and the block sizes are the same
-    if ( bPreserve && ( !bIsSimulation ) && bIsInitialized && ( iBlockSize == iNewBlockSize ) )
+    // only enter the "preserve" branch, if object was already initialized,
+    // the block sizes are the same and the new size fits in the allocated memory
+    if ( bPreserve && ( !bIsSimulation ) && bIsInitialized && ( iBlockSize == iNewBlockSize ) && ( iNewNumBlocks <= iNumBlocksCapacity ) )
     {
-        // extract all data from buffer in temporary storage
-        CVector<CVector<uint8_t>> vecvecTempMemory = vecvecMemory; // allocate worst case memory by copying
+        // The blocks are not copied, we only rotate the slot mapping (and the
+        // "valid block" indicators) so that the get position becomes the first
+        // block position. The slots behind the used block positions are free
+        // so that the buffer can grow without any memory allocation.
+        const int iOldNumBlocksMemory = iNumBlocksMemory;
+        int       iNumPreservedBlocks = iOldNumBlocksMemory;
 
         if ( !bNUseSequenceNumber )
         {
-            int iPreviousDataCnt = 0;
+            // only the available data is preserved (as much as the new buffer size can hold)
+            const int iPreviousDataCnt = GetAvailData() / iBlockSize;
 
-            while ( Get ( vecvecTempMemory[iPreviousDataCnt], iBlockSize ) )
-            {
-                iPreviousDataCnt++;
-            }
+            iNumPreservedBlocks = std::min ( iPreviousDataCnt, iNewNumBlocks );
+            iSequenceNumberAtGetPos += static_cast<uint8_t> ( iPreviousDataCnt );
+        }
 
-            // now resize the buffer to the new size (buffer is empty after this operation)
-            Resize ( iNewNumBlocks, iNewBlockSize );
+        std::rotate ( veciBlockSlot.begin(), veciBlockSlot.begin() + iBlockGetPos, veciBlockSlot.begin() + iOldNumBlocksMemory );
+        std::rotate ( veciBlockValid.begin(), veciBlockValid.begin() + iBlockGetPos, veciBlockValid.begin() + iOldNumBlocksMemory );
 
-            // copy the previous data back in the buffer (make sure we only copy as much
-            // data back as the new buffer size can hold)
-            int iDataCnt = 0;
+        // the block positions which are added are invalid
+        std::fill ( veciBlockValid.begin() + std::min ( iNewNumBlocks, iOldNumBlocksMemory ), veciBlockValid.begin() + iNewNumBlocks, 0 );
 
-            while ( ( iDataCnt < iPreviousDataCnt ) && Put ( vecvecTempMemory[iDataCnt], iBlockSize ) )
-            {
-                iDataCnt++;
-            }
-        }
-        else
+        iNumBlocksMemory = iNewNumBlocks;
+        iBlockGetPos     = 0; // per definition
+
+        if ( !bNUseSequenceNumber )
         {
-            // store current complete buffer state in temporary memory
-            CVector<int>  veciTempBlockValid ( iNumBlocksMemory );
-            const uint8_t iOldSequenceNumberAtGetPos = iSequenceNumberAtGetPos;
-            const int     iOldNumBlocksMemory        = iNumBlocksMemory;
-            const int     iOldBlockGetPos            = iBlockGetPos;
-            int           iCurBlockPos               = 0;
-
-            while ( iBlockGetPos < iNumBlocksMemory )
+            // the "valid block" indicators are not used without sequence numbers
+            std::fill ( veciBlockValid.begin(), veciBlockValid.begin() + iNewNumBlocks, 0 );
+
+            iBlockPutPos = iNumPreservedBlocks % iNewNumBlocks;
+
+            if ( iNumPreservedBlocks == 0 )
             {
-                veciTempBlockValid[iCurBlockPos] = veciBlockValid[iBlockGetPos];
-                vecvecTempMemory[iCurBlockPos++] = vecvecMemory[iBlockGetPos++];
+                eBufState = BS_EMPTY;
             }
-
-            for ( iBlockGetPos = 0; iBlockGetPos < iOldBlockGetPos; iBlockGetPos++ )
+            else if ( iNumPreservedBlocks == iNewNumBlocks )
             {
-                veciTempBlockValid[iCurBlockPos] = veciBlockValid[iBlockGetPos];
-                vecvecTempMemory[iCurBlockPos++] = vecvecMemory[iBlockGetPos];
+                eBufState = BS_FULL;
             }
-
-            // now resize the buffer to the new size
-            Resize ( iNewNumBlocks, iNewBlockSize );
-
-            // write back the temporary data in new memory
-            iSequenceNumberAtGetPos = iOldSequenceNumberAtGetPos;
-            iBlockGetPos            = 0; // per definition
-
-            for ( int iCurPos = 0; iCurPos < std::min ( iNewNumBlocks, iOldNumBlocksMemory ); iCurPos++ )
+            else
             {
-                veciBlockValid[iCurPos] = veciTempBlockValid[iCurPos];
-                vecvecMemory[iCurPos]   = vecvecTempMemory[iCurPos];
+                eBufState = BS_OK;
             }
         }
+        else
+        {
+            iBlockPutPos = 0;
+            eBufState    = BS_EMPTY;
+        }
     }
     else
     {
@@ -109,18 +101,38 @@ void CNetBuf::Init ( const int iNewBlockSize, const int iNewNumBlocks, const boo
 
 void CNetBuf::Resize ( const int iNewNumBlocks, const int iNewBlockSize )
 {
-    // allocate memory for actual data buffer
-    vecvecMemory.Init ( iNewNumBlocks );
-    veciBlockValid.Init ( iNewNumBlocks, 0 ); // initialize with zeros = invalid
-
-    if ( !bIsSimulation )
+    if ( !bIsInitialized || ( iNewBlockSize != iBlockSize ) || ( iNewNumBlocks > iNumBlocksCapacity ) )
     {
-        for ( int iBlock = 0; iBlock < iNewNumBlocks; iBlock++ )
+        // allocate one contiguous memory for the maximum buffer size (including
+        // the spare slot), the simulation buffer does not store any data
+        iNumBlocksCapacity = std::max ( iNewNumBlocks, MAX_NET_BUF_SIZE_NUM_BL );
+
+        // the consumer may still read the block handed out by GetInPlace(): its
+        // memory is retired (only once, a memory which is replaced again after
+        // that does not contain the lent block and can be freed)
+        if ( bBlockLent && !bLentBlockRetired )
         {
-            vecvecMemory[iBlock].Init ( iNewBlockSize );
+            vecbyRetiredMemory.swap ( vecbyMemory );
+            bLentBlockRetired = true;
         }
+
+        vecbyMemory.Init ( bIsSimulation ? 0 : ( iNumBlocksCapacity + 1 ) * iNewBlockSize );
+        veciBlockValid.Init ( iNumBlocksCapacity );
+        veciBlockSlot.Init ( iNumBlocksCapacity );
+
+        // map the block positions to all slots except the spare slot
+        for ( int iBlock = 0; iBlock < iNumBlocksCapacity; iBlock++ )
+        {
+            veciBlockSlot[iBlock] = iBlock;
+        }
+
+        iSpareSlot = iNumBlocksCapacity;
     }
 
+    // invalidate all blocks (the slot mapping is kept since the spare slot
+    // may still be in use)
+    std::fill ( veciBlockValid.begin(), veciBlockValid.begin() + iNewNumBlocks, 0 );
+
     // init buffer pointers and buffer state (empty buffer) and store buffer properties
     iBlockGetPos     = 0;
     iBlockPutPos     = 0;
@@ -129,7 +141,7 @@ void CNetBuf::Resize ( const int iNewNumBlocks, const int iNewBlockSize )
     iNumBlocksMemory = iNewNumBlocks;
 }
 
-bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
+bool CNetBuf::Put ( const uint8_t* pbyData, int iInSize )
 {
     // if the sequence number is used, we need a complete different way of applying
     // the new network packet
@@ -153,7 +165,7 @@ bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
 
             // extract sequence number of current received block (per definition
             // the sequence number is appended after the coded audio data)
-            const int iCurrentSequenceNumber = vecbyData[iBlockOffset + iBlockSize];
+            const int iCurrentSequenceNumber = pbyData[iBlockOffset + iBlockSize];
 
             // calculate the sequence number difference and take care of wrap
             int iSeqNumDiff = iCurrentSequenceNumber - static_cast<int> ( iSequenceNumberAtGetPos );
@@ -245,7 +257,7 @@ bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
             if ( !bIsSimulation )
             {
                 // copy one block of data in buffer
-                std::copy ( vecbyData.begin() + iBlockOffset, vecbyData.begin() + iBlockOffset + iBlockSize, vecvecMemory[iBlockPutPos].begin() );
+                std::copy ( pbyData + iBlockOffset, pbyData + iBlockOffset + iBlockSize, GetBlock ( iBlockPutPos ) );
             }
 
             // valid packet added, set flag
@@ -273,7 +285,7 @@ bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
                 const int iBlockOffset = iBlock * iBlockSize;
 
                 // copy one block of data in buffer
-                std::copy ( vecbyData.begin() + iBlockOffset, vecbyData.begin() + iBlockOffset + iBlockSize, vecvecMemory[iBlockPutPos].begin() );
+                std::copy ( pbyData + iBlockOffset, pbyData + iBlockOffset + iBlockSize, GetBlock ( iBlockPutPos ) );
             }
 
             // set the put position one block further
@@ -300,10 +312,70 @@ bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData, int iInSize )
     return true;
 }
 
+bool CNetBuf::IsNextBlockAvailable ( const int iOutSize ) const
+{
+    if ( ( iOutSize == 0 ) || ( iOutSize != iBlockSize ) || ( GetAvailData() < iOutSize ) )
+    {
+        return false;
+    }
+
+    // with sequence numbers the buffer is always full per definition, only
+    // the "valid block" indicator shows if the block was actually received
+    return !bUseSequenceNumber || ( veciBlockValid[iBlockGetPos] > 0 );
+}
+
+int CNetBuf::GetFillLevel() const
+{
+    if ( !bIsInitialized )
+    {
+        return 0;
+    }
+
+    if ( !bUseSequenceNumber )
+    {
+        return GetAvailData() / iBlockSize;
+    }
+
+    // with sequence numbers the buffer is always full per definition, search
+    // for the newest block which was actually received
+    for ( int iNumBlocks = iNumBlocksMemory; iNumBlocks > 0; iNumBlocks-- )
+    {
+        if ( veciBlockValid[( iBlockGetPos + iNumBlocks - 1 ) % iNumBlocksMemory] > 0 )
+        {
+            return iNumBlocks;
+        }
+    }
+
+    return 0;
+}
+
 bool CNetBuf::Get ( CVector<uint8_t>& vecbyData, const int iOutSize )
+{
+    const uint8_t* pbyBlock;
+
+    // (no virtual call, the statistics of a derived class must only be updated once)
+    const bool bReturn = CNetBuf::GetInPlace ( pbyBlock, iOutSize );
+
+    // copy data from internal buffer in output buffer
+    if ( pbyBlock != nullptr )
+    {
+        std::copy ( pbyBlock, pbyBlock + iBlockSize, vecbyData.begin() );
+    }
+
+    return bReturn;
+}
+
+bool CNetBuf::GetInPlace ( const uint8_t*& pbyData, const int iOutSize )
 {
     bool bReturn = true;
 
+    pbyData = nullptr;
+
+    // the consumer does not use the previously returned block anymore (the
+    // retired memory is freed with the next reallocation)
+    bBlockLent        = false;
+    bLentBlockRetired = false;
+
     // check requested output size and available buffer data
     if ( ( iOutSize == 0 ) || ( iOutSize != iBlockSize ) || ( GetAvailData() < iOutSize ) )
     {
@@ -320,11 +392,18 @@ bool CNetBuf::Get ( CVector<uint8_t>& vecbyData, const int iOutSize )
         veciBlockValid[iBlockGetPos] = 0; // zero means invalid
     }
 
-    // for simultion buffer or invalid block only update pointer, no data copying
+    // for simultion buffer or invalid block only update pointer, no data access
     if ( !bIsSimulation && bReturn )
     {
-        // copy data from internal buffer in output buffer
-        std::copy ( vecvecMemory[iBlockGetPos].begin(), vecvecMemory[iBlockGetPos].begin() + iBlockSize, vecbyData.begin() );
+        // hand out the block and take the spare slot for this block position
+        // instead so that the block is not overwritten until the next call
+        const int iSlot = veciBlockSlot[iBlockGetPos];
+
+        veciBlockSlot[iBlockGetPos] = iSpareSlot;
+        iSpareSlot                  = iSlot;
+        bBlockLent                  = true;
+
+        pbyData = &vecbyMemory[static_cast<size_t> ( iSlot ) * iBlockSize];
     }
 
     // set the get position and sequence number one block further
@@ -399,6 +478,78 @@ int CNetBuf::GetAvailData() const
     return iAvBlocks * iBlockSize;
 }
 
+/* Histogram jitter estimator implementation *********************************/
+void CJitterHistogram::Init ( const int iNewHistoryLength )
+{
+    iHistoryLength = std::max ( 1, iNewHistoryLength );
+    vecbyHistory.Init ( iHistoryLength );
+
+    Reset();
+}
+
+void CJitterHistogram::Reset()
+{
+    for ( int i = 0; i < JITTER_HIST_NUM_BINS; i++ )
+    {
+        viBinCount[i] = 0;
+    }
+
+    iHistoryIdx = 0;
+    iNorm       = 0;
+    dRelDelay   = 0.0;
+}
+
+void CJitterHistogram::Get()
+{
+    // the buffer sizes up to the current relative delay would run empty now
+    const int iBin = std::min ( static_cast<int> ( dRelDelay ), JITTER_HIST_NUM_BINS - 1 );
+
+    // replace the oldest value of the statistic window
+    if ( iNorm < iHistoryLength )
+    {
+        iNorm++;
+    }
+    else
+    {
+        viBinCount[vecbyHistory[iHistoryIdx]]--;
+    }
+
+    vecbyHistory[iHistoryIdx] = static_cast<uint8_t> ( iBin );
+    viBinCount[iBin]++;
+
+    if ( ++iHistoryIdx == iHistoryLength )
+    {
+        iHistoryIdx = 0;
+    }
+
+    // one block is consumed and the reference slowly moves towards the arrivals
+    dRelDelay += 1.0 - JITTER_HIST_REF_LEAK;
+}
+
+void CJitterHistogram::GetErrorRates ( const int* piBufSizes, double* pdErrRates, const int iNumSizes ) const
+{
+    // Cumulate the histogram from the largest delay downwards, the buffer sizes
+    // are in ascending order. A real buffer does not stay at the ideal fill
+    // level relative to the reference (it is shifted by each underrun and
+    // overflow), replaying traces showed that a buffer of N blocks behaves like
+    // the ideal one with N - 1 blocks.
+    int iTailCount = 0;
+    int iCurBin    = JITTER_HIST_NUM_BINS;
+
+    for ( int i = iNumSizes - 1; i >= 0; i-- )
+    {
+        const int iMaxDelay = std::max ( 0, std::min ( piBufSizes[i] - 1, JITTER_HIST_NUM_BINS - 1 ) );
+
+        while ( iCurBin > iMaxDelay )
+        {
+            iTailCount += viBinCount[--iCurBin];
+        }
+
+        // use the "no data result" of the moving average (worst error rate)
+        pdErrRates[i] = ( iNorm == 0 ) ? 1.0 : static_cast<double> ( iTailCount ) / iNorm;
+    }
+}
+
 /* Network buffer with statistic calculations implementation ******************/
 CNetBufWithStats::CNetBufWithStats() :
     CNetBuf ( false ), // base class init: no simulation mode
@@ -409,7 +560,8 @@ CNetBufWithStats::CNetBufWithStats() :
     dAutoFilt_WightUpFast ( IIR_WEIGTH_UP_FAST ),
     dAutoFilt_WightDownFast ( IIR_WEIGTH_DOWN_FAST ),
     dErrorRateBound ( ERROR_RATE_BOUND ),
-    dUpMaxErrorBound ( UP_MAX_ERROR_BOUND )
+    dUpMaxErrorBound ( UP_MAX_ERROR_BOUND ),
+    bUseJitterHistogram ( false )
 {
     // Define the sizes of the simulation buffers,
     // must be NUM_STAT_SIMULATION_BUFFERS elements!
@@ -431,17 +583,19 @@ CNetBufWithStats::CNetBufWithStats() :
     for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
     {
         SimulationBuffer[i].SetIsSimulation ( true );
+        vdErrorRates[i] = 1.0; // worst error rate possible
     }
 }
 
 void CNetBufWithStats::GetErrorRates ( CVector<double>& vecErrRates, double& dLimit, double& dMaxUpLimit )
 {
-    // get all the averages of the error statistic
+    // get all the averages of the error statistic (as used by the last
+    // auto setting update)
     vecErrRates.Init ( NUM_STAT_SIMULATION_BUFFERS );
 
     for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
     {
-        vecErrRates[i] = ErrorRateStatistic[i].GetAverage();
+        vecErrRates[i] = vdErrorRates[i];
     }
 
     // get the limits for the decisions
@@ -479,13 +633,27 @@ void CNetBufWithStats::Init ( const int iNewBlockSize, const int iNewNumBlocks,
             dUpMaxErrorBound          = UP_MAX_ERROR_BOUND;
         }
 
-        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        if ( bUseJitterHistogram )
+        {
+            // the histogram is only updated on Get(), i.e. half the number of
+            // buffer accesses of the simulation statistic
+            JitterHistogram.Init ( iMaxStatisticCount / 2 );
+        }
+        else
         {
-            // init simulation buffers with the correct size
-            SimulationBuffer[i].Init ( iNewBlockSize, viBufSizesForSim[i], bNUseSequenceNumber );
+            for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+            {
+                // init simulation buffers with the correct size
+                SimulationBuffer[i].Init ( iNewBlockSize, viBufSizesForSim[i], bNUseSequenceNumber );
+
+                // init statistics
+                ErrorRateStatistic[i].Init ( iMaxStatisticCount, true );
+            }
+        }
 
-            // init statistics
-            ErrorRateStatistic[i].Init ( iMaxStatisticCount, true );
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            vdErrorRates[i] = 1.0; // worst error rate possible
         }
 
         // reset the initialization counter which controls the initialization
@@ -509,15 +677,23 @@ void CNetBufWithStats::ResetInitCounter()
     iInitCounter = iMaxStatisticCount / 4;
 }
 
-bool CNetBufWithStats::Put ( const CVector<uint8_t>& vecbyData, const int iInSize )
+bool CNetBufWithStats::Put ( const uint8_t* pbyData, const int iInSize )
 {
     // call base class Put
-    const bool bPutOK = CNetBuf::Put ( vecbyData, iInSize );
+    const bool bPutOK = CNetBuf::Put ( pbyData, iInSize );
 
     // update statistics calculations
-    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+    if ( bUseJitterHistogram )
+    {
+        // same block count as in the base class (also with sequence numbers)
+        JitterHistogram.Put ( iInSize / iBlockSize );
+    }
+    else
     {
-        ErrorRateStatistic[i].Update ( !SimulationBuffer[i].Put ( vecbyData, iInSize ) );
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            ErrorRateStatistic[i].Update ( !SimulationBuffer[i].Put ( pbyData, iInSize ) );
+        }
     }
 
     return bPutOK;
@@ -528,16 +704,72 @@ bool CNetBufWithStats::Get ( CVector<uint8_t>& vecbyData, const int iOutSize )
     // call base class Get
     const bool bGetOK = CNetBuf::Get ( vecbyData, iOutSize );
 
+    UpdateGetStatistics ( iOutSize );
+
+    return bGetOK;
+}
+
+bool CNetBufWithStats::GetInPlace ( const uint8_t*& pbyData, const int iOutSize )
+{
+    // call base class GetInPlace
+    const bool bGetOK = CNetBuf::GetInPlace ( pbyData, iOutSize );
+
+    UpdateGetStatistics ( iOutSize );
+
+    return bGetOK;
+}
+
+void CNetBufWithStats::UpdateGetStatistics ( const int iOutSize )
+{
     // update statistics calculations
-    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+    if ( bUseJitterHistogram )
     {
-        ErrorRateStatistic[i].Update ( !SimulationBuffer[i].Get ( vecbyData, iOutSize ) );
+        JitterHistogram.Get();
+    }
+    else
+    {
+        // the simulation buffers do not store any data
+        const uint8_t* pbyUnused;
+
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            ErrorRateStatistic[i].Update ( !SimulationBuffer[i].GetInPlace ( pbyUnused, iOutSize ) );
+        }
     }
 
     // update auto setting
     UpdateAutoSetting();
+}
 
-    return bGetOK;
+void CNetBufWithStats::UpdateErrorRates()
+{
+    if ( bUseJitterHistogram )
+    {
+        // all error rates are derived from the delay histogram at once
+        JitterHistogram.GetErrorRates ( viBufSizesForSim, vdErrorRates, NUM_STAT_SIMULATION_BUFFERS );
+    }
+    else
+    {
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            vdErrorRates[i] = ErrorRateStatistic[i].GetAverage();
+        }
+    }
+}
+
+void CNetBufWithStats::ResetStatistics()
+{
+    if ( bUseJitterHistogram )
+    {
+        JitterHistogram.Reset();
+    }
+    else
+    {
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            ErrorRateStatistic[i].Reset();
+        }
+    }
 }
 
 void CNetBufWithStats::UpdateAutoSetting()
@@ -546,6 +778,8 @@ void CNetBufWithStats::UpdateAutoSetting()
     int  iCurMaxUpDecision = 0; // dummy initialization
     bool bDecisionFound;
 
+    UpdateErrorRates();
+
     // Get regular error rate decision -----------------------------------------
     // Use a specified error bound to identify the best buffer size for the
     // current network situation. Start with the smallest buffer and
@@ -554,7 +788,7 @@ void CNetBufWithStats::UpdateAutoSetting()
 
     for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS - 1; i++ )
     {
-        if ( ( !bDecisionFound ) && ( ErrorRateStatistic[i].GetAverage() <= dErrorRateBound ) )
+        if ( ( !bDecisionFound ) && ( vdErrorRates[i] <= dErrorRateBound ) )
         {
             iCurDecision   = viBufSizesForSim[i];
             bDecisionFound = true;
@@ -576,7 +810,7 @@ void CNetBufWithStats::UpdateAutoSetting()
 
     for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS - 1; i++ )
     {
-        if ( ( !bDecisionFound ) && ( ErrorRateStatistic[i].GetAverage() <= dUpMaxErrorBound ) )
+        if ( ( !bDecisionFound ) && ( vdErrorRates[i] <= dUpMaxErrorBound ) )
         {
             iCurMaxUpDecision = viBufSizesForSim[i];
             bDecisionFound    = true;
@@ -666,12 +900,9 @@ void CNetBufWithStats::UpdateAutoSetting()
     if ( iInitCounter == iMaxStatisticCount / 8 )
     {
         // check error rate of the largest buffer as the indicator
-        if ( ErrorRateStatistic[NUM_STAT_SIMULATION_BUFFERS - 1].GetAverage() > dErrorRateBound )
+        if ( vdErrorRates[NUM_STAT_SIMULATION_BUFFERS - 1] > dErrorRateBound )
         {
-            for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
-            {
-                ErrorRateStatistic[i].Reset();
-            }
+            ResetStatistics();
         }
     }
 }
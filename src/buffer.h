@@ -68,6 +68,16 @@
 #define IIR_WEIGTH_UP_FAST     0.9997499687422
 #define IIR_WEIGTH_DOWN_FAST   0.999499875
 
+// histogram jitter estimator: number of relative delay bins in blocks (the last
+// bin collects all larger delays, it must be larger than the largest simulated
+// buffer size)
+#define JITTER_HIST_NUM_BINS 13
+
+// the arrival reference of the histogram jitter estimator follows the latest
+// peak of the arrivals and leaks by this number of blocks per Get() so that a
+// sample rate offset between sender and receiver does not accumulate
+#define JITTER_HIST_REF_LEAK 0.0005
+
 /* Classes ********************************************************************/
 // Buffer base class -----------------------------------------------------------
 template<class TData>
@@ -233,15 +243,35 @@ protected:
 class CNetBuf
 {
 public:
-    CNetBuf ( const bool bNIsSim = false ) : iSequenceNumberAtGetPos ( 0 ), bIsSimulation ( bNIsSim ), bIsInitialized ( false ) {}
+    CNetBuf ( const bool bNIsSim = false ) :
+        iSpareSlot ( 0 ),
+        bBlockLent ( false ),
+        bLentBlockRetired ( false ),
+        iSequenceNumberAtGetPos ( 0 ),
+        bIsSimulation ( bNIsSim ),
+        bIsInitialized ( false )
+    {}
 
     void Init ( const int iNewBlockSize, const int iNewNumBlocks, const bool bNUseSequenceNumber, const bool bPreserve = false );
 
     void SetIsSimulation ( const bool bNIsSim ) { bIsSimulation = bNIsSim; }
 
-    virtual bool Put ( const CVector<uint8_t>& vecbyData, int iInSize );
+    virtual bool Put ( const uint8_t* pbyData, int iInSize );
     virtual bool Get ( CVector<uint8_t>& vecbyData, const int iOutSize );
 
+    // Same as Get() but without copying: the returned pointer refers to the
+    // block in the buffer (nullptr if the block was not received) and stays
+    // valid until the next Get()/GetInPlace() call. Neither Put() nor Init()
+    // writes to this block in the meantime.
+    virtual bool GetInPlace ( const uint8_t*& pbyData, const int iOutSize );
+
+    // true if the block at the get position was received (Get() would not conceal it)
+    bool IsNextBlockAvailable ( const int iOutSize ) const;
+
+    // number of blocks from the get position up to the newest block in the
+    // buffer (with sequence numbers up to the newest received block)
+    int GetFillLevel() const;
+
 protected:
     enum EBufState
     {
@@ -254,21 +284,70 @@ protected:
     int  GetAvailData() const;
     void Resize ( const int iNewNumBlocks, const int iNewBlockSize );
 
-    CVector<CVector<uint8_t>> vecvecMemory;
-    CVector<int>              veciBlockValid;
-    int                       iNumBlocksMemory;
-    int                       iBlockGetPos;
-    int                       iBlockPutPos;
-    int                       iBlockSize;
-    uint8_t                   iSequenceNumberAtGetPos; // uint8_t so that it wraps automatically
-    EBufState                 eBufState;
-    bool                      bUseSequenceNumber;
-    bool                      bIsSimulation;
-    bool                      bIsInitialized;
+    uint8_t* GetBlock ( const int iBlockPos ) { return &vecbyMemory[static_cast<size_t> ( veciBlockSlot[iBlockPos] ) * iBlockSize]; }
+
+    // All blocks are stored in one contiguous memory with one spare slot. The
+    // block positions of the buffer are mapped to the slots, GetInPlace()
+    // swaps the slot of the block it returns with the spare slot. The memory
+    // is allocated for the maximum buffer size so that a resize only changes
+    // the mapping. If the memory is reallocated while the block returned by
+    // GetInPlace() is still lent to the consumer, the memory of this block is
+    // retired and kept until the next Get()/GetInPlace() call.
+    CVector<uint8_t> vecbyMemory;
+    CVector<uint8_t> vecbyRetiredMemory;
+    CVector<int>     veciBlockSlot;
+    int              iSpareSlot;
+    bool             bBlockLent;        // the spare slot or the retired memory is in use by the consumer
+    bool             bLentBlockRetired; // the lent block is in the retired memory
+    CVector<int>     veciBlockValid;
+    int              iNumBlocksMemory;
+    int              iNumBlocksCapacity;
+    int              iBlockGetPos;
+    int              iBlockPutPos;
+    int              iBlockSize;
+    uint8_t          iSequenceNumberAtGetPos; // uint8_t so that it wraps automatically
+    EBufState        eBufState;
+    bool             bUseSequenceNumber;
+    bool             bIsSimulation;
+    bool             bIsInitialized;
 
     static constexpr int iNumBytesSeqNum = 1; // per definition 1 byte sequence counter
 };
 
+// Histogram jitter estimator -------------------------------------------------
+// Instead of simulating one buffer per candidate size, the relative delay of
+// the arrivals (in blocks) is measured at each Get() against a reference which
+// follows the earliest arrivals. A buffer runs empty if the relative delay
+// exceeds its size, so the error rate of every candidate size is the upper
+// tail of the delay histogram over the statistic window.
+class CJitterHistogram
+{
+public:
+    CJitterHistogram() : iHistoryLength ( 0 ) {}
+
+    void Init ( const int iNewHistoryLength );
+    void Reset();
+
+    void Put ( const int iNumBlocks )
+    {
+        // an arrival which is earlier than the reference becomes the new reference
+        dRelDelay = std::max ( 0.0, dRelDelay - iNumBlocks );
+    }
+
+    void Get();
+
+    // error rate of each of the given buffer sizes (1.0 if no data is available)
+    void GetErrorRates ( const int* piBufSizes, double* pdErrRates, const int iNumSizes ) const;
+
+protected:
+    CVector<uint8_t> vecbyHistory; // delay bins of the statistic window
+    int              viBinCount[JITTER_HIST_NUM_BINS];
+    int              iHistoryLength;
+    int              iHistoryIdx;
+    int              iNorm;
+    double           dRelDelay;
+};
+
 // Network buffer (jitter buffer) with statistic calculations ------------------
 class CNetBufWithStats : public CNetBuf
 {
@@ -279,21 +358,34 @@ public:
 
     void SetUseDoubleSystemFrameSize ( const bool bNDSFSize ) { bUseDoubleSystemFrameSize = bNDSFSize; }
 
-    virtual bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize );
+    // selects the histogram jitter estimator instead of the simulation buffers
+    // (NOTE must be set BEFORE the init())
+    void SetUseJitterHistogram ( const bool bNUseJitterHistogram ) { bUseJitterHistogram = bNUseJitterHistogram; }
+    bool GetUseJitterHistogram() const { return bUseJitterHistogram; }
+
+    virtual bool Put ( const uint8_t* pbyData, int iInSize );
     virtual bool Get ( CVector<uint8_t>& vecbyData, const int iOutSize );
+    virtual bool GetInPlace ( const uint8_t*& pbyData, const int iOutSize );
 
     int  GetAutoSetting() { return iCurAutoBufferSizeSetting; }
     void GetErrorRates ( CVector<double>& vecErrRates, double& dLimit, double& dMaxUpLimit );
 
 protected:
+    void UpdateGetStatistics ( const int iOutSize );
     void UpdateAutoSetting();
+    void UpdateErrorRates();
     void ResetInitCounter();
+    void ResetStatistics();
 
     // statistic (do not use the vector class since the classes do not have
     // appropriate copy constructor/operator)
     CErrorRate ErrorRateStatistic[NUM_STAT_SIMULATION_BUFFERS];
     CNetBuf    SimulationBuffer[NUM_STAT_SIMULATION_BUFFERS];
     int        viBufSizesForSim[NUM_STAT_SIMULATION_BUFFERS];
+    double     vdErrorRates[NUM_STAT_SIMULATION_BUFFERS];
+
+    // replaces the simulation buffers if bUseJitterHistogram is set
+    CJitterHistogram JitterHistogram;
 
     double dCurIIRFilterResult;
     int    iCurDecidedResult;
@@ -308,6 +400,7 @@ protected:
     double dAutoFilt_WightDownFast;
     double dErrorRateBound;
     double dUpMaxErrorBound;
+    bool   bUseJitterHistogram;
 };
 
 // Conversion buffer (very simple buffer) --------------------------------------
@@ -346,16 +439,23 @@ public:
         }
     }
 
-    void PutAll ( const CVector<TData>& vecsData )
+    void PutAll ( const CVector<TData>& vecsData ) { PutAll ( vecsData.data() ); }
+
+    void PutAll ( const TData* pData )
     {
         iGetPos = 0;
 
-        std::copy ( vecsData.begin(),
-                    vecsData.begin() + iBufferSize, // note that input vector might be larger then memory size
+        std::copy ( pData,
+                    pData + iBufferSize, // note that input vector might be larger then memory size
                     vecMemory.begin() );
     }
 
     bool Put ( const CVector<TData>& vecData, const int iVecSize, const TData SequenceNumber = 0 )
+    {
+        return Put ( vecData.data(), iVecSize, SequenceNumber );
+    }
+
+    bool Put ( const TData* pData, const int iVecSize, const TData SequenceNumber = 0 )
     {
         // calculate the end position after copying
         int iEnd = iPutPos + iVecSize;
@@ -370,7 +470,7 @@ public:
         if ( iEnd <= iBufferSize )
         {
             // copy new data in internal buffer
-            std::copy ( vecData.begin(), vecData.begin() + iVecSize, vecMemory.begin() + iPutPos );
+            std::copy ( pData, pData + iVecSize, vecMemory.begin() + iPutPos );
 
             // add optional sequence number (NOTE that we currently
             // only support a single sequence number per packet)
@@ -397,15 +497,19 @@ public:
         return vecMemory;
     }
 
-    void GetAll ( CVector<TData>& vecsData, const int iVecSize )
+    void GetAll ( CVector<TData>& vecsData, const int iVecSize ) { GetAll ( vecsData.data(), iVecSize ); }
+
+    void GetAll ( TData* pData, const int iVecSize )
     {
         iPutPos = 0;
 
         // copy data from internal buffer in given buffer
-        std::copy ( vecMemory.begin(), vecMemory.begin() + iVecSize, vecsData.begin() );
+        std::copy ( vecMemory.begin(), vecMemory.begin() + iVecSize, pData );
     }
 
-    bool Get ( CVector<TData>& vecsData, const int iVecSize )
+    bool Get ( CVector<TData>& vecsData, const int iVecSize ) { return Get ( vecsData.data(), iVecSize ); }
+
+    bool Get ( TData* pData, const int iVecSize )
     {
         // calculate the input size and the end position after copying
         const int iEnd = iGetPos + iVecSize;
@@ -414,7 +518,7 @@ public:
         if ( iEnd <= iBufferSize )
         {
             // copy new data from internal buffer
-            std::copy ( vecMemory.begin() + iGetPos, vecMemory.begin() + iGetPos + iVecSize, vecsData.begin() );
+            std::copy ( vecMemory.begin() + iGetPos, vecMemory.begin() + iGetPos + iVecSize, pData );
 
             // set buffer pointer one block further
             iGetPos = iEnd;
@@ -38,6 +38,7 @@ CChannel::CChannel ( const bool bNIsServer ) :
     bIsServer ( bNIsServer ),
     bIsIdentified ( false ),
     iAudioFrameSizeSamples ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES ),
+    iCodecConfigVersion ( 0 ),
     SignalLevelMeter ( false, 0.5 ) // server mode with mono out and faster smoothing
 {
     // reset network transport properties
@@ -189,6 +190,8 @@ void CChannel::SetAudioStreamProperties ( const EAudComprType eNewAudComprType,
             iNetwFrameSize = iCeltNumCodedBytes;
         }
 
+        UpdateCodecConfig();
+
         // update audio frame size
         if ( eAudioCompressionType == CT_OPUS )
         {
@@ -394,9 +397,17 @@ void CChannel::OnJittBufSizeChange ( int iNewJitBufSize )
     }
 }
 
-void CChannel::OnChangeChanGain ( int iChanID, float fNewGain ) { SetGain ( iChanID, fNewGain ); }
+void CChannel::OnChangeChanGain ( int iChanID, float fNewGain )
+{
+    SetGain ( iChanID, fNewGain );
+    emit ChanGainHasChanged ( iChanID, fNewGain );
+}
 
-void CChannel::OnChangeChanPan ( int iChanID, float fNewPan ) { SetPan ( iChanID, fNewPan ); }
+void CChannel::OnChangeChanPan ( int iChanID, float fNewPan )
+{
+    SetPan ( iChanID, fNewPan );
+    emit ChanPanHasChanged ( iChanID, fNewPan );
+}
 
 void CChannel::OnChangeChanInfo ( CChannelCoreInfo ChanInfo ) { SetChanInfo ( ChanInfo ); }
 
@@ -430,6 +441,8 @@ void CChannel::OnNetTranspPropsReceived ( CNetworkTransportProps NetworkTranspor
                 iCeltNumCodedBytes = iNetwFrameSize;
             }
 
+            UpdateCodecConfig();
+
             // update maximum number of frames for fade in counter (only needed for server)
             // and audio frame size
             if ( eAudioCompressionType == CT_OPUS )
@@ -464,6 +477,22 @@ void CChannel::OnNetTranspPropsReceived ( CNetworkTransportProps NetworkTranspor
             MutexConvBuf.unlock();
         }
         Mutex.unlock();
+
+        // the server has to provide the codec for the new properties
+        emit NetTranspPropsHaveChanged();
+    }
+}
+
+void CChannel::UpdateCodecConfig()
+{
+    // note that the mutex must be locked when calling this function
+    const CCodecConfig NewCodecConfig ( eAudioCompressionType, iNumAudioChannels, iCeltNumCodedBytes );
+
+    // the encoder settings are only updated if the configuration has changed
+    if ( NewCodecConfig != CodecConfig )
+    {
+        CodecConfig = NewCodecConfig;
+        iCodecConfigVersion.fetch_add ( 1, std::memory_order_release );
     }
 }
 
@@ -526,7 +555,7 @@ void CChannel::PutProtocolData ( const int iRecCounter, const int iRecID, const
     }
 }
 
-EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData, const int iNumBytes, CHostAddress RecHostAddr )
+EPutDataStat CChannel::PutAudioData ( const uint8_t* pbyData, const int iNumBytes, const CHostAddress& RecHostAddr )
 {
     // init return state
     EPutDataStat eRet = PS_GEN_ERROR;
@@ -542,7 +571,7 @@ EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData, const i
             if ( iNumBytes == ( iNetwFrameSize * iNetwFrameSizeFact ) )
             {
                 // store new packet in jitter buffer
-                if ( SockBuf.Put ( vecbyData, iNumBytes ) )
+                if ( SockBuf.Put ( pbyData, iNumBytes ) )
                 {
                     eRet = PS_AUDIO_OK;
                 }
@@ -598,14 +627,15 @@ EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData, const i
     return eRet;
 }
 
-EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData, const int iNumBytes )
+EGetDataStat CChannel::GetData ( const uint8_t*& pbyData, const int iNumBytes )
 {
     EGetDataStat eGetStatus;
 
     MutexSocketBuf.lock();
     {
-        // the socket access must be inside a mutex
-        const bool bSockBufState = SockBuf.Get ( vecbyData, iNumBytes );
+        // the socket access must be inside a mutex (the returned block is not
+        // written by Put() until the next call)
+        const bool bSockBufState = SockBuf.GetInPlace ( pbyData, iNumBytes );
 
         // decrease time-out counter
         if ( iConTimeOut > 0 )
@@ -660,6 +690,38 @@ EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData, const int iNumByte
     return eGetStatus;
 }
 
+bool CChannel::GetReceivedData ( const uint8_t*& pbyData, const int iNumBytes )
+{
+    // Same as GetData() but the block is only taken from the jitter buffer if
+    // it was actually received. This is used to decode the audio ahead of the
+    // server tick, therefore the channel must never be disconnected here (this
+    // is left to the GetData() call of the tick).
+    bool bGetOK = false;
+
+    pbyData = nullptr;
+
+    MutexSocketBuf.lock();
+    {
+        if ( ( iConTimeOut > iAudioFrameSizeSamples ) && SockBuf.IsNextBlockAvailable ( iNumBytes ) )
+        {
+            bGetOK = SockBuf.GetInPlace ( pbyData, iNumBytes );
+
+            // the block counts for the time-out like in GetData()
+            iConTimeOut -= iAudioFrameSizeSamples;
+        }
+    }
+    MutexSocketBuf.unlock();
+
+    return bGetOK;
+}
+
+int CChannel::GetSockBufFillLevel()
+{
+    QMutexLocker locker ( &MutexSocketBuf );
+
+    return SockBuf.GetFillLevel();
+}
+
 void CChannel::PrepAndSendPacket ( CHighPrioSocket* pSocket, const CVector<uint8_t>& vecbyNPacket, const int iNPacketLen )
 {
     // From v3.8.0 onwards, a server will not send audio to a client until that client has sent channel info.
@@ -680,10 +742,50 @@ void CChannel::PrepAndSendPacket ( CHighPrioSocket* pSocket, const CVector<uint8
     }
 }
 
-double CChannel::UpdateAndGetLevelForMeterdB ( const CVector<short>& vecsAudio, const int iInSize, const bool bIsStereoIn )
+void CChannel::PrepAndSendPacket ( CHighPrioSocket*        pSocket,
+                                   CSendBatch&             SendBatch,
+                                   const CVector<uint8_t>& vecbyNPacket,
+                                   const int               iNPacketLen,
+                                   const uSockAddr&        SockAddr,
+                                   const int               iSockAddrLen )
+{
+    // see the function above
+    if ( bIsServer && !bIsIdentified )
+    {
+        return;
+    }
+
+    QMutexLocker locker ( &MutexConvBuf );
+
+    if ( ConvBuf.Put ( vecbyNPacket, iNPacketLen, iSendSequenceNumber++ ) )
+    {
+        const CVector<uint8_t>& vecbyPacket = ConvBuf.GetAll();
+
+        // if the batch is full, it is sent right away
+        if ( !SendBatch.Add ( vecbyPacket, SockAddr, iSockAddrLen ) )
+        {
+            pSocket->SendBatch ( SendBatch );
+
+            if ( !SendBatch.Add ( vecbyPacket, SockAddr, iSockAddrLen ) )
+            {
+                pSocket->SendPacket ( vecbyPacket, GetAddress() );
+            }
+        }
+    }
+}
+
+double CChannel::UpdateAndGetLevelForMeterdB ( const short* psAudio, const int iInSize, const bool bIsStereoIn )
+{
+    // update the signal level meter and immediately return the current value
+    SignalLevelMeter.Update ( psAudio, iInSize, bIsStereoIn );
+
+    return SignalLevelMeter.GetLevelForMeterdBLeftOrMono();
+}
+
+double CChannel::UpdateAndGetLevelForMeterdB ( const float* pfAudio, const int iInSize, const bool bIsStereoIn )
 {
     // update the signal level meter and immediately return the current value
-    SignalLevelMeter.Update ( vecsAudio, iInSize, bIsStereoIn );
+    SignalLevelMeter.Update ( pfAudio, iInSize, bIsStereoIn );
 
     return SignalLevelMeter.GetLevelForMeterdBLeftOrMono();
 }
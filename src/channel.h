@@ -34,6 +34,7 @@
 #include "buffer.h"
 #include "util.h"
 #include "protocol.h"
+#include "codecpool.h"
 #include "socket.h"
 
 /* Definitions ****************************************************************/
@@ -70,12 +71,26 @@ public:
 
     void PutProtocolData ( const int iRecCounter, const int iRecID, const CVector<uint8_t>& vecbyMesBodyData, const CHostAddress& RecHostAddr );
 
-    EPutDataStat PutAudioData ( const CVector<uint8_t>& vecbyData, const int iNumBytes, CHostAddress RecHostAddr );
+    EPutDataStat PutAudioData ( const uint8_t* pbyData, const int iNumBytes, const CHostAddress& RecHostAddr );
 
-    EGetDataStat GetData ( CVector<uint8_t>& vecbyData, const int iNumBytes );
+    // the coded data is not copied, the pointer refers to the block in the
+    // jitter buffer and stays valid until the next GetData()/GetReceivedData()
+    EGetDataStat GetData ( const uint8_t*& pbyData, const int iNumBytes );
+    bool         GetReceivedData ( const uint8_t*& pbyData, const int iNumBytes );
+
+    // number of blocks up to the newest received block in the jitter buffer
+    int GetSockBufFillLevel();
 
     void PrepAndSendPacket ( CHighPrioSocket* pSocket, const CVector<uint8_t>& vecbyNPacket, const int iNPacketLen );
 
+    // same as above but the packet is added to the send batch of the calling thread
+    void PrepAndSendPacket ( CHighPrioSocket*        pSocket,
+                             CSendBatch&             SendBatch,
+                             const CVector<uint8_t>& vecbyNPacket,
+                             const int               iNPacketLen,
+                             const uSockAddr&        SockAddr,
+                             const int               iSockAddrLen );
+
     void ResetTimeOutCounter() { iConTimeOut = iConTimeOutStartVal; }
     bool IsConnected() const { return iConTimeOut > 0; }
     void Disconnect();
@@ -117,6 +132,9 @@ public:
 
     void UpdateSocketBufferSize();
 
+    // true if the auto setting differs from the current jitter buffer size
+    bool IsSocketBufferSizeUpdateRequired() { return bDoAutoSockBufSize && ( SockBuf.GetAutoSetting() != iCurSockBufNumFrames ); }
+
     int GetUploadRateKbps();
 
     // set/get network out buffer size and size factor
@@ -129,6 +147,11 @@ public:
 
     bool GetDoAutoSockBufSize() const { return bDoAutoSockBufSize; }
 
+    // selects the histogram jitter estimator for the auto jitter buffer size
+    // (takes effect with the next jitter buffer initialization)
+    void SetUseJitterHistogram ( const bool bValue ) { SockBuf.SetUseJitterHistogram ( bValue ); }
+    bool GetUseJitterHistogram() const { return SockBuf.GetUseJitterHistogram(); }
+
     int GetNetwFrameSizeFact() const { return iNetwFrameSizeFact; }
     int GetCeltNumCodedBytes() const { return iCeltNumCodedBytes; }
 
@@ -140,6 +163,22 @@ public:
     EAudComprType GetAudioCompressionType() { return eAudioCompressionType; }
     int           GetNumAudioChannels() const { return iNumAudioChannels; }
 
+    // the version is incremented each time the codec configuration changes
+    int          GetCodecConfigVersion() const { return iCodecConfigVersion.load ( std::memory_order_acquire ); }
+    CCodecConfig GetCodecConfig()
+    {
+        QMutexLocker locker ( &Mutex );
+        return CodecConfig;
+    }
+
+    // consistent copy of the codec configuration, returns its version
+    int GetCodecConfig ( CCodecConfig& CurCodecConfig )
+    {
+        QMutexLocker locker ( &Mutex );
+        CurCodecConfig = CodecConfig;
+        return iCodecConfigVersion.load ( std::memory_order_relaxed );
+    }
+
     // network protocol interface
     void CreateJitBufMes ( const int iJitBufSize )
     {
@@ -167,11 +206,14 @@ public:
 
     CNetworkTransportProps GetNetworkTransportPropsFromCurrentSettings();
 
-    double UpdateAndGetLevelForMeterdB ( const CVector<short>& vecsAudio, const int iInSize, const bool bIsStereoIn );
+    double UpdateAndGetLevelForMeterdB ( const short* psAudio, const int iInSize, const bool bIsStereoIn );
+    double UpdateAndGetLevelForMeterdB ( const float* pfAudio, const int iInSize, const bool bIsStereoIn );
 
 protected:
     bool ProtocolIsEnabled();
 
+    void UpdateCodecConfig();
+
     void ResetNetworkTransportProperties()
     {
         // set it to a state were no decoding is ever possible (since we want
@@ -225,6 +267,10 @@ protected:
     EAudComprType eAudioCompressionType;
     int           iNumAudioChannels;
 
+    // codec configuration from the negotiated transport properties
+    CCodecConfig     CodecConfig;
+    std::atomic<int> iCodecConfigVersion;
+
     QMutex Mutex;
     QMutex MutexSocketBuf;
     QMutex MutexConvBuf;
@@ -274,6 +320,9 @@ signals:
     void ClientIDReceived ( int iChanID );
     void MuteStateHasChanged ( int iChanID, bool bIsMuted );
     void MuteStateHasChangedReceived ( int iChanID, bool bIsMuted );
+    void ChanGainHasChanged ( int iChanID, float fNewGain );
+    void ChanPanHasChanged ( int iChanID, float fNewPan );
+    void NetTranspPropsHaveChanged();
     void ReqChanInfo();
     void ChatTextReceived ( QString strChatText );
     void ReqNetTranspProps();
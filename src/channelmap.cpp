@@ -0,0 +1,188 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include "channelmap.h"
+#include <thread>
+
+/* Implementation *************************************************************/
+CChannelMap::CChannelMap() : iSequence ( 0 )
+{
+    for ( int i = 0; i < CHANNEL_MAP_NUM_SLOTS; i++ )
+    {
+        vecHashOfSlot[i] = 0;
+    }
+
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        veciSlotOfChanID[i] = INVALID_INDEX;
+    }
+}
+
+int CChannelMap::Find ( const CHostAddress& Addr ) const
+{
+    quint64 iAddrHi;
+    quint64 iAddrLo;
+    quint32 iPortProto;
+
+    Addr.GetKey ( iAddrHi, iAddrLo, iPortProto );
+
+    for ( ;; )
+    {
+        const uint32_t iSeqBegin = iSequence.load ( std::memory_order_acquire );
+
+        if ( ( iSeqBegin & 1 ) == 0 )
+        {
+            const int iSlot   = FindSlot ( iAddrHi, iAddrLo, iPortProto, Addr.GetHash() );
+            const int iChanID = ( iSlot == INVALID_INDEX ) ? INVALID_INDEX : Slots[iSlot].iChanID.load ( std::memory_order_relaxed );
+
+            // the result is only valid if no modification happened in the meantime
+            std::atomic_thread_fence ( std::memory_order_acquire );
+
+            if ( iSequence.load ( std::memory_order_relaxed ) == iSeqBegin )
+            {
+                return iChanID;
+            }
+        }
+        else
+        {
+            // a modification is in progress, it only takes a few instructions
+            std::this_thread::yield();
+        }
+    }
+}
+
+int CChannelMap::FindSlot ( const quint64 iAddrHi, const quint64 iAddrLo, const quint32 iPortProto, const uint32_t iHash ) const
+{
+    int iSlot = static_cast<int> ( iHash & ( CHANNEL_MAP_NUM_SLOTS - 1 ) );
+
+    // linear probing, the number of probes is limited in case the reader sees a
+    // table which is just being modified
+    for ( int i = 0; i < CHANNEL_MAP_NUM_SLOTS; i++ )
+    {
+        const CSlot& Slot = Slots[iSlot];
+
+        if ( Slot.iChanID.load ( std::memory_order_relaxed ) == INVALID_INDEX )
+        {
+            return INVALID_INDEX;
+        }
+
+        if ( ( Slot.iPortProto.load ( std::memory_order_relaxed ) == iPortProto ) && ( Slot.iAddrLo.load ( std::memory_order_relaxed ) == iAddrLo ) &&
+             ( Slot.iAddrHi.load ( std::memory_order_relaxed ) == iAddrHi ) )
+        {
+            return iSlot;
+        }
+
+        iSlot = ( iSlot + 1 ) & ( CHANNEL_MAP_NUM_SLOTS - 1 );
+    }
+
+    return INVALID_INDEX;
+}
+
+void CChannelMap::Insert ( const CHostAddress& Addr, const int iChanID )
+{
+    quint64 iAddrHi;
+    quint64 iAddrLo;
+    quint32 iPortProto;
+
+    Addr.GetKey ( iAddrHi, iAddrLo, iPortProto );
+
+    // the table always has free slots since it is much larger than the number of channels
+    int iSlot = static_cast<int> ( Addr.GetHash() & ( CHANNEL_MAP_NUM_SLOTS - 1 ) );
+
+    while ( Slots[iSlot].iChanID.load ( std::memory_order_relaxed ) != INVALID_INDEX )
+    {
+        iSlot = ( iSlot + 1 ) & ( CHANNEL_MAP_NUM_SLOTS - 1 );
+    }
+
+    BeginWrite();
+
+    Slots[iSlot].iAddrHi.store ( iAddrHi, std::memory_order_relaxed );
+    Slots[iSlot].iAddrLo.store ( iAddrLo, std::memory_order_relaxed );
+    Slots[iSlot].iPortProto.store ( iPortProto, std::memory_order_relaxed );
+    Slots[iSlot].iChanID.store ( iChanID, std::memory_order_relaxed );
+
+    vecHashOfSlot[iSlot]      = Addr.GetHash();
+    veciSlotOfChanID[iChanID] = iSlot;
+
+    EndWrite();
+}
+
+void CChannelMap::Remove ( const int iChanID )
+{
+    const int iSlot = veciSlotOfChanID[iChanID];
+
+    if ( iSlot == INVALID_INDEX )
+    {
+        return;
+    }
+
+    BeginWrite();
+
+    veciSlotOfChanID[iChanID] = INVALID_INDEX;
+
+    // backward shift deletion: move the following entries of the probe sequence
+    // into the hole so that no tombstones are required
+    int iHole = iSlot;
+    int iCur  = ( iSlot + 1 ) & ( CHANNEL_MAP_NUM_SLOTS - 1 );
+
+    while ( Slots[iCur].iChanID.load ( std::memory_order_relaxed ) != INVALID_INDEX )
+    {
+        const int iHome = static_cast<int> ( vecHashOfSlot[iCur] & ( CHANNEL_MAP_NUM_SLOTS - 1 ) );
+
+        // the entry can be moved if its home slot is not between the hole and its current slot
+        if ( ( ( iCur - iHome ) & ( CHANNEL_MAP_NUM_SLOTS - 1 ) ) >= ( ( iCur - iHole ) & ( CHANNEL_MAP_NUM_SLOTS - 1 ) ) )
+        {
+            MoveSlot ( iCur, iHole );
+            iHole = iCur;
+        }
+
+        iCur = ( iCur + 1 ) & ( CHANNEL_MAP_NUM_SLOTS - 1 );
+    }
+
+    Slots[iHole].iChanID.store ( INVALID_INDEX, std::memory_order_relaxed );
+
+    EndWrite();
+}
+
+void CChannelMap::MoveSlot ( const int iFromSlot, const int iToSlot )
+{
+    const int iChanID = Slots[iFromSlot].iChanID.load ( std::memory_order_relaxed );
+
+    Slots[iToSlot].iAddrHi.store ( Slots[iFromSlot].iAddrHi.load ( std::memory_order_relaxed ), std::memory_order_relaxed );
+    Slots[iToSlot].iAddrLo.store ( Slots[iFromSlot].iAddrLo.load ( std::memory_order_relaxed ), std::memory_order_relaxed );
+    Slots[iToSlot].iPortProto.store ( Slots[iFromSlot].iPortProto.load ( std::memory_order_relaxed ), std::memory_order_relaxed );
+    Slots[iToSlot].iChanID.store ( iChanID, std::memory_order_relaxed );
+
+    vecHashOfSlot[iToSlot]    = vecHashOfSlot[iFromSlot];
+    veciSlotOfChanID[iChanID] = iToSlot;
+}
+
+void CChannelMap::BeginWrite()
+{
+    // an odd sequence number tells the readers that the table is inconsistent
+    iSequence.store ( iSequence.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence ( std::memory_order_release );
+}
+
+void CChannelMap::EndWrite() { iSequence.store ( iSequence.load ( std::memory_order_relaxed ) + 1, std::memory_order_release ); }
@@ -0,0 +1,78 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include "global.h"
+#include "util.h"
+
+/* Definitions ****************************************************************/
+// number of slots of the channel map, must be a power of two (the table is
+// kept sparse so that the probe sequences stay short)
+#define CHANNEL_MAP_NUM_SLOTS 1024
+
+/* Classes ********************************************************************/
+// Open addressing hash table which maps the address and port of a client to
+// its channel ID. Lookups do not take any lock: the table is protected by a
+// sequence lock, a reader which overlaps with a modification simply repeats
+// the lookup. Modifications only happen on connect and disconnect and must be
+// serialized by the caller.
+class CChannelMap
+{
+public:
+    CChannelMap();
+
+    // reader side, may be called from any thread, returns INVALID_INDEX if the
+    // address is not mapped
+    int Find ( const CHostAddress& Addr ) const;
+
+    // writer side
+    void Insert ( const CHostAddress& Addr, const int iChanID );
+    void Remove ( const int iChanID );
+    bool IsMapped ( const int iChanID ) const { return veciSlotOfChanID[iChanID] != INVALID_INDEX; }
+
+protected:
+    // the key is stored as plain integers so that it can be read concurrently
+    class CSlot
+    {
+    public:
+        CSlot() : iAddrHi ( 0 ), iAddrLo ( 0 ), iPortProto ( 0 ), iChanID ( INVALID_INDEX ) {}
+
+        std::atomic<quint64> iAddrHi;
+        std::atomic<quint64> iAddrLo;
+        std::atomic<quint32> iPortProto;
+        std::atomic<int>     iChanID; // INVALID_INDEX if the slot is empty
+    };
+
+    int  FindSlot ( const quint64 iAddrHi, const quint64 iAddrLo, const quint32 iPortProto, const uint32_t iHash ) const;
+    void MoveSlot ( const int iFromSlot, const int iToSlot );
+    void BeginWrite();
+    void EndWrite();
+
+    CSlot                 Slots[CHANNEL_MAP_NUM_SLOTS];
+    uint32_t              vecHashOfSlot[CHANNEL_MAP_NUM_SLOTS]; // only accessed by the writer
+    int                   veciSlotOfChanID[MAX_NUM_CHANNELS];   // only accessed by the writer
+    std::atomic<uint32_t> iSequence;                            // odd while a modification is in progress
+};
@@ -32,7 +32,8 @@ CClient::CClient ( const quint16  iPortNumber,
                    const bool     bNoAutoJackConnect,
                    const QString& strNClientName,
                    const bool     bNEnableIPv6,
-                   const bool     bNMuteMeInPersonalMix ) :
+                   const bool     bNMuteMeInPersonalMix,
+                   const bool     bNUseAdaptivePlayout ) :
     ChannelInfo(),
     strClientName ( strNClientName ),
     Channel ( false ), /* we need a client channel -> "false" */
@@ -57,6 +58,7 @@ CClient::CClient ( const quint16  iPortNumber,
     iSndCrdFrameSizeFactor ( FRAME_SIZE_FACTOR_DEFAULT ),
     bSndCrdConversionBufferRequired ( false ),
     iSndCardMonoBlockSizeSamConvBuff ( 0 ),
+    bUseAdaptivePlayout ( bNUseAdaptivePlayout ),
     bFraSiFactPrefSupported ( false ),
     bFraSiFactDefSupported ( false ),
     bFraSiFactSafeSupported ( false ),
@@ -1092,15 +1094,19 @@ void CClient::Init()
     opus_custom_encoder_ctl ( CurOpusEncoder,
                               OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iOPUSFrameSizeSamples ) ) );
 
-    // inits for network and channel
-    vecbyNetwData.Init ( iCeltNumCodedBytes );
-
     // set the channel network properties
     Channel.SetAudioStreamProperties ( eAudioCompressionType, iCeltNumCodedBytes, iSndCrdFrameSizeFactor, iNumAudioChannels );
 
     // init reverberation
     AudioReverb.Init ( eAudioChannelConf, iStereoBlockSizeSam, SYSTEM_SAMPLE_RATE_HZ );
 
+    // init adaptive playout (the frame is the sound card block, the blocks are the OPUS frames)
+    if ( bUseAdaptivePlayout )
+    {
+        Playout.Init ( 2 /* stereo */, iMonoBlockSizeSam );
+        Playout.SetFormat ( iNumAudioChannels, iMonoBlockSizeSam, iOPUSFrameSizeSamples );
+    }
+
     // init the sound card conversion buffers
     if ( bSndCrdConversionBufferRequired )
     {
@@ -1173,8 +1179,8 @@ void CClient::ProcessSndCrdAudioData ( CVector<int16_t>& vecsStereoSndCrd )
 
 void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
 {
-    int            i, j, iUnused;
-    unsigned char* pCurCodedData;
+    int                  i, j, iUnused;
+    const unsigned char* pCurCodedData;
 
     // Transmit signal ---------------------------------------------------------
 
@@ -1275,15 +1281,19 @@ void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
         vecsStereoSndCrdMuteStream = vecsStereoSndCrd;
     }
 
-    for ( i = 0, j = 0; i < iSndCrdFrameSizeFactor; i++, j += iNumAudioChannels * iOPUSFrameSizeSamples )
+    // with the adaptive playout, one block more or less than the frame size factor may be decoded
+    const int iNumBlocks = bUseAdaptivePlayout ? Playout.PrepareFrame ( Channel.GetSockBufFillLevel() ) : iSndCrdFrameSizeFactor;
+
+    for ( i = 0, j = 0; i < iNumBlocks; i++, j += iNumAudioChannels * iOPUSFrameSizeSamples )
     {
-        // receive a new block
-        const bool bReceiveDataOk = ( Channel.GetData ( vecbyNetwData, iCeltNumCodedBytes ) == GS_BUFFER_OK );
+        // receive a new block (the coded data is decoded directly from the jitter buffer)
+        const uint8_t* pbyNetwData;
+        const bool     bReceiveDataOk = ( Channel.GetData ( pbyNetwData, iCeltNumCodedBytes ) == GS_BUFFER_OK );
 
         // get pointer to coded data and manage the flags
         if ( bReceiveDataOk )
         {
-            pCurCodedData = &vecbyNetwData[0];
+            pCurCodedData = pbyNetwData;
 
             // on any valid received packet, we clear the initialization phase flag
             bIsInitializationPhase = false;
@@ -1298,12 +1308,32 @@ void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
         }
 
         // OPUS decoding
-        if ( CurOpusDecoder != nullptr )
+        if ( bUseAdaptivePlayout )
+        {
+            int16_t* pBlockData = Playout.GetBlockWritePtr();
+
+            if ( CurOpusDecoder != nullptr )
+            {
+                iUnused = opus_custom_decode ( CurOpusDecoder, pCurCodedData, iCeltNumCodedBytes, pBlockData, iOPUSFrameSizeSamples );
+            }
+            else
+            {
+                std::fill_n ( pBlockData, iNumAudioChannels * iOPUSFrameSizeSamples, static_cast<int16_t> ( 0 ) );
+            }
+
+            Playout.BlockWritten();
+        }
+        else if ( CurOpusDecoder != nullptr )
         {
             iUnused = opus_custom_decode ( CurOpusDecoder, pCurCodedData, iCeltNumCodedBytes, &vecsStereoSndCrd[j], iOPUSFrameSizeSamples );
         }
     }
 
+    if ( bUseAdaptivePlayout )
+    {
+        Playout.GetFrame ( &vecsStereoSndCrd[0] );
+    }
+
     // for muted stream we have to add our local data here
     if ( bMuteOutStream )
     {
@@ -39,6 +39,7 @@
 #include "channel.h"
 #include "util.h"
 #include "buffer.h"
+#include "playout.h"
 #include "signalhandler.h"
 
 #if defined( _WIN32 ) && !defined( JACK_ON_WINDOWS )
@@ -115,7 +116,8 @@ public:
               const bool     bNoAutoJackConnect,
               const QString& strNClientName,
               const bool     bNEnableIPv6,
-              const bool     bNMuteMeInPersonalMix );
+              const bool     bNMuteMeInPersonalMix,
+              const bool     bNUseAdaptivePlayout );
 
     virtual ~CClient();
 
@@ -319,8 +321,6 @@ protected:
     CSound                  Sound;
     CStereoSignalLevelMeter SignalLevelMeter;
 
-    CVector<uint8_t> vecbyNetwData;
-
     int          iAudioInFader;
     bool         bReverbOnLeftChan;
     int          iReverbLevel;
@@ -338,6 +338,11 @@ protected:
     CVector<int16_t> vecsStereoSndCrdMuteStream;
     CVector<int16_t> vecZeros;
 
+    // adaptive playout: the sound card block is stretched or compressed to keep
+    // the jitter buffer fill level low
+    bool                      bUseAdaptivePlayout;
+    CAdaptivePlayout<int16_t> Playout;
+
     bool bFraSiFactPrefSupported;
     bool bFraSiFactDefSupported;
     bool bFraSiFactSafeSupported;
@@ -0,0 +1,228 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+
+#include "codecpool.h"
+
+/* Implementation *************************************************************/
+CCodecConfig::CCodecConfig ( const EAudComprType eNAudComprType, const int iNNumAudioChannels, const int iNCeltNumCodedBytes ) :
+    eAudComprType ( eNAudComprType ),
+    iNumAudioChannels ( iNNumAudioChannels ),
+    iCeltNumCodedBytes ( iNCeltNumCodedBytes ),
+    iBitRateBps ( 0 ),
+    iComplexity ( 0 ),
+    iPacketLossPerc ( 0 )
+{
+    if ( eAudComprType == CT_OPUS )
+    {
+        iBitRateBps = CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES );
+        iComplexity = OPUS_LEGACY_COMPLEXITY;
+    }
+    else if ( eAudComprType == CT_OPUS64 )
+    {
+        iBitRateBps     = CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, SYSTEM_FRAME_SIZE_SAMPLES );
+        iComplexity     = OPUS64_COMPLEXITY;
+        iPacketLossPerc = OPUS64_PACKET_LOSS_PERC;
+    }
+}
+
+CCodecPool::CCodecPool() : OpusMode ( nullptr ), Opus64Mode ( nullptr )
+{
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        for ( int iKind = 0; iKind < CK_NUM_KINDS; iKind++ )
+        {
+            States[i][iKind].store ( nullptr, std::memory_order_relaxed );
+        }
+    }
+}
+
+CCodecPool::~CCodecPool()
+{
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        for ( int iKind = 0; iKind < CK_NUM_KINDS; iKind++ )
+        {
+            CState* pState = States[i][iKind].load ( std::memory_order_relaxed );
+
+            if ( pState != nullptr )
+            {
+                // free audio encoder and decoder
+                opus_custom_encoder_destroy ( pState->pEncoder );
+                opus_custom_decoder_destroy ( pState->pDecoder );
+                delete pState;
+            }
+        }
+    }
+
+    // free audio modes (after all states which use them)
+    if ( OpusMode != nullptr )
+    {
+        opus_custom_mode_destroy ( OpusMode );
+    }
+
+    if ( Opus64Mode != nullptr )
+    {
+        opus_custom_mode_destroy ( Opus64Mode );
+    }
+}
+
+void CCodecPool::Prepare ( const int iChanID, const EAudComprType eAudComprType, const int iNumAudioChannels )
+{
+    const int iKind = GetKind ( eAudComprType, iNumAudioChannels );
+
+    // only OPUS and OPUS64 are supported, nothing to do for an unknown codec
+    if ( ( iKind == INVALID_INDEX ) || ( iChanID < 0 ) || ( iChanID >= MAX_NUM_CHANNELS ) )
+    {
+        return;
+    }
+
+    QMutexLocker locker ( &Mutex );
+
+    if ( States[iChanID][iKind].load ( std::memory_order_relaxed ) == nullptr )
+    {
+        CState* pState = CreateState ( iKind );
+
+        if ( pState != nullptr )
+        {
+            // publish the completely initialized state to the mixer thread
+            States[iChanID][iKind].store ( pState, std::memory_order_release );
+        }
+    }
+}
+
+void CCodecPool::Reset ( const int iChanID )
+{
+    // the reset keeps the encoder settings (bit rate, complexity, etc.)
+    for ( int iKind = 0; iKind < CK_NUM_KINDS; iKind++ )
+    {
+        CState* pState = States[iChanID][iKind].load ( std::memory_order_acquire );
+
+        if ( pState != nullptr )
+        {
+            opus_custom_encoder_ctl ( pState->pEncoder, OPUS_RESET_STATE );
+            opus_custom_decoder_ctl ( pState->pDecoder, OPUS_RESET_STATE );
+        }
+    }
+}
+
+void CCodecPool::ApplyConfig ( const int iChanID, const CCodecConfig& Config, const int iConfigVersion )
+{
+    CState* pState = GetState ( iChanID, Config.eAudComprType, Config.iNumAudioChannels );
+
+    if ( pState == nullptr )
+    {
+        return;
+    }
+
+    // only call the encoder ctls for the settings which have actually changed
+    // (all settings are applied to a newly created state)
+    const bool bApplyAll = ( pState->iAppliedConfigVersion == INVALID_INDEX );
+
+    if ( bApplyAll || ( pState->AppliedConfig.iBitRateBps != Config.iBitRateBps ) )
+    {
+        opus_custom_encoder_ctl ( pState->pEncoder, OPUS_SET_BITRATE ( Config.iBitRateBps ) );
+    }
+
+    if ( bApplyAll || ( pState->AppliedConfig.iComplexity != Config.iComplexity ) )
+    {
+        opus_custom_encoder_ctl ( pState->pEncoder, OPUS_SET_COMPLEXITY ( Config.iComplexity ) );
+    }
+
+    if ( bApplyAll || ( pState->AppliedConfig.iPacketLossPerc != Config.iPacketLossPerc ) )
+    {
+        opus_custom_encoder_ctl ( pState->pEncoder, OPUS_SET_PACKET_LOSS_PERC ( Config.iPacketLossPerc ) );
+    }
+
+    pState->AppliedConfig         = Config;
+    pState->iAppliedConfigVersion = iConfigVersion;
+}
+
+CCodecPool::CState* CCodecPool::CreateState ( const int iKind )
+{
+    // note that the writer mutex must be locked when calling this function
+    int             iOpusError;
+    const bool      bIsOpus64         = ( iKind == CK_OPUS64_MONO ) || ( iKind == CK_OPUS64_STEREO );
+    const int       iNumAudioChannels = ( ( iKind == CK_OPUS_MONO ) || ( iKind == CK_OPUS64_MONO ) ) ? 1 : 2;
+    OpusCustomMode* pMode;
+
+    // the mode of a frame size is created once and shared by all states
+    if ( bIsOpus64 )
+    {
+        if ( Opus64Mode == nullptr )
+        {
+            Opus64Mode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
+        }
+
+        pMode = Opus64Mode;
+    }
+    else
+    {
+        if ( OpusMode == nullptr )
+        {
+            OpusMode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
+        }
+
+        pMode = OpusMode;
+    }
+
+    if ( pMode == nullptr )
+    {
+        return nullptr;
+    }
+
+    // init audio encoder and decoder
+    CState* pState = new CState;
+
+    pState->pEncoder = opus_custom_encoder_create ( pMode, iNumAudioChannels, &iOpusError );
+    pState->pDecoder = opus_custom_decoder_create ( pMode, iNumAudioChannels, &iOpusError );
+
+    if ( ( pState->pEncoder == nullptr ) || ( pState->pDecoder == nullptr ) )
+    {
+        if ( pState->pEncoder != nullptr )
+        {
+            opus_custom_encoder_destroy ( pState->pEncoder );
+        }
+
+        if ( pState->pDecoder != nullptr )
+        {
+            opus_custom_decoder_destroy ( pState->pDecoder );
+        }
+
+        delete pState;
+        return nullptr;
+    }
+
+    // we require a constant bit rate
+    opus_custom_encoder_ctl ( pState->pEncoder, OPUS_SET_VBR ( 0 ) );
+
+    // we want as low delay as possible
+    opus_custom_encoder_ctl ( pState->pEncoder, OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+    // the bit rate, complexity and packet loss settings are applied with the
+    // first channel codec configuration (see ApplyConfig())
+    pState->iAppliedConfigVersion = INVALID_INDEX;
+
+    return pState;
+}
@@ -0,0 +1,184 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+
+#pragma once
+
+#include <QMutex>
+#include <atomic>
+#ifdef USE_OPUS_SHARED_LIB
+#    include "opus/opus_custom.h"
+#else
+#    include "opus_custom.h"
+#endif
+#include "global.h"
+#include "util.h"
+
+/* Definitions ****************************************************************/
+// encoder complexity for the legacy 128 samples frame size
+#define OPUS_LEGACY_COMPLEXITY 1
+
+// default encoder complexity of the OPUS library (used for OPUS64)
+#define OPUS64_COMPLEXITY 5
+
+// for 64 samples frame size we have to adjust the PLC behavior to avoid loud artifacts
+#define OPUS64_PACKET_LOSS_PERC 35
+
+/* Classes ********************************************************************/
+// Encoder settings which result from the negotiated network transport
+// properties of a channel.
+class CCodecConfig
+{
+public:
+    CCodecConfig() :
+        eAudComprType ( CT_NONE ),
+        iNumAudioChannels ( 1 ),
+        iCeltNumCodedBytes ( 0 ),
+        iBitRateBps ( 0 ),
+        iComplexity ( 0 ),
+        iPacketLossPerc ( 0 )
+    {}
+
+    CCodecConfig ( const EAudComprType eNAudComprType, const int iNNumAudioChannels, const int iNCeltNumCodedBytes );
+
+    bool operator== ( const CCodecConfig& Other ) const
+    {
+        return ( eAudComprType == Other.eAudComprType ) && ( iNumAudioChannels == Other.iNumAudioChannels ) &&
+               ( iCeltNumCodedBytes == Other.iCeltNumCodedBytes ) && ( iBitRateBps == Other.iBitRateBps ) &&
+               ( iComplexity == Other.iComplexity ) && ( iPacketLossPerc == Other.iPacketLossPerc );
+    }
+
+    bool operator!= ( const CCodecConfig& Other ) const { return !( *this == Other ); }
+
+    EAudComprType eAudComprType;
+    int           iNumAudioChannels;
+    int           iCeltNumCodedBytes;
+    int           iBitRateBps;
+    int           iComplexity;
+    int           iPacketLossPerc;
+};
+
+// OPUS encoder/decoder states of the server channels. Only one OPUS mode per
+// frame size is created and shared by all states. A state (encoder and decoder)
+// is created the first time a channel negotiates the corresponding codec kind
+// and stays assigned to the channel ID afterwards, i.e., it is reset but not
+// recreated when the channel ID is reused by a new connection.
+// Prepare() is called by the protocol handlers, the mixer thread only looks up
+// the states and gets a nullptr if the state is not yet available.
+// The encoder settings are applied by the mixer thread only if the version of
+// the channel codec configuration differs from the one applied to the state.
+class CCodecPool
+{
+public:
+    CCodecPool();
+    virtual ~CCodecPool();
+
+    // make sure the state for the negotiated codec of the channel exists
+    void Prepare ( const int iChanID, const EAudComprType eAudComprType, const int iNumAudioChannels );
+
+    // reset all existing states of the channel (for a new connection)
+    void Reset ( const int iChanID );
+
+    // must only be called by the thread which encodes for the channel
+    bool IsConfigApplied ( const int iChanID, const EAudComprType eAudComprType, const int iNumAudioChannels, const int iConfigVersion ) const
+    {
+        const CState* pState = GetState ( iChanID, eAudComprType, iNumAudioChannels );
+
+        return ( pState == nullptr ) || ( pState->iAppliedConfigVersion == iConfigVersion );
+    }
+
+    // must only be called by the thread which encodes for the channel
+    void ApplyConfig ( const int iChanID, const CCodecConfig& Config, const int iConfigVersion );
+
+    OpusCustomEncoder* GetEncoder ( const int iChanID, const EAudComprType eAudComprType, const int iNumAudioChannels ) const
+    {
+        const CState* pState = GetState ( iChanID, eAudComprType, iNumAudioChannels );
+
+        return pState == nullptr ? nullptr : pState->pEncoder;
+    }
+
+    OpusCustomDecoder* GetDecoder ( const int iChanID, const EAudComprType eAudComprType, const int iNumAudioChannels ) const
+    {
+        const CState* pState = GetState ( iChanID, eAudComprType, iNumAudioChannels );
+
+        return pState == nullptr ? nullptr : pState->pDecoder;
+    }
+
+protected:
+    enum ECodecKind
+    {
+        CK_OPUS_MONO     = 0,
+        CK_OPUS_STEREO   = 1,
+        CK_OPUS64_MONO   = 2,
+        CK_OPUS64_STEREO = 3,
+        CK_NUM_KINDS     = 4
+    };
+
+    class CState
+    {
+    public:
+        OpusCustomEncoder* pEncoder;
+        OpusCustomDecoder* pDecoder;
+
+        // encoder settings, only accessed by the mixer thread
+        CCodecConfig AppliedConfig;
+        int          iAppliedConfigVersion;
+    };
+
+    static int GetKind ( const EAudComprType eAudComprType, const int iNumAudioChannels )
+    {
+        if ( eAudComprType == CT_OPUS )
+        {
+            return iNumAudioChannels == 1 ? CK_OPUS_MONO : CK_OPUS_STEREO;
+        }
+        else if ( eAudComprType == CT_OPUS64 )
+        {
+            return iNumAudioChannels == 1 ? CK_OPUS64_MONO : CK_OPUS64_STEREO;
+        }
+
+        return INVALID_INDEX;
+    }
+
+    CState* GetState ( const int iChanID, const EAudComprType eAudComprType, const int iNumAudioChannels ) const
+    {
+        const int iKind = GetKind ( eAudComprType, iNumAudioChannels );
+
+        if ( iKind == INVALID_INDEX )
+        {
+            return nullptr;
+        }
+
+        return States[iChanID][iKind].load ( std::memory_order_acquire );
+    }
+
+    CState* CreateState ( const int iKind );
+
+    // the writer mutex protects the creation of modes and states
+    QMutex Mutex;
+
+    OpusCustomMode* OpusMode;   // legacy 128 samples frame size
+    OpusCustomMode* Opus64Mode; // 64 samples frame size
+
+    std::atomic<CState*> States[MAX_NUM_CHANNELS][CK_NUM_KINDS];
+};
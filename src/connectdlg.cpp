@@ -300,7 +300,7 @@ void CConnectDlg::SetServerList ( const CHostAddress& InetAddr, const CVector<CS
     // we only accept a server list from the server address we have sent the
     // request for this to (note that we cannot use the port number since the
     // receive port and send port might be different at the directory server).
-    if ( bServerListReceived || ( InetAddr.InetAddr != haDirectoryAddress.InetAddr ) )
+    if ( bServerListReceived || ( InetAddr.GetInetAddr() != haDirectoryAddress.GetInetAddr() ) )
     {
         return;
     }
@@ -370,7 +370,7 @@ void CConnectDlg::SetServerList ( const CHostAddress& InetAddr, const CVector<CS
             // IP address and port (use IP number without last byte)
             // Definition: If the port number is the default port number, we do
             // not show it.
-            if ( vecServerInfo[iIdx].HostAddr.iPort == DEFAULT_PORT_NUMBER )
+            if ( vecServerInfo[iIdx].HostAddr.GetPort() == DEFAULT_PORT_NUMBER )
             {
                 // only show IP number, no port number
                 pNewListViewItem->setText ( 0, CurHostAddress.toString ( CHostAddress::SM_IP_NO_LAST_BYTE ) );
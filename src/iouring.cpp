@@ -0,0 +1,323 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include "iouring.h"
+
+#ifdef USE_IO_URING
+#    include <algorithm>
+#    include <cstring>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+
+/* Implementation *************************************************************/
+CIoUring::CIoUring() :
+    iRingFd ( -1 ),
+    pSqRing ( nullptr ),
+    iSqRingSize ( 0 ),
+    pSqes ( nullptr ),
+    iSqesSize ( 0 ),
+    pSqHead ( nullptr ),
+    pSqTail ( nullptr ),
+    pSqArray ( nullptr ),
+    iSqMask ( 0 ),
+    iSqEntries ( 0 ),
+    iSqLocalTail ( 0 ),
+    pCqRing ( nullptr ),
+    iCqRingSize ( 0 ),
+    pCqes ( nullptr ),
+    pCqHead ( nullptr ),
+    pCqTail ( nullptr ),
+    iCqMask ( 0 ),
+    pBufRing ( nullptr ),
+    iBufRingSize ( 0 ),
+    pBufs ( nullptr ),
+    iBufsSize ( 0 ),
+    iBufGroupID ( 0 ),
+    iNumBufs ( 0 ),
+    iBufSize ( 0 ),
+    iBufTail ( 0 )
+{}
+
+bool CIoUring::Init ( const unsigned int iNumEntries, const unsigned int iNumCqEntries )
+{
+    struct io_uring_params Params;
+
+    memset ( &Params, 0, sizeof ( Params ) );
+
+    if ( iNumCqEntries > 0 )
+    {
+        Params.flags |= IORING_SETUP_CQSIZE;
+        Params.cq_entries = iNumCqEntries;
+    }
+
+    iRingFd = static_cast<int> ( syscall ( __NR_io_uring_setup, iNumEntries, &Params ) );
+
+    if ( iRingFd < 0 )
+    {
+        // not supported by the kernel or not permitted (e.g. by a seccomp filter)
+        return false;
+    }
+
+    iSqRingSize = Params.sq_off.array + Params.sq_entries * sizeof ( unsigned int );
+    iCqRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof ( struct io_uring_cqe );
+
+    // newer kernels map both rings with one mapping
+    const bool bSingleMmap = ( Params.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+
+    if ( bSingleMmap )
+    {
+        iSqRingSize = std::max ( iSqRingSize, iCqRingSize );
+        iCqRingSize = iSqRingSize;
+    }
+
+    pSqRing = mmap ( nullptr, iSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, iRingFd, IORING_OFF_SQ_RING );
+
+    if ( pSqRing == MAP_FAILED )
+    {
+        pSqRing = nullptr;
+        Close();
+        return false;
+    }
+
+    if ( bSingleMmap )
+    {
+        pCqRing = pSqRing;
+    }
+    else
+    {
+        pCqRing = mmap ( nullptr, iCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, iRingFd, IORING_OFF_CQ_RING );
+
+        if ( pCqRing == MAP_FAILED )
+        {
+            pCqRing = nullptr;
+            Close();
+            return false;
+        }
+    }
+
+    iSqesSize = Params.sq_entries * sizeof ( struct io_uring_sqe );
+    pSqes     = static_cast<struct io_uring_sqe*> (
+        mmap ( nullptr, iSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, iRingFd, IORING_OFF_SQES ) );
+
+    if ( pSqes == MAP_FAILED )
+    {
+        pSqes = nullptr;
+        Close();
+        return false;
+    }
+
+    uint8_t* pSq = static_cast<uint8_t*> ( pSqRing );
+    uint8_t* pCq = static_cast<uint8_t*> ( pCqRing );
+
+    pSqHead      = reinterpret_cast<unsigned int*> ( pSq + Params.sq_off.head );
+    pSqTail      = reinterpret_cast<unsigned int*> ( pSq + Params.sq_off.tail );
+    pSqArray     = reinterpret_cast<unsigned int*> ( pSq + Params.sq_off.array );
+    iSqMask      = *reinterpret_cast<unsigned int*> ( pSq + Params.sq_off.ring_mask );
+    iSqEntries   = Params.sq_entries;
+    iSqLocalTail = *pSqTail;
+
+    pCqHead = reinterpret_cast<unsigned int*> ( pCq + Params.cq_off.head );
+    pCqTail = reinterpret_cast<unsigned int*> ( pCq + Params.cq_off.tail );
+    pCqes   = reinterpret_cast<struct io_uring_cqe*> ( pCq + Params.cq_off.cqes );
+    iCqMask = *reinterpret_cast<unsigned int*> ( pCq + Params.cq_off.ring_mask );
+
+    return true;
+}
+
+void CIoUring::Close()
+{
+    // closing the file descriptor also unregisters the provided buffers
+    if ( iRingFd >= 0 )
+    {
+        close ( iRingFd );
+        iRingFd = -1;
+    }
+
+    if ( pBufRing != nullptr )
+    {
+        munmap ( pBufRing, iBufRingSize );
+        pBufRing = nullptr;
+    }
+
+    if ( pBufs != nullptr )
+    {
+        munmap ( pBufs, iBufsSize );
+        pBufs = nullptr;
+    }
+
+    if ( pSqes != nullptr )
+    {
+        munmap ( pSqes, iSqesSize );
+        pSqes = nullptr;
+    }
+
+    if ( ( pCqRing != nullptr ) && ( pCqRing != pSqRing ) )
+    {
+        munmap ( pCqRing, iCqRingSize );
+    }
+
+    pCqRing = nullptr;
+
+    if ( pSqRing != nullptr )
+    {
+        munmap ( pSqRing, iSqRingSize );
+        pSqRing = nullptr;
+    }
+}
+
+struct io_uring_sqe* CIoUring::GetSqe()
+{
+    if ( iSqLocalTail - __atomic_load_n ( pSqHead, __ATOMIC_ACQUIRE ) >= iSqEntries )
+    {
+        return nullptr;
+    }
+
+    const unsigned int iIdx = iSqLocalTail & iSqMask;
+
+    pSqArray[iIdx] = iIdx;
+    iSqLocalTail++;
+
+    memset ( &pSqes[iIdx], 0, sizeof ( struct io_uring_sqe ) );
+
+    return &pSqes[iIdx];
+}
+
+int CIoUring::Submit ( const unsigned int iWaitNr, const int iTimeoutMs )
+{
+    // publish the prepared entries to the kernel
+    const unsigned int iToSubmit = iSqLocalTail - *pSqTail;
+
+    __atomic_store_n ( pSqTail, iSqLocalTail, __ATOMIC_RELEASE );
+
+    unsigned int iFlags = ( iWaitNr > 0 ) ? IORING_ENTER_GETEVENTS : 0;
+
+    if ( iTimeoutMs < 0 )
+    {
+        return static_cast<int> ( syscall ( __NR_io_uring_enter, iRingFd, iToSubmit, iWaitNr, iFlags, nullptr, 0 ) );
+    }
+
+    // the wait is limited by a timeout (e.g. to check a stop condition)
+    struct __kernel_timespec      Timeout;
+    struct io_uring_getevents_arg Arg;
+
+    Timeout.tv_sec  = iTimeoutMs / 1000;
+    Timeout.tv_nsec = static_cast<long long> ( iTimeoutMs % 1000 ) * 1000000;
+
+    memset ( &Arg, 0, sizeof ( Arg ) );
+    Arg.ts = reinterpret_cast<uint64_t> ( &Timeout );
+
+    iFlags |= IORING_ENTER_EXT_ARG;
+
+    return static_cast<int> ( syscall ( __NR_io_uring_enter, iRingFd, iToSubmit, iWaitNr, iFlags, &Arg, sizeof ( Arg ) ) );
+}
+
+void CIoUring::DiscardUnsubmitted()
+{
+    // without IORING_SETUP_SQPOLL the kernel only reads the submission queue in
+    // io_uring_enter(), therefore the tail can be reset to the consumed entries
+    const unsigned int iHead = __atomic_load_n ( pSqHead, __ATOMIC_ACQUIRE );
+
+    __atomic_store_n ( pSqTail, iHead, __ATOMIC_RELEASE );
+    iSqLocalTail = iHead;
+}
+
+struct io_uring_cqe* CIoUring::PeekCqe()
+{
+    const unsigned int iHead = *pCqHead;
+
+    if ( iHead == __atomic_load_n ( pCqTail, __ATOMIC_ACQUIRE ) )
+    {
+        return nullptr;
+    }
+
+    return &pCqes[iHead & iCqMask];
+}
+
+void CIoUring::AdvanceCq() { __atomic_store_n ( pCqHead, *pCqHead + 1, __ATOMIC_RELEASE ); }
+
+bool CIoUring::RegisterBufRing ( const int iGroupID, const int iNewNumBufs, const int iNewBufSize )
+{
+    iBufGroupID = iGroupID;
+    iNumBufs    = iNewNumBufs;
+    iBufSize    = iNewBufSize;
+
+    // the buffer ring must be page aligned, anonymous mappings always are
+    iBufRingSize = iNumBufs * sizeof ( struct io_uring_buf );
+    iBufsSize    = static_cast<size_t> ( iNumBufs ) * iBufSize;
+
+    void* pRing = mmap ( nullptr, iBufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    void* pMem  = mmap ( nullptr, iBufsSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    pBufRing = ( pRing == MAP_FAILED ) ? nullptr : static_cast<struct io_uring_buf_ring*> ( pRing );
+    pBufs    = ( pMem == MAP_FAILED ) ? nullptr : static_cast<uint8_t*> ( pMem );
+
+    if ( ( pBufRing == nullptr ) || ( pBufs == nullptr ) )
+    {
+        return false;
+    }
+
+    // the ring must be written before the registration so that the kernel pins
+    // our pages (and not the shared zero page)
+    memset ( pBufRing, 0, iBufRingSize );
+
+    struct io_uring_buf_reg Reg;
+
+    memset ( &Reg, 0, sizeof ( Reg ) );
+    Reg.ring_addr    = reinterpret_cast<uint64_t> ( pBufRing );
+    Reg.ring_entries = static_cast<uint32_t> ( iNumBufs );
+    Reg.bgid         = static_cast<uint16_t> ( iBufGroupID );
+
+    if ( syscall ( __NR_io_uring_register, iRingFd, IORING_REGISTER_PBUF_RING, &Reg, 1 ) < 0 )
+    {
+        // provided buffer rings require kernel 5.19
+        return false;
+    }
+
+    // hand over all buffers to the kernel
+    iBufTail = 0;
+
+    for ( int i = 0; i < iNumBufs; i++ )
+    {
+        RecycleBuf ( i );
+    }
+
+    return true;
+}
+
+void CIoUring::RecycleBuf ( const int iBufID )
+{
+    // note that the bufs member of io_uring_buf_ring cannot be used in C++ (the
+    // empty struct in front of the flexible array has a size of one byte in C++)
+    struct io_uring_buf& Buf = reinterpret_cast<struct io_uring_buf*> ( pBufRing )[iBufTail & ( iNumBufs - 1 )];
+
+    Buf.addr = reinterpret_cast<uint64_t> ( GetBuf ( iBufID ) );
+    Buf.len  = static_cast<uint32_t> ( iBufSize );
+    Buf.bid  = static_cast<uint16_t> ( iBufID );
+
+    iBufTail++;
+
+    __atomic_store_n ( &pBufRing->tail, iBufTail, __ATOMIC_RELEASE );
+}
+#endif
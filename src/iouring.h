@@ -0,0 +1,117 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/* Definitions ****************************************************************/
+// io_uring is only available on Linux, the kernel interface is used directly
+// (without liburing) so that no additional library is required (the kernel
+// headers must know the multishot receive, i.e. Linux 6.0 or newer)
+#if defined( __linux__ ) && !defined( ANDROID ) && defined( __has_include )
+#    if __has_include( <linux/io_uring.h> )
+#        include <linux/io_uring.h>
+#        if defined( IORING_RECV_MULTISHOT ) && defined( IORING_ENTER_EXT_ARG )
+#            define USE_IO_URING
+#        endif
+#    endif
+#endif
+
+#ifdef USE_IO_URING
+
+/* Classes ********************************************************************/
+// Minimal wrapper of one io_uring instance: the submission and completion queues
+// and optionally a ring of provided buffers (used by the multishot receive). An
+// instance must only be used by one thread at a time.
+class CIoUring
+{
+public:
+    CIoUring();
+    ~CIoUring() { Close(); }
+
+    // do not copy the mapped rings
+    CIoUring ( const CIoUring& ) = delete;
+    CIoUring& operator= ( const CIoUring& ) = delete;
+
+    bool Init ( const unsigned int iNumEntries, const unsigned int iNumCqEntries = 0 );
+    void Close();
+    bool IsInitialized() const { return iRingFd >= 0; }
+
+    // returns nullptr if the submission queue is full, the returned entry is cleared
+    struct io_uring_sqe* GetSqe();
+
+    // submits all prepared entries and waits for iWaitNr completions (with a
+    // timeout if iTimeoutMs is not negative), returns the io_uring_enter() result
+    int Submit ( const unsigned int iWaitNr = 0, const int iTimeoutMs = -1 );
+
+    // drops the prepared entries which were not taken by the last Submit() (e.g.
+    // on an error), they are never submitted later
+    void DiscardUnsubmitted();
+
+    // returns nullptr if no completion is available, AdvanceCq() consumes the
+    // completion returned by PeekCqe()
+    struct io_uring_cqe* PeekCqe();
+    void                 AdvanceCq();
+
+    // provided buffers for IOSQE_BUFFER_SELECT (iNumBufs must be a power of two)
+    bool     RegisterBufRing ( const int iGroupID, const int iNumBufs, const int iBufSize );
+    uint8_t* GetBuf ( const int iBufID ) { return pBufs + static_cast<size_t> ( iBufID ) * iBufSize; }
+    void     RecycleBuf ( const int iBufID );
+
+protected:
+    int iRingFd;
+
+    // submission queue
+    void*                pSqRing;
+    size_t               iSqRingSize;
+    struct io_uring_sqe* pSqes;
+    size_t               iSqesSize;
+    unsigned int*        pSqHead;
+    unsigned int*        pSqTail;
+    unsigned int*        pSqArray;
+    unsigned int         iSqMask;
+    unsigned int         iSqEntries;
+    unsigned int         iSqLocalTail; // includes the prepared entries
+
+    // completion queue (may share the mapping with the submission queue)
+    void*                pCqRing;
+    size_t               iCqRingSize;
+    struct io_uring_cqe* pCqes;
+    unsigned int*        pCqHead;
+    unsigned int*        pCqTail;
+    unsigned int         iCqMask;
+
+    // provided buffers
+    struct io_uring_buf_ring* pBufRing;
+    size_t                    iBufRingSize;
+    uint8_t*                  pBufs;
+    size_t                    iBufsSize;
+    int                       iBufGroupID;
+    int                       iNumBufs;
+    int                       iBufSize;
+    unsigned short            iBufTail;
+};
+#endif
@@ -87,6 +87,17 @@ int main ( int argc, char** argv )
     bool         bDisconnectAllClientsOnQuit = false;
     bool         bUseDoubleSystemFrameSize   = true; // default is 128 samples frame size
     bool         bUseMultithreading          = false;
+    bool         bUseRealTimeMixer           = false;
+    bool         bUseSharedMixBus            = false;
+    int          iMaxNumTopTalkers           = 0;
+    bool         bUseFloatPipeline           = false;
+    bool         bDecodeOnArrival            = false;
+    int          iRecvBatchSize              = 1;
+    int          iNumRecvSockets             = 1;
+    bool         bUseIoUring                 = false;
+    bool         bUseJitterHistogram         = false;
+    bool         bUseInboundRing             = false;
+    bool         bUseAdaptivePlayout         = false;
     bool         bShowAnalyzerConsole        = false;
     bool         bMuteStream                 = false;
     bool         bMuteMeInPersonalMix        = false;
@@ -246,6 +257,18 @@ int main ( int argc, char** argv )
             continue;
         }
 
+        // Adaptive playout ----------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--adaptiveplayout", // no short form
+                               "--adaptiveplayout" ) )
+        {
+            bUseAdaptivePlayout = true;
+            qInfo() << "- adaptive playout enabled";
+            CommandLineOptions << "--adaptiveplayout";
+            continue;
+        }
+
         // Server only:
 
         // Disconnect all clients on quit --------------------------------------
@@ -407,6 +430,127 @@ int main ( int argc, char** argv )
             continue;
         }
 
+        // Real-time mixer thread ----------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--rtmixer", // no short form
+                               "--rtmixer" ) )
+        {
+            bUseRealTimeMixer = true;
+            qInfo() << "- using real-time mixer thread";
+            CommandLineOptions << "--rtmixer";
+            ServerOnlyOptions << "--rtmixer";
+            continue;
+        }
+
+        // Shared mix bus ------------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--sharedmixbus", // no short form
+                               "--sharedmixbus" ) )
+        {
+            bUseSharedMixBus = true;
+            qInfo() << "- using shared mix bus";
+            CommandLineOptions << "--sharedmixbus";
+            ServerOnlyOptions << "--sharedmixbus";
+            continue;
+        }
+
+        // Top talkers mixing --------------------------------------------------
+        if ( GetNumericArgument ( argc, argv, i, "--toptalkers", "--toptalkers", 1, MAX_NUM_CHANNELS, rDbleArgument ) )
+        {
+            iMaxNumTopTalkers = static_cast<int> ( rDbleArgument );
+            qInfo() << qUtf8Printable ( QString ( "- only mixing the %1 loudest sources" ).arg ( iMaxNumTopTalkers ) );
+            CommandLineOptions << "--toptalkers";
+            ServerOnlyOptions << "--toptalkers";
+            continue;
+        }
+
+        // Float pipeline ------------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--floatmixer", // no short form
+                               "--floatmixer" ) )
+        {
+            bUseFloatPipeline = true;
+            qInfo() << "- using float audio pipeline";
+            CommandLineOptions << "--floatmixer";
+            ServerOnlyOptions << "--floatmixer";
+            continue;
+        }
+
+        // Decode on arrival ---------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--decodeonarrival", // no short form
+                               "--decodeonarrival" ) )
+        {
+            bDecodeOnArrival = true;
+            qInfo() << "- decoding the audio on arrival";
+            CommandLineOptions << "--decodeonarrival";
+            ServerOnlyOptions << "--decodeonarrival";
+            continue;
+        }
+
+        // Batched receive -----------------------------------------------------
+        if ( GetNumericArgument ( argc, argv, i, "--recvbatch", "--recvbatch", 1, MAX_RECV_BATCH_SIZE, rDbleArgument ) )
+        {
+            iRecvBatchSize = static_cast<int> ( rDbleArgument );
+            qInfo() << qUtf8Printable ( QString ( "- receiving up to %1 packets per system call" ).arg ( iRecvBatchSize ) );
+            CommandLineOptions << "--recvbatch";
+            ServerOnlyOptions << "--recvbatch";
+            continue;
+        }
+
+        // Number of receive sockets -------------------------------------------
+        if ( GetNumericArgument ( argc, argv, i, "--recvsockets", "--recvsockets", 1, MAX_NUM_RECV_SOCKETS, rDbleArgument ) )
+        {
+            iNumRecvSockets = static_cast<int> ( rDbleArgument );
+            qInfo() << qUtf8Printable ( QString ( "- receiving on %1 sockets" ).arg ( iNumRecvSockets ) );
+            CommandLineOptions << "--recvsockets";
+            ServerOnlyOptions << "--recvsockets";
+            continue;
+        }
+
+        // io_uring ------------------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--iouring", // no short form
+                               "--iouring" ) )
+        {
+            bUseIoUring = true;
+            qInfo() << "- receiving and sending through io_uring";
+            CommandLineOptions << "--iouring";
+            ServerOnlyOptions << "--iouring";
+            continue;
+        }
+
+        // Histogram jitter estimator ------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--jitterhistogram", // no short form
+                               "--jitterhistogram" ) )
+        {
+            bUseJitterHistogram = true;
+            qInfo() << "- using the histogram jitter estimator";
+            CommandLineOptions << "--jitterhistogram";
+            ServerOnlyOptions << "--jitterhistogram";
+            continue;
+        }
+
+        // Inbound ring --------------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--inboundring", // no short form
+                               "--inboundring" ) )
+        {
+            bUseInboundRing = true;
+            qInfo() << "- handing the received audio over to the mixer through lock-free rings";
+            CommandLineOptions << "--inboundring";
+            ServerOnlyOptions << "--inboundring";
+            continue;
+        }
+
         // Server mode flag ----------------------------------------------------
         if ( GetFlagArgument ( argv, i, "-s", "--server" ) )
         {
@@ -945,7 +1089,8 @@ int main ( int argc, char** argv )
                              bNoAutoJackConnect,
                              strClientName,
                              bEnableIPv6,
-                             bMuteMeInPersonalMix );
+                             bMuteMeInPersonalMix,
+                             bUseAdaptivePlayout );
 
             // load settings from init-file (command line options override)
             CClientSettings Settings ( &Client, strIniFileName );
@@ -996,6 +1141,21 @@ int main ( int argc, char** argv )
 #endif
         {
             // Server:
+            // mixer and network tuning options
+            SServerTuningOptions ServerTuning;
+
+            ServerTuning.bUseRealTimeMixer   = bUseRealTimeMixer;
+            ServerTuning.bUseSharedMixBus    = bUseSharedMixBus;
+            ServerTuning.iMaxNumTopTalkers   = iMaxNumTopTalkers;
+            ServerTuning.bUseFloatPipeline   = bUseFloatPipeline;
+            ServerTuning.bDecodeOnArrival    = bDecodeOnArrival;
+            ServerTuning.iRecvBatchSize      = iRecvBatchSize;
+            ServerTuning.iNumRecvSockets     = iNumRecvSockets;
+            ServerTuning.bUseIoUring         = bUseIoUring;
+            ServerTuning.bUseJitterHistogram = bUseJitterHistogram;
+            ServerTuning.bUseInboundRing     = bUseInboundRing;
+            ServerTuning.bUseAdaptivePlayout = bUseAdaptivePlayout;
+
             // actual server object
             CServer Server ( iNumServerChannels,
                              strLoggingFileName,
@@ -1013,6 +1173,7 @@ int main ( int argc, char** argv )
                              bDisconnectAllClientsOnQuit,
                              bUseDoubleSystemFrameSize,
                              bUseMultithreading,
+                             ServerTuning,
                              bDisableRecording,
                              bDelayPan,
                              bEnableIPv6,
@@ -1104,6 +1265,8 @@ QString UsageArguments ( char** argv )
            "  -v, --version           display version information and exit\n"
            "\n"
            "Common options:\n"
+           "      --adaptiveplayout   stretch or compress the received audio to keep\n"
+           "                          the jitter buffer short\n"
            "  -i, --inifile           initialization file name\n"
            "                          (not supported for headless Server mode)\n"
            "  -n, --nogui             disable GUI (\"headless\")\n"
@@ -1121,12 +1284,22 @@ QString UsageArguments ( char** argv )
            "\n"
            "Server only:\n"
            "  -d, --discononquit      disconnect all Clients on quit\n"
+           "      --decodeonarrival   decode the audio of each Client as soon as it is\n"
+           "                          received instead of in the processing tick\n"
            "  -e, --directoryaddress  address of the Directory with which to register\n"
            "                          (or 'localhost' to run as a Directory)\n"
            "      --directoryfile     File to hold server list across Directory restarts. Directories only.\n"
            "  -f, --listfilter        Server list whitelist filter. Directories only. Format:\n"
            "                          [IP address 1];[IP address 2];[IP address 3]; ...\n"
            "  -F, --fastupdate        use 64 samples frame size mode\n"
+           "      --floatmixer        decode, mix and encode the audio in float\n"
+           "                          precision without int16 conversions\n"
+           "      --inboundring       hand the received audio over to the mixer through\n"
+           "                          a lock-free ring per channel\n"
+           "      --iouring           receive and send the network packets through\n"
+           "                          io_uring (Linux only)\n"
+           "      --jitterhistogram   derive the auto jitter buffer size from a delay\n"
+           "                          histogram instead of simulated buffers\n"
            "  -l, --log               enable logging, set file name\n"
            "  -L, --licence           show an agreement window before users can connect\n"
            "  -m, --htmlstatus        enable HTML status file, set file name\n"
@@ -1138,8 +1311,18 @@ QString UsageArguments ( char** argv )
            "  -P, --delaypan          start with delay panning enabled\n"
            "  -R, --recording         set server recording directory; server will record when a session is active by default\n"
            "      --norecord          set server not to record by default when recording is configured\n"
+           "      --recvbatch         receive up to the given number of packets per\n"
+           "                          system call (Linux only, default 1)\n"
+           "      --recvsockets       number of sockets (each with its own thread) which\n"
+           "                          receive on the server port (Linux only, default 1)\n"
+           "      --rtmixer           process the audio in a dedicated real-time thread\n"
+           "                          (SCHED_FIFO if permitted, not supported on Windows)\n"
            "  -s, --server            start Server\n"
+           "      --sharedmixbus      mix a common bus and only apply the individual\n"
+           "                          gain/pan changes for each Client\n"
            "      --serverbindip      IP address the Server will bind to (rather than all)\n"
+           "      --toptalkers        only mix the given number of loudest sources plus\n"
+           "                          the own signal of each Client (for large rooms)\n"
            "  -T, --multithreading    use multithreading to make better use of\n"
            "                          multi-core CPUs and support more Clients\n"
            "  -u, --numchannels       maximum number of channels\n"
@@ -0,0 +1,784 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include "mixkernels.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#    define MIX_KERNELS_X86
+#    include <immintrin.h>
+#    if defined( _MSC_VER ) && !defined( __clang__ )
+#        include <intrin.h>
+// MSVC does not need special flags to use the intrinsics
+#        define MIX_TARGET_SSE2
+#        define MIX_TARGET_AVX2
+#    else
+// only the kernel functions are compiled for the extended instruction sets,
+// the rest of the code keeps the flags of the project
+#        define MIX_TARGET_SSE2 __attribute__ ( ( target ( "sse2" ) ) )
+#        define MIX_TARGET_AVX2 __attribute__ ( ( target ( "avx2" ) ) )
+#    endif
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( __aarch64__ ) || defined( _M_ARM64 )
+#    define MIX_KERNELS_NEON
+#    include <arm_neon.h>
+#endif
+
+/* Scalar reference implementation ********************************************/
+// The accumulation is the same for int16 and float source samples.
+template<typename TSample>
+static void MonoToMonoScalar ( float* pfOut, const TSample* pIn, const int iNumSamples, const float fGain )
+{
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        pfOut[i] += pIn[i] * fGain;
+    }
+}
+
+template<typename TSample>
+static void StereoToMonoScalar ( float* pfOut, const TSample* pIn, const int iNumSamples, const float fGain )
+{
+    for ( int i = 0, k = 0; i < iNumSamples; i++, k += 2 )
+    {
+        pfOut[i] += fGain * ( static_cast<float> ( pIn[k] ) + pIn[k + 1] ) / 2;
+    }
+}
+
+template<typename TSample>
+static void MonoToStereoScalar ( float* pfOut, const TSample* pIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    for ( int i = 0, k = 0; i < iNumSamples; i++, k += 2 )
+    {
+        pfOut[k] += pIn[i] * fGainL;
+        pfOut[k + 1] += pIn[i] * fGainR;
+    }
+}
+
+template<typename TSample>
+static void StereoToStereoScalar ( float* pfOut, const TSample* pIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    for ( int k = 0; k < 2 * iNumSamples; k += 2 )
+    {
+        pfOut[k] += pIn[k] * fGainL;
+        pfOut[k + 1] += pIn[k + 1] * fGainR;
+    }
+}
+
+static void SaturateScalar ( int16_t* psOut, const float* pfIn, const int iNumValues )
+{
+    for ( int i = 0; i < iNumValues; i++ )
+    {
+        // same as Float2Short()
+        if ( pfIn[i] < -32768.0f )
+        {
+            psOut[i] = -32768;
+        }
+        else if ( pfIn[i] > 32767.0f )
+        {
+            psOut[i] = 32767;
+        }
+        else
+        {
+            psOut[i] = static_cast<int16_t> ( pfIn[i] );
+        }
+    }
+}
+
+static void ClipScalar ( float* pfOut, const float* pfIn, const int iNumValues )
+{
+    for ( int i = 0; i < iNumValues; i++ )
+    {
+        pfOut[i] = std::min ( std::max ( pfIn[i], -1.0f ), 1.0f );
+    }
+}
+
+#ifdef MIX_KERNELS_X86
+/* SSE2 implementation ********************************************************/
+// Note that the sum of the two stereo samples is calculated in integer which is
+// exact (the result fits into the float mantissa) and that a multiplication by
+// 0.5 gives the same result as a division by 2.
+MIX_TARGET_SSE2 static inline void LoadShort8Sse2 ( const int16_t* psIn, __m128& fLo, __m128& fHi )
+{
+    const __m128i iIn = _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( psIn ) );
+
+    // sign extension: put the samples in the upper 16 bits and shift them back
+    fLo = _mm_cvtepi32_ps ( _mm_srai_epi32 ( _mm_unpacklo_epi16 ( iIn, iIn ), 16 ) );
+    fHi = _mm_cvtepi32_ps ( _mm_srai_epi32 ( _mm_unpackhi_epi16 ( iIn, iIn ), 16 ) );
+}
+
+MIX_TARGET_SSE2 static inline void AccumSse2 ( float* pfOut, const __m128 fIn )
+{
+    _mm_storeu_ps ( pfOut, _mm_add_ps ( _mm_loadu_ps ( pfOut ), fIn ) );
+}
+
+MIX_TARGET_SSE2 static void MonoToMonoSse2 ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGain )
+{
+    const __m128 fG = _mm_set1_ps ( fGain );
+    int          i  = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        __m128 fLo, fHi;
+        LoadShort8Sse2 ( &psIn[i], fLo, fHi );
+        AccumSse2 ( &pfOut[i], _mm_mul_ps ( fLo, fG ) );
+        AccumSse2 ( &pfOut[i + 4], _mm_mul_ps ( fHi, fG ) );
+    }
+
+    MonoToMonoScalar ( &pfOut[i], &psIn[i], iNumSamples - i, fGain );
+}
+
+MIX_TARGET_SSE2 static void StereoToMonoSse2 ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGain )
+{
+    const __m128  fG    = _mm_set1_ps ( fGain );
+    const __m128  fHalf = _mm_set1_ps ( 0.5f );
+    const __m128i iOnes = _mm_set1_epi16 ( 1 );
+    int           i     = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        // left + right of four sample pairs
+        const __m128i iSum = _mm_madd_epi16 ( _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( &psIn[2 * i] ) ), iOnes );
+
+        AccumSse2 ( &pfOut[i], _mm_mul_ps ( _mm_mul_ps ( _mm_cvtepi32_ps ( iSum ), fG ), fHalf ) );
+    }
+
+    StereoToMonoScalar ( &pfOut[i], &psIn[2 * i], iNumSamples - i, fGain );
+}
+
+MIX_TARGET_SSE2 static void MonoToStereoSse2 ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const __m128 fGLR = _mm_setr_ps ( fGainL, fGainR, fGainL, fGainR );
+    int          i    = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        __m128 fLo, fHi;
+        LoadShort8Sse2 ( &psIn[i], fLo, fHi );
+        AccumSse2 ( &pfOut[2 * i], _mm_mul_ps ( _mm_unpacklo_ps ( fLo, fLo ), fGLR ) );
+        AccumSse2 ( &pfOut[2 * i + 4], _mm_mul_ps ( _mm_unpackhi_ps ( fLo, fLo ), fGLR ) );
+        AccumSse2 ( &pfOut[2 * i + 8], _mm_mul_ps ( _mm_unpacklo_ps ( fHi, fHi ), fGLR ) );
+        AccumSse2 ( &pfOut[2 * i + 12], _mm_mul_ps ( _mm_unpackhi_ps ( fHi, fHi ), fGLR ) );
+    }
+
+    MonoToStereoScalar ( &pfOut[2 * i], &psIn[i], iNumSamples - i, fGainL, fGainR );
+}
+
+MIX_TARGET_SSE2 static void StereoToStereoSse2 ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const __m128 fGLR = _mm_setr_ps ( fGainL, fGainR, fGainL, fGainR );
+    int          i    = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        __m128 fLo, fHi;
+        LoadShort8Sse2 ( &psIn[2 * i], fLo, fHi );
+        AccumSse2 ( &pfOut[2 * i], _mm_mul_ps ( fLo, fGLR ) );
+        AccumSse2 ( &pfOut[2 * i + 4], _mm_mul_ps ( fHi, fGLR ) );
+    }
+
+    StereoToStereoScalar ( &pfOut[2 * i], &psIn[2 * i], iNumSamples - i, fGainL, fGainR );
+}
+
+MIX_TARGET_SSE2 static void SaturateSse2 ( int16_t* psOut, const float* pfIn, const int iNumValues )
+{
+    const __m128 fMin = _mm_set1_ps ( -32768.0f );
+    const __m128 fMax = _mm_set1_ps ( 32767.0f );
+    int          i    = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        // clip first, then truncate towards zero like the static_cast does
+        const __m128i iLo = _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( _mm_loadu_ps ( &pfIn[i] ), fMin ), fMax ) );
+        const __m128i iHi = _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( _mm_loadu_ps ( &pfIn[i + 4] ), fMin ), fMax ) );
+
+        _mm_storeu_si128 ( reinterpret_cast<__m128i*> ( &psOut[i] ), _mm_packs_epi32 ( iLo, iHi ) );
+    }
+
+    SaturateScalar ( &psOut[i], &pfIn[i], iNumValues - i );
+}
+
+// The float kernels deinterleave/duplicate with shuffles only, the arithmetic
+// is the same as for the int16 kernels.
+MIX_TARGET_SSE2 static void MonoToMonoFloatSse2 ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGain )
+{
+    const __m128 fG = _mm_set1_ps ( fGain );
+    int          i  = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        AccumSse2 ( &pfOut[i], _mm_mul_ps ( _mm_loadu_ps ( &pfIn[i] ), fG ) );
+    }
+
+    MonoToMonoScalar ( &pfOut[i], &pfIn[i], iNumSamples - i, fGain );
+}
+
+MIX_TARGET_SSE2 static void StereoToMonoFloatSse2 ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGain )
+{
+    const __m128 fG    = _mm_set1_ps ( fGain );
+    const __m128 fHalf = _mm_set1_ps ( 0.5f );
+    int          i     = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        const __m128 fA = _mm_loadu_ps ( &pfIn[2 * i] );
+        const __m128 fB = _mm_loadu_ps ( &pfIn[2 * i + 4] );
+
+        // left + right of four sample pairs
+        const __m128 fL   = _mm_shuffle_ps ( fA, fB, _MM_SHUFFLE ( 2, 0, 2, 0 ) );
+        const __m128 fR   = _mm_shuffle_ps ( fA, fB, _MM_SHUFFLE ( 3, 1, 3, 1 ) );
+        const __m128 fSum = _mm_add_ps ( fL, fR );
+
+        AccumSse2 ( &pfOut[i], _mm_mul_ps ( _mm_mul_ps ( fSum, fG ), fHalf ) );
+    }
+
+    StereoToMonoScalar ( &pfOut[i], &pfIn[2 * i], iNumSamples - i, fGain );
+}
+
+MIX_TARGET_SSE2 static void MonoToStereoFloatSse2 ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const __m128 fGLR = _mm_setr_ps ( fGainL, fGainR, fGainL, fGainR );
+    int          i    = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        const __m128 fIn = _mm_loadu_ps ( &pfIn[i] );
+        AccumSse2 ( &pfOut[2 * i], _mm_mul_ps ( _mm_unpacklo_ps ( fIn, fIn ), fGLR ) );
+        AccumSse2 ( &pfOut[2 * i + 4], _mm_mul_ps ( _mm_unpackhi_ps ( fIn, fIn ), fGLR ) );
+    }
+
+    MonoToStereoScalar ( &pfOut[2 * i], &pfIn[i], iNumSamples - i, fGainL, fGainR );
+}
+
+MIX_TARGET_SSE2 static void StereoToStereoFloatSse2 ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const __m128 fGLR = _mm_setr_ps ( fGainL, fGainR, fGainL, fGainR );
+    int          i    = 0;
+
+    for ( ; i + 2 <= iNumSamples; i += 2 )
+    {
+        AccumSse2 ( &pfOut[2 * i], _mm_mul_ps ( _mm_loadu_ps ( &pfIn[2 * i] ), fGLR ) );
+    }
+
+    StereoToStereoScalar ( &pfOut[2 * i], &pfIn[2 * i], iNumSamples - i, fGainL, fGainR );
+}
+
+MIX_TARGET_SSE2 static void ClipSse2 ( float* pfOut, const float* pfIn, const int iNumValues )
+{
+    const __m128 fMin = _mm_set1_ps ( -1.0f );
+    const __m128 fMax = _mm_set1_ps ( 1.0f );
+    int          i    = 0;
+
+    for ( ; i + 4 <= iNumValues; i += 4 )
+    {
+        _mm_storeu_ps ( &pfOut[i], _mm_min_ps ( _mm_max_ps ( _mm_loadu_ps ( &pfIn[i] ), fMin ), fMax ) );
+    }
+
+    ClipScalar ( &pfOut[i], &pfIn[i], iNumValues - i );
+}
+
+/* AVX2 implementation ********************************************************/
+MIX_TARGET_AVX2 static inline __m256 LoadShort8Avx2 ( const int16_t* psIn )
+{
+    return _mm256_cvtepi32_ps ( _mm256_cvtepi16_epi32 ( _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( psIn ) ) ) );
+}
+
+MIX_TARGET_AVX2 static inline void AccumAvx2 ( float* pfOut, const __m256 fIn )
+{
+    _mm256_storeu_ps ( pfOut, _mm256_add_ps ( _mm256_loadu_ps ( pfOut ), fIn ) );
+}
+
+MIX_TARGET_AVX2 static void MonoToMonoAvx2 ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGain )
+{
+    const __m256 fG = _mm256_set1_ps ( fGain );
+    int          i  = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        AccumAvx2 ( &pfOut[i], _mm256_mul_ps ( LoadShort8Avx2 ( &psIn[i] ), fG ) );
+    }
+
+    MonoToMonoScalar ( &pfOut[i], &psIn[i], iNumSamples - i, fGain );
+}
+
+MIX_TARGET_AVX2 static void StereoToMonoAvx2 ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGain )
+{
+    const __m256  fG    = _mm256_set1_ps ( fGain );
+    const __m256  fHalf = _mm256_set1_ps ( 0.5f );
+    const __m256i iOnes = _mm256_set1_epi16 ( 1 );
+    int           i     = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        // left + right of eight sample pairs (the lane-wise madd keeps the order)
+        const __m256i iSum = _mm256_madd_epi16 ( _mm256_loadu_si256 ( reinterpret_cast<const __m256i*> ( &psIn[2 * i] ) ), iOnes );
+
+        AccumAvx2 ( &pfOut[i], _mm256_mul_ps ( _mm256_mul_ps ( _mm256_cvtepi32_ps ( iSum ), fG ), fHalf ) );
+    }
+
+    StereoToMonoScalar ( &pfOut[i], &psIn[2 * i], iNumSamples - i, fGain );
+}
+
+MIX_TARGET_AVX2 static void MonoToStereoAvx2 ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const __m256 fGLR = _mm256_setr_ps ( fGainL, fGainR, fGainL, fGainR, fGainL, fGainR, fGainL, fGainR );
+    int          i    = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        const __m256 fIn = LoadShort8Avx2 ( &psIn[i] );
+
+        // the unpack works per 128 bit lane, the permute restores the sample order
+        const __m256 fLo = _mm256_unpacklo_ps ( fIn, fIn );
+        const __m256 fHi = _mm256_unpackhi_ps ( fIn, fIn );
+
+        AccumAvx2 ( &pfOut[2 * i], _mm256_mul_ps ( _mm256_permute2f128_ps ( fLo, fHi, 0x20 ), fGLR ) );
+        AccumAvx2 ( &pfOut[2 * i + 8], _mm256_mul_ps ( _mm256_permute2f128_ps ( fLo, fHi, 0x31 ), fGLR ) );
+    }
+
+    MonoToStereoScalar ( &pfOut[2 * i], &psIn[i], iNumSamples - i, fGainL, fGainR );
+}
+
+MIX_TARGET_AVX2 static void StereoToStereoAvx2 ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const __m256 fGLR = _mm256_setr_ps ( fGainL, fGainR, fGainL, fGainR, fGainL, fGainR, fGainL, fGainR );
+    int          i    = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        AccumAvx2 ( &pfOut[2 * i], _mm256_mul_ps ( LoadShort8Avx2 ( &psIn[2 * i] ), fGLR ) );
+    }
+
+    StereoToStereoScalar ( &pfOut[2 * i], &psIn[2 * i], iNumSamples - i, fGainL, fGainR );
+}
+
+MIX_TARGET_AVX2 static void SaturateAvx2 ( int16_t* psOut, const float* pfIn, const int iNumValues )
+{
+    const __m256 fMin = _mm256_set1_ps ( -32768.0f );
+    const __m256 fMax = _mm256_set1_ps ( 32767.0f );
+    int          i    = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        const __m256i iOut = _mm256_cvttps_epi32 ( _mm256_min_ps ( _mm256_max_ps ( _mm256_loadu_ps ( &pfIn[i] ), fMin ), fMax ) );
+
+        _mm_storeu_si128 ( reinterpret_cast<__m128i*> ( &psOut[i] ),
+                           _mm_packs_epi32 ( _mm256_castsi256_si128 ( iOut ), _mm256_extracti128_si256 ( iOut, 1 ) ) );
+    }
+
+    SaturateScalar ( &psOut[i], &pfIn[i], iNumValues - i );
+}
+
+MIX_TARGET_AVX2 static void MonoToMonoFloatAvx2 ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGain )
+{
+    const __m256 fG = _mm256_set1_ps ( fGain );
+    int          i  = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        AccumAvx2 ( &pfOut[i], _mm256_mul_ps ( _mm256_loadu_ps ( &pfIn[i] ), fG ) );
+    }
+
+    MonoToMonoScalar ( &pfOut[i], &pfIn[i], iNumSamples - i, fGain );
+}
+
+MIX_TARGET_AVX2 static void StereoToMonoFloatAvx2 ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGain )
+{
+    const __m256 fG    = _mm256_set1_ps ( fGain );
+    const __m256 fHalf = _mm256_set1_ps ( 0.5f );
+    int          i     = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        const __m256 fA = _mm256_loadu_ps ( &pfIn[2 * i] );
+        const __m256 fB = _mm256_loadu_ps ( &pfIn[2 * i + 8] );
+
+        // left + right of eight sample pairs, the shuffle works per 128 bit
+        // lane, the permute restores the sample order
+        const __m256 fL   = _mm256_shuffle_ps ( fA, fB, _MM_SHUFFLE ( 2, 0, 2, 0 ) );
+        const __m256 fR   = _mm256_shuffle_ps ( fA, fB, _MM_SHUFFLE ( 3, 1, 3, 1 ) );
+        const __m256 fSum = _mm256_add_ps ( fL, fR );
+        const __m256 fOrd = _mm256_castpd_ps ( _mm256_permute4x64_pd ( _mm256_castps_pd ( fSum ), _MM_SHUFFLE ( 3, 1, 2, 0 ) ) );
+
+        AccumAvx2 ( &pfOut[i], _mm256_mul_ps ( _mm256_mul_ps ( fOrd, fG ), fHalf ) );
+    }
+
+    StereoToMonoScalar ( &pfOut[i], &pfIn[2 * i], iNumSamples - i, fGain );
+}
+
+MIX_TARGET_AVX2 static void MonoToStereoFloatAvx2 ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const __m256 fGLR = _mm256_setr_ps ( fGainL, fGainR, fGainL, fGainR, fGainL, fGainR, fGainL, fGainR );
+    int          i    = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        const __m256 fIn = _mm256_loadu_ps ( &pfIn[i] );
+
+        // the unpack works per 128 bit lane, the permute restores the sample order
+        const __m256 fLo = _mm256_unpacklo_ps ( fIn, fIn );
+        const __m256 fHi = _mm256_unpackhi_ps ( fIn, fIn );
+
+        AccumAvx2 ( &pfOut[2 * i], _mm256_mul_ps ( _mm256_permute2f128_ps ( fLo, fHi, 0x20 ), fGLR ) );
+        AccumAvx2 ( &pfOut[2 * i + 8], _mm256_mul_ps ( _mm256_permute2f128_ps ( fLo, fHi, 0x31 ), fGLR ) );
+    }
+
+    MonoToStereoScalar ( &pfOut[2 * i], &pfIn[i], iNumSamples - i, fGainL, fGainR );
+}
+
+MIX_TARGET_AVX2 static void StereoToStereoFloatAvx2 ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const __m256 fGLR = _mm256_setr_ps ( fGainL, fGainR, fGainL, fGainR, fGainL, fGainR, fGainL, fGainR );
+    int          i    = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        AccumAvx2 ( &pfOut[2 * i], _mm256_mul_ps ( _mm256_loadu_ps ( &pfIn[2 * i] ), fGLR ) );
+    }
+
+    StereoToStereoScalar ( &pfOut[2 * i], &pfIn[2 * i], iNumSamples - i, fGainL, fGainR );
+}
+
+MIX_TARGET_AVX2 static void ClipAvx2 ( float* pfOut, const float* pfIn, const int iNumValues )
+{
+    const __m256 fMin = _mm256_set1_ps ( -1.0f );
+    const __m256 fMax = _mm256_set1_ps ( 1.0f );
+    int          i    = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        _mm256_storeu_ps ( &pfOut[i], _mm256_min_ps ( _mm256_max_ps ( _mm256_loadu_ps ( &pfIn[i] ), fMin ), fMax ) );
+    }
+
+    ClipScalar ( &pfOut[i], &pfIn[i], iNumValues - i );
+}
+#endif
+
+#ifdef MIX_KERNELS_NEON
+/* NEON implementation ********************************************************/
+// Note that separate multiply and add intrinsics are used on purpose (vmlaq_f32
+// may be fused on some targets which would change the rounding).
+static inline void LoadShort8Neon ( const int16_t* psIn, float32x4_t& fLo, float32x4_t& fHi )
+{
+    const int16x8_t iIn = vld1q_s16 ( psIn );
+
+    fLo = vcvtq_f32_s32 ( vmovl_s16 ( vget_low_s16 ( iIn ) ) );
+    fHi = vcvtq_f32_s32 ( vmovl_s16 ( vget_high_s16 ( iIn ) ) );
+}
+
+static inline void AccumNeon ( float* pfOut, const float32x4_t fIn ) { vst1q_f32 ( pfOut, vaddq_f32 ( vld1q_f32 ( pfOut ), fIn ) ); }
+
+static inline float32x4_t StereoGainsNeon ( const float fGainL, const float fGainR )
+{
+    const float vfGains[4] = { fGainL, fGainR, fGainL, fGainR };
+
+    return vld1q_f32 ( vfGains );
+}
+
+static void MonoToMonoNeon ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGain )
+{
+    const float32x4_t fG = vdupq_n_f32 ( fGain );
+    int               i  = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        float32x4_t fLo, fHi;
+        LoadShort8Neon ( &psIn[i], fLo, fHi );
+        AccumNeon ( &pfOut[i], vmulq_f32 ( fLo, fG ) );
+        AccumNeon ( &pfOut[i + 4], vmulq_f32 ( fHi, fG ) );
+    }
+
+    MonoToMonoScalar ( &pfOut[i], &psIn[i], iNumSamples - i, fGain );
+}
+
+static void StereoToMonoNeon ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGain )
+{
+    const float32x4_t fG    = vdupq_n_f32 ( fGain );
+    const float32x4_t fHalf = vdupq_n_f32 ( 0.5f );
+    int               i     = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        // pairwise widening add gives left + right of four sample pairs
+        const int32x4_t iSum = vpaddlq_s16 ( vld1q_s16 ( &psIn[2 * i] ) );
+
+        AccumNeon ( &pfOut[i], vmulq_f32 ( vmulq_f32 ( vcvtq_f32_s32 ( iSum ), fG ), fHalf ) );
+    }
+
+    StereoToMonoScalar ( &pfOut[i], &psIn[2 * i], iNumSamples - i, fGain );
+}
+
+static void MonoToStereoNeon ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const float32x4_t fGLR = StereoGainsNeon ( fGainL, fGainR );
+    int               i    = 0;
+
+    for ( ; i + 8 <= iNumSamples; i += 8 )
+    {
+        float32x4_t fLo, fHi;
+        LoadShort8Neon ( &psIn[i], fLo, fHi );
+
+        const float32x4x2_t fLoDup = vzipq_f32 ( fLo, fLo );
+        const float32x4x2_t fHiDup = vzipq_f32 ( fHi, fHi );
+
+        AccumNeon ( &pfOut[2 * i], vmulq_f32 ( fLoDup.val[0], fGLR ) );
+        AccumNeon ( &pfOut[2 * i + 4], vmulq_f32 ( fLoDup.val[1], fGLR ) );
+        AccumNeon ( &pfOut[2 * i + 8], vmulq_f32 ( fHiDup.val[0], fGLR ) );
+        AccumNeon ( &pfOut[2 * i + 12], vmulq_f32 ( fHiDup.val[1], fGLR ) );
+    }
+
+    MonoToStereoScalar ( &pfOut[2 * i], &psIn[i], iNumSamples - i, fGainL, fGainR );
+}
+
+static void StereoToStereoNeon ( float* pfOut, const int16_t* psIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const float32x4_t fGLR = StereoGainsNeon ( fGainL, fGainR );
+    int               i    = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        float32x4_t fLo, fHi;
+        LoadShort8Neon ( &psIn[2 * i], fLo, fHi );
+        AccumNeon ( &pfOut[2 * i], vmulq_f32 ( fLo, fGLR ) );
+        AccumNeon ( &pfOut[2 * i + 4], vmulq_f32 ( fHi, fGLR ) );
+    }
+
+    StereoToStereoScalar ( &pfOut[2 * i], &psIn[2 * i], iNumSamples - i, fGainL, fGainR );
+}
+
+static void SaturateNeon ( int16_t* psOut, const float* pfIn, const int iNumValues )
+{
+    const float32x4_t fMin = vdupq_n_f32 ( -32768.0f );
+    const float32x4_t fMax = vdupq_n_f32 ( 32767.0f );
+    int               i    = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        // clip first, then truncate towards zero like the static_cast does
+        const int32x4_t iLo = vcvtq_s32_f32 ( vminq_f32 ( vmaxq_f32 ( vld1q_f32 ( &pfIn[i] ), fMin ), fMax ) );
+        const int32x4_t iHi = vcvtq_s32_f32 ( vminq_f32 ( vmaxq_f32 ( vld1q_f32 ( &pfIn[i + 4] ), fMin ), fMax ) );
+
+        vst1q_s16 ( &psOut[i], vcombine_s16 ( vqmovn_s32 ( iLo ), vqmovn_s32 ( iHi ) ) );
+    }
+
+    SaturateScalar ( &psOut[i], &pfIn[i], iNumValues - i );
+}
+
+static void MonoToMonoFloatNeon ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGain )
+{
+    const float32x4_t fG = vdupq_n_f32 ( fGain );
+    int               i  = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        AccumNeon ( &pfOut[i], vmulq_f32 ( vld1q_f32 ( &pfIn[i] ), fG ) );
+    }
+
+    MonoToMonoScalar ( &pfOut[i], &pfIn[i], iNumSamples - i, fGain );
+}
+
+static void StereoToMonoFloatNeon ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGain )
+{
+    const float32x4_t fG    = vdupq_n_f32 ( fGain );
+    const float32x4_t fHalf = vdupq_n_f32 ( 0.5f );
+    int               i     = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        // the deinterleaving load gives the left and right samples of four sample pairs
+        const float32x4x2_t fLR = vld2q_f32 ( &pfIn[2 * i] );
+
+        AccumNeon ( &pfOut[i], vmulq_f32 ( vmulq_f32 ( vaddq_f32 ( fLR.val[0], fLR.val[1] ), fG ), fHalf ) );
+    }
+
+    StereoToMonoScalar ( &pfOut[i], &pfIn[2 * i], iNumSamples - i, fGain );
+}
+
+static void MonoToStereoFloatNeon ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const float32x4_t fGLR = StereoGainsNeon ( fGainL, fGainR );
+    int               i    = 0;
+
+    for ( ; i + 4 <= iNumSamples; i += 4 )
+    {
+        const float32x4_t   fIn  = vld1q_f32 ( &pfIn[i] );
+        const float32x4x2_t fDup = vzipq_f32 ( fIn, fIn );
+
+        AccumNeon ( &pfOut[2 * i], vmulq_f32 ( fDup.val[0], fGLR ) );
+        AccumNeon ( &pfOut[2 * i + 4], vmulq_f32 ( fDup.val[1], fGLR ) );
+    }
+
+    MonoToStereoScalar ( &pfOut[2 * i], &pfIn[i], iNumSamples - i, fGainL, fGainR );
+}
+
+static void StereoToStereoFloatNeon ( float* pfOut, const float* pfIn, const int iNumSamples, const float fGainL, const float fGainR )
+{
+    const float32x4_t fGLR = StereoGainsNeon ( fGainL, fGainR );
+    int               i    = 0;
+
+    for ( ; i + 2 <= iNumSamples; i += 2 )
+    {
+        AccumNeon ( &pfOut[2 * i], vmulq_f32 ( vld1q_f32 ( &pfIn[2 * i] ), fGLR ) );
+    }
+
+    StereoToStereoScalar ( &pfOut[2 * i], &pfIn[2 * i], iNumSamples - i, fGainL, fGainR );
+}
+
+static void ClipNeon ( float* pfOut, const float* pfIn, const int iNumValues )
+{
+    const float32x4_t fMin = vdupq_n_f32 ( -1.0f );
+    const float32x4_t fMax = vdupq_n_f32 ( 1.0f );
+    int               i    = 0;
+
+    for ( ; i + 4 <= iNumValues; i += 4 )
+    {
+        vst1q_f32 ( &pfOut[i], vminq_f32 ( vmaxq_f32 ( vld1q_f32 ( &pfIn[i] ), fMin ), fMax ) );
+    }
+
+    ClipScalar ( &pfOut[i], &pfIn[i], iNumValues - i );
+}
+#endif
+
+/* Implementation *************************************************************/
+CMixKernels::EKernelArch CMixKernels::DetectArch()
+{
+#if defined( MIX_KERNELS_X86 )
+#    if defined( _MSC_VER ) && !defined( __clang__ )
+    int viCpuInfo[4];
+
+    __cpuid ( viCpuInfo, 0 );
+    const int iMaxLeaf = viCpuInfo[0];
+
+    __cpuid ( viCpuInfo, 1 );
+    const bool bHasSSE2 = ( viCpuInfo[3] & ( 1 << 26 ) ) != 0;
+    bool       bHasAVX2 = false;
+
+    // AVX2 requires that the OS saves the YMM registers (OSXSAVE, AVX and XCR0 check)
+    if ( ( iMaxLeaf >= 7 ) && ( viCpuInfo[2] & ( 1 << 27 ) ) && ( viCpuInfo[2] & ( 1 << 28 ) ) && ( ( _xgetbv ( 0 ) & 6 ) == 6 ) )
+    {
+        __cpuidex ( viCpuInfo, 7, 0 );
+        bHasAVX2 = ( viCpuInfo[1] & ( 1 << 5 ) ) != 0;
+    }
+#    else
+    __builtin_cpu_init();
+
+    const bool bHasSSE2 = __builtin_cpu_supports ( "sse2" );
+    const bool bHasAVX2 = __builtin_cpu_supports ( "avx2" );
+#    endif
+
+    if ( bHasAVX2 )
+    {
+        return KA_AVX2;
+    }
+
+    if ( bHasSSE2 )
+    {
+        return KA_SSE2;
+    }
+#elif defined( MIX_KERNELS_NEON )
+    return KA_NEON;
+#endif
+
+    return KA_SCALAR;
+}
+
+const char* CMixKernels::GetArchName ( const EKernelArch eArch )
+{
+    switch ( eArch )
+    {
+    case KA_SSE2:
+        return "SSE2";
+
+    case KA_AVX2:
+        return "AVX2";
+
+    case KA_NEON:
+        return "NEON";
+
+    default:
+        return "scalar";
+    }
+}
+
+void CMixKernels::SetArch ( const EKernelArch eNewArch )
+{
+    // the scalar kernels are the fallback for instruction sets which are not
+    // available in this build
+    eArch                = KA_SCALAR;
+    Int16.MonoToMono     = MonoToMonoScalar<int16_t>;
+    Int16.StereoToMono   = StereoToMonoScalar<int16_t>;
+    Int16.MonoToStereo   = MonoToStereoScalar<int16_t>;
+    Int16.StereoToStereo = StereoToStereoScalar<int16_t>;
+    Float.MonoToMono     = MonoToMonoScalar<float>;
+    Float.StereoToMono   = StereoToMonoScalar<float>;
+    Float.MonoToStereo   = MonoToStereoScalar<float>;
+    Float.StereoToStereo = StereoToStereoScalar<float>;
+    Saturate             = SaturateScalar;
+    Clip                 = ClipScalar;
+
+#if defined( MIX_KERNELS_X86 )
+    if ( eNewArch == KA_SSE2 )
+    {
+        eArch                = KA_SSE2;
+        Int16.MonoToMono     = MonoToMonoSse2;
+        Int16.StereoToMono   = StereoToMonoSse2;
+        Int16.MonoToStereo   = MonoToStereoSse2;
+        Int16.StereoToStereo = StereoToStereoSse2;
+        Float.MonoToMono     = MonoToMonoFloatSse2;
+        Float.StereoToMono   = StereoToMonoFloatSse2;
+        Float.MonoToStereo   = MonoToStereoFloatSse2;
+        Float.StereoToStereo = StereoToStereoFloatSse2;
+        Saturate             = SaturateSse2;
+        Clip                 = ClipSse2;
+    }
+    else if ( eNewArch == KA_AVX2 )
+    {
+        eArch                = KA_AVX2;
+        Int16.MonoToMono     = MonoToMonoAvx2;
+        Int16.StereoToMono   = StereoToMonoAvx2;
+        Int16.MonoToStereo   = MonoToStereoAvx2;
+        Int16.StereoToStereo = StereoToStereoAvx2;
+        Float.MonoToMono     = MonoToMonoFloatAvx2;
+        Float.StereoToMono   = StereoToMonoFloatAvx2;
+        Float.MonoToStereo   = MonoToStereoFloatAvx2;
+        Float.StereoToStereo = StereoToStereoFloatAvx2;
+        Saturate             = SaturateAvx2;
+        Clip                 = ClipAvx2;
+    }
+#elif defined( MIX_KERNELS_NEON )
+    if ( eNewArch == KA_NEON )
+    {
+        eArch                = KA_NEON;
+        Int16.MonoToMono     = MonoToMonoNeon;
+        Int16.StereoToMono   = StereoToMonoNeon;
+        Int16.MonoToStereo   = MonoToStereoNeon;
+        Int16.StereoToStereo = StereoToStereoNeon;
+        Float.MonoToMono     = MonoToMonoFloatNeon;
+        Float.StereoToMono   = StereoToMonoFloatNeon;
+        Float.MonoToStereo   = MonoToStereoFloatNeon;
+        Float.StereoToStereo = StereoToStereoFloatNeon;
+        Saturate             = SaturateNeon;
+        Clip                 = ClipNeon;
+    }
+#else
+    static_cast<void> ( eNewArch );
+#endif
+}
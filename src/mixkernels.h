@@ -0,0 +1,185 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+/* Classes ********************************************************************/
+// Inner loops of the server mixer. The kernel set is chosen once at startup
+// depending on the instruction sets the CPU supports. All implementations
+// perform exactly the same float operations in the same order as the scalar
+// reference (no fused multiply-add, no reordering of the accumulation over the
+// sources) so that the mix result is bit-exact regardless of the selected set.
+// The accumulation kernels exist for int16 source frames and for the float
+// frames of the float pipeline.
+class CMixKernels
+{
+public:
+    enum EKernelArch
+    {
+        KA_SCALAR = 0, // portable C++ implementation
+        KA_SSE2   = 1, // x86/x86_64 SSE2
+        KA_AVX2   = 2, // x86/x86_64 AVX2
+        KA_NEON   = 3  // ARM NEON
+    };
+
+    // pfOut[i] += pIn[i] * fGain, iNumSamples mono samples
+    template<typename TSample>
+    using TAccumFct = void ( * ) ( float* pfOut, const TSample* pIn, const int iNumSamples, const float fGain );
+
+    // left/right gains applied to interleaved stereo output, iNumSamples is the
+    // number of stereo sample pairs
+    template<typename TSample>
+    using TAccumPanFct = void ( * ) ( float* pfOut, const TSample* pIn, const int iNumSamples, const float fGainL, const float fGainR );
+
+    // clipping float to short conversion (same semantic as Float2Short())
+    typedef void ( *TSaturateFct ) ( int16_t* psOut, const float* pfIn, const int iNumValues );
+
+    // clipping of float samples to the range [-1, 1]
+    typedef void ( *TClipFct ) ( float* pfOut, const float* pfIn, const int iNumValues );
+
+    // delay panned source into stereo target, see DelayPanToStereo()
+    template<typename TSample>
+    using TDelayPanFct = void ( * ) ( float*         pfOut,
+                                      const TSample* pIn,
+                                      const TSample* pInPrev,
+                                      const int      iNumSamples,
+                                      const int      iDelayL,
+                                      const int      iDelayR,
+                                      const float    fGainL,
+                                      const float    fGainR );
+
+    // set of accumulation kernels for one source sample type
+    template<typename TSample>
+    struct CAccumKernels
+    {
+        // mono source into mono target
+        TAccumFct<TSample> MonoToMono;
+
+        // stereo source into mono target with stereo-to-mono attenuation
+        TAccumFct<TSample> StereoToMono;
+
+        // mono source into stereo target
+        TAccumPanFct<TSample> MonoToStereo;
+
+        // stereo source into stereo target
+        TAccumPanFct<TSample> StereoToStereo;
+    };
+
+    CMixKernels() { SetArch ( DetectArch() ); }
+
+    static EKernelArch DetectArch();
+    static const char* GetArchName ( const EKernelArch eArch );
+
+    void        SetArch ( const EKernelArch eNewArch );
+    EKernelArch GetArch() const { return eArch; }
+
+    // accumulation kernels for the given source sample type
+    template<typename TSample>
+    const CAccumKernels<TSample>& Accum() const;
+
+    // int16 source frames
+    CAccumKernels<int16_t> Int16;
+
+    // float source frames
+    CAccumKernels<float> Float;
+
+    // convert the float mix to short with clipping
+    TSaturateFct Saturate;
+
+    // clip the float mix for the float encoder
+    TClipFct Clip;
+
+    // Stereo target with delay panning: the left/right output is delayed by
+    // iDelayL/iDelayR samples, the delayed samples are taken from the previous
+    // frame pInPrev. The function is specialised at compile time for the
+    // number of source channels and unity gain so that the per-sample loops
+    // do not contain any branches.
+    template<typename TSample, int iNumSrcChannels, bool bUnityGain>
+    static void DelayPanToStereo ( float*         pfOut,
+                                   const TSample* pIn,
+                                   const TSample* pInPrev,
+                                   const int      iNumSamples,
+                                   const int      iDelayL,
+                                   const int      iDelayR,
+                                   const float    fGainL,
+                                   const float    fGainR );
+
+protected:
+    EKernelArch eArch;
+};
+
+/* Implementation *************************************************************/
+template<>
+inline const CMixKernels::CAccumKernels<int16_t>& CMixKernels::Accum<int16_t>() const
+{
+    return Int16;
+}
+
+template<>
+inline const CMixKernels::CAccumKernels<float>& CMixKernels::Accum<float>() const
+{
+    return Float;
+}
+
+template<typename TSample, int iNumSrcChannels, bool bUnityGain>
+void CMixKernels::DelayPanToStereo ( float*         pfOut,
+                                     const TSample* pIn,
+                                     const TSample* pInPrev,
+                                     const int      iNumSamples,
+                                     const int      iDelayL,
+                                     const int      iDelayR,
+                                     const float    fGainL,
+                                     const float    fGainR )
+{
+    static_assert ( ( iNumSrcChannels == 1 ) || ( iNumSrcChannels == 2 ), "only mono and stereo sources are supported" );
+
+    for ( int iOutCh = 0; iOutCh < 2; iOutCh++ )
+    {
+        // a mono source feeds both output channels, a stereo source feeds the
+        // same output channel
+        const int   iSrcCh = ( iNumSrcChannels == 2 ) ? iOutCh : 0;
+        const float fGain  = ( iOutCh == 0 ) ? fGainL : fGainR;
+        const int   iDelay = std::min ( ( iOutCh == 0 ) ? iDelayL : iDelayR, iNumSamples );
+        float*      pfO    = pfOut + iOutCh;
+
+        // the first iDelay output samples come from the end of the previous frame
+        const TSample* pP = pInPrev + ( iNumSamples - iDelay ) * iNumSrcChannels + iSrcCh;
+
+        for ( int i = 0; i < iDelay; i++ )
+        {
+            pfO[2 * i] += bUnityGain ? pP[i * iNumSrcChannels] : pP[i * iNumSrcChannels] * fGain;
+        }
+
+        // the remaining output samples come from the start of the current frame
+        const TSample* pC = pIn + iSrcCh;
+
+        for ( int i = 0; i < iNumSamples - iDelay; i++ )
+        {
+            pfO[2 * ( i + iDelay )] += bUnityGain ? pC[i * iNumSrcChannels] : pC[i * iNumSrcChannels] * fGain;
+        }
+    }
+}
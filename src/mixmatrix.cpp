@@ -0,0 +1,168 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include "mixmatrix.h"
+
+/* Definitions ****************************************************************/
+// flag in the middle buffer index which signals a not yet consumed snapshot
+#define MIX_MATRIX_NEW_SNAPSHOT_FLAG 4
+
+/* Implementation *************************************************************/
+CMixMatrix::CMixMatrix() :
+    vecvecfGains ( MAX_NUM_CHANNELS ),
+    vecvecfPans ( MAX_NUM_CHANNELS ),
+    vecbIsActive ( MAX_NUM_CHANNELS, false ),
+    iBackIdx ( 0 ),
+    iFrontIdx ( 1 ),
+    iMiddleIdxAndFlag ( 2 )
+{
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        vecvecfGains[i].Init ( MAX_NUM_CHANNELS, MIX_MATRIX_DEFAULT_GAIN );
+        vecvecfPans[i].Init ( MAX_NUM_CHANNELS, MIX_MATRIX_DEFAULT_PAN );
+    }
+
+    // reserve the worst case size so that the snapshots are not reallocated
+    for ( int i = 0; i < 3; i++ )
+    {
+        Snapshots[i].vecfGains.reserve ( MAX_NUM_CHANNELS * MAX_NUM_CHANNELS );
+        Snapshots[i].vecfPans.reserve ( MAX_NUM_CHANNELS * MAX_NUM_CHANNELS );
+    }
+}
+
+void CMixMatrix::SetGain ( const int iTargetChanID, const int iSourceChanID, const float fNewGain )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // set value (make sure channel IDs are in range)
+    if ( ( iTargetChanID >= 0 ) && ( iTargetChanID < MAX_NUM_CHANNELS ) && ( iSourceChanID >= 0 ) && ( iSourceChanID < MAX_NUM_CHANNELS ) &&
+         ( vecvecfGains[iTargetChanID][iSourceChanID] != fNewGain ) )
+    {
+        vecvecfGains[iTargetChanID][iSourceChanID] = fNewGain;
+        Publish();
+    }
+}
+
+void CMixMatrix::SetPan ( const int iTargetChanID, const int iSourceChanID, const float fNewPan )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // set value (make sure channel IDs are in range)
+    if ( ( iTargetChanID >= 0 ) && ( iTargetChanID < MAX_NUM_CHANNELS ) && ( iSourceChanID >= 0 ) && ( iSourceChanID < MAX_NUM_CHANNELS ) &&
+         ( vecvecfPans[iTargetChanID][iSourceChanID] != fNewPan ) )
+    {
+        vecvecfPans[iTargetChanID][iSourceChanID] = fNewPan;
+        Publish();
+    }
+}
+
+void CMixMatrix::ResetChannel ( const int iChanID )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // reset the gains/pans of the channel, at the same time reset gains/pans
+    // of this channel ID for all other channels
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        vecvecfGains[iChanID][i] = MIX_MATRIX_DEFAULT_GAIN;
+        vecvecfPans[iChanID][i]  = MIX_MATRIX_DEFAULT_PAN;
+        vecvecfGains[i][iChanID] = MIX_MATRIX_DEFAULT_GAIN;
+        vecvecfPans[i][iChanID]  = MIX_MATRIX_DEFAULT_PAN;
+    }
+
+    vecbIsActive[iChanID] = true;
+    Publish();
+}
+
+void CMixMatrix::RemoveChannel ( const int iChanID )
+{
+    QMutexLocker locker ( &Mutex );
+
+    if ( vecbIsActive[iChanID] )
+    {
+        vecbIsActive[iChanID] = false;
+        Publish();
+    }
+}
+
+void CMixMatrix::Publish()
+{
+    // note that the writer mutex must be locked when calling this function
+    CSnapshot& Snapshot = Snapshots[iBackIdx];
+
+    // assign the dense indexes to the active channels
+    Snapshot.iNumChannels = 0;
+
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        if ( vecbIsActive[i] )
+        {
+            Snapshot.vecIdxOfChanID[i] = Snapshot.iNumChannels++;
+        }
+        else
+        {
+            Snapshot.vecIdxOfChanID[i] = INVALID_INDEX;
+        }
+    }
+
+    // copy the values of the active channels in the dense matrix
+    const int iNumChannels = Snapshot.iNumChannels;
+
+    Snapshot.vecfGains.resize ( iNumChannels * iNumChannels );
+    Snapshot.vecfPans.resize ( iNumChannels * iNumChannels );
+
+    for ( int iTarget = 0; iTarget < MAX_NUM_CHANNELS; iTarget++ )
+    {
+        const int iTargetIdx = Snapshot.vecIdxOfChanID[iTarget];
+
+        if ( iTargetIdx != INVALID_INDEX )
+        {
+            for ( int iSource = 0; iSource < MAX_NUM_CHANNELS; iSource++ )
+            {
+                const int iSourceIdx = Snapshot.vecIdxOfChanID[iSource];
+
+                if ( iSourceIdx != INVALID_INDEX )
+                {
+                    Snapshot.vecfGains[iTargetIdx * iNumChannels + iSourceIdx] = vecvecfGains[iTarget][iSource];
+                    Snapshot.vecfPans[iTargetIdx * iNumChannels + iSourceIdx]  = vecvecfPans[iTarget][iSource];
+                }
+            }
+        }
+    }
+
+    // hand over the new snapshot to the reader, the previous middle buffer
+    // becomes our new back buffer
+    iBackIdx = iMiddleIdxAndFlag.exchange ( iBackIdx | MIX_MATRIX_NEW_SNAPSHOT_FLAG, std::memory_order_acq_rel ) & ~MIX_MATRIX_NEW_SNAPSHOT_FLAG;
+}
+
+const CMixMatrix::CSnapshot& CMixMatrix::GetSnapshot()
+{
+    // take over the newest snapshot if the writer has published one
+    if ( iMiddleIdxAndFlag.load ( std::memory_order_relaxed ) & MIX_MATRIX_NEW_SNAPSHOT_FLAG )
+    {
+        iFrontIdx = iMiddleIdxAndFlag.exchange ( iFrontIdx, std::memory_order_acq_rel ) & ~MIX_MATRIX_NEW_SNAPSHOT_FLAG;
+    }
+
+    return Snapshots[iFrontIdx];
+}
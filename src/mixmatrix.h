@@ -0,0 +1,111 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <QMutex>
+#include <atomic>
+#include "global.h"
+#include "util.h"
+
+/* Definitions ****************************************************************/
+// values of a freshly connected channel
+#define MIX_MATRIX_DEFAULT_GAIN 1.0f
+#define MIX_MATRIX_DEFAULT_PAN  0.5f
+
+/* Classes ********************************************************************/
+// Gains and pans of all (target, source) channel pairs for the server mixer.
+// The values are written by the protocol handlers and published as a dense
+// snapshot which only contains the active channels. The mixer thread reads the
+// snapshot without any lock: three snapshot buffers are used so that the writer
+// never has to wait for the reader and the reader never sees a snapshot which
+// is still being written.
+class CMixMatrix
+{
+public:
+    class CSnapshot
+    {
+    public:
+        CSnapshot() : iNumChannels ( 0 ), vecIdxOfChanID ( MAX_NUM_CHANNELS, INVALID_INDEX ) {}
+
+        // index of the channel in the dense matrix, INVALID_INDEX if not included
+        int GetIndex ( const int iChanID ) const { return vecIdxOfChanID[iChanID]; }
+
+        float GetGain ( const int iTargetIdx, const int iSourceIdx ) const
+        {
+            if ( ( iTargetIdx == INVALID_INDEX ) || ( iSourceIdx == INVALID_INDEX ) )
+            {
+                return MIX_MATRIX_DEFAULT_GAIN;
+            }
+
+            return vecfGains[iTargetIdx * iNumChannels + iSourceIdx];
+        }
+
+        float GetPan ( const int iTargetIdx, const int iSourceIdx ) const
+        {
+            if ( ( iTargetIdx == INVALID_INDEX ) || ( iSourceIdx == INVALID_INDEX ) )
+            {
+                return MIX_MATRIX_DEFAULT_PAN;
+            }
+
+            return vecfPans[iTargetIdx * iNumChannels + iSourceIdx];
+        }
+
+    protected:
+        friend class CMixMatrix;
+
+        int            iNumChannels;
+        CVector<int>   vecIdxOfChanID;
+        CVector<float> vecfGains; // row: target, column: source
+        CVector<float> vecfPans;
+    };
+
+    CMixMatrix();
+
+    // writer side, may be called from any thread
+    void SetGain ( const int iTargetChanID, const int iSourceChanID, const float fNewGain );
+    void SetPan ( const int iTargetChanID, const int iSourceChanID, const float fNewPan );
+    void ResetChannel ( const int iChanID );
+    void RemoveChannel ( const int iChanID );
+
+    // reader side, must always be called from the same thread, the returned
+    // snapshot stays valid until the next call
+    const CSnapshot& GetSnapshot();
+
+protected:
+    void Publish();
+
+    // master copy indexed by the channel IDs (only accessed by the writer)
+    CVector<CVector<float>> vecvecfGains;
+    CVector<CVector<float>> vecvecfPans;
+    CVector<bool>           vecbIsActive;
+    QMutex                  Mutex;
+
+    // triple buffer: the writer owns the back buffer, the reader owns the front
+    // buffer and the third one is exchanged atomically between them
+    CSnapshot        Snapshots[3];
+    int              iBackIdx;
+    int              iFrontIdx;
+    std::atomic<int> iMiddleIdxAndFlag;
+};
@@ -0,0 +1,377 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include "global.h"
+#include "util.h"
+
+/* Definitions ****************************************************************/
+// minimum number of frames between two compressions (limits the tempo change
+// to a few percent)
+#define PLAYOUT_OP_INTERVAL_FRAMES 8
+
+// number of frames over which the minimum jitter buffer margin is observed
+#define PLAYOUT_WINDOW_FRAMES 256
+
+// the time-scale operation is skipped if the best matching segments are less
+// similar than this (normalized cross-correlation)
+#define PLAYOUT_MIN_CORRELATION 0.5f
+
+/* Classes ********************************************************************/
+// Adaptive playout: the decoded blocks of the jitter buffer are collected in a
+// small sample buffer from which the frames are taken. If the jitter buffer
+// kept at least one block more than needed over the whole observation window,
+// one block is taken in advance and the frame is compressed (WSOLA: a segment
+// is removed at the position where the signal is most similar to itself and
+// the gap is cross-faded). The samples left over in the sample buffer are only
+// additional delay, therefore the following frames are compressed until the
+// sample buffer is (almost) empty again, i.e. the delay is reduced by one block
+// in a few small steps. If a block is missing, the buffered samples are
+// stretched the same way instead of concealing the block, if possible. The
+// segment lengths are a fraction of the frame size, i.e. the operation is tuned
+// for the short 64/128 samples frames.
+//
+// Usage per frame: PrepareFrame() returns the number of blocks to decode, each
+// block is decoded to GetBlockWritePtr() followed by BlockWritten(), finally
+// GetFrame() writes the frame.
+template<typename TSample>
+class CAdaptivePlayout
+{
+public:
+    enum EOperation
+    {
+        PO_NONE,
+        PO_COMPRESS,
+        PO_STRETCH
+    };
+
+    CAdaptivePlayout() : iNumChannels ( 0 ), iFrameSize ( 0 ), iBlockSize ( 0 ), iNumCompressed ( 0 ), iNumStretched ( 0 ) {}
+
+    // allocates the worst case memory (the format may change without allocation afterwards)
+    void Init ( const int iMaxNumChannels, const int iMaxFrameSize );
+
+    // the frame and block sizes are in samples per audio channel, the buffer
+    // is reset if the format changes
+    void SetFormat ( const int iNewNumChannels, const int iNewFrameSize, const int iNewBlockSize );
+    void Reset();
+
+    // the fill level is the number of blocks up to the newest block in the
+    // jitter buffer (see CNetBuf::GetFillLevel())
+    int PrepareFrame ( const int iFillLevel );
+
+    TSample* GetBlockWritePtr() { return &vecBuffer[0] + iBufLen * iNumChannels; }
+    void     BlockWritten() { iBufLen += iBlockSize; }
+
+    // returns the time-scale operation which was applied for the frame
+    EOperation GetFrame ( TSample* pOutData );
+
+    // number of samples (per audio channel) which are buffered in addition to the jitter buffer
+    int GetBufferedSamples() const { return iBufLen; }
+
+    int64_t GetNumCompressed() const { return iNumCompressed; }
+    int64_t GetNumStretched() const { return iNumStretched; }
+
+protected:
+    int  GetNumBlocksNeeded() const { return std::max ( 0, ( iFrameSize - iBufLen + iBlockSize - 1 ) / iBlockSize ); }
+    int  FindBestLag ( const int iMinLag, const int iMaxLag ) const;
+    void Compress ( const int iLag );
+    void Stretch ( const int iLag );
+
+    CVector<TSample> vecBuffer; // interleaved samples
+    CVector<TSample> vecScratch;
+    int              iBufLen; // in samples per audio channel
+    int              iNumChannels;
+    int              iFrameSize;
+    int              iBlockSize;
+    int              iOverlap;
+    int              iMinLag;
+    int              iMaxLag;
+
+    EOperation eOperation;
+    int        iFramesSinceOp;
+    int        iWindowCnt;
+    int        iWinMinMargin;
+    int64_t    iNumCompressed;
+    int64_t    iNumStretched;
+};
+
+/* Implementation *************************************************************/
+template<typename TSample>
+void CAdaptivePlayout<TSample>::Init ( const int iMaxNumChannels, const int iMaxFrameSize )
+{
+    // worst case: one frame plus the maximum lag plus one block (at most one
+    // frame) before a frame is taken, plus the maximum lag of a stretch
+    vecBuffer.Init ( 3 * iMaxNumChannels * iMaxFrameSize );
+    vecScratch.Init ( iMaxNumChannels * iMaxFrameSize / 2 );
+
+    iNumChannels = 0;
+    iFrameSize   = 0;
+    iBlockSize   = 0;
+    Reset();
+}
+
+template<typename TSample>
+void CAdaptivePlayout<TSample>::SetFormat ( const int iNewNumChannels, const int iNewFrameSize, const int iNewBlockSize )
+{
+    if ( ( iNewNumChannels == iNumChannels ) && ( iNewFrameSize == iFrameSize ) && ( iNewBlockSize == iBlockSize ) )
+    {
+        return;
+    }
+
+    // only allocate if the format exceeds the size given in Init()
+    if ( 3 * iNewNumChannels * iNewFrameSize > vecBuffer.Size() )
+    {
+        Init ( iNewNumChannels, iNewFrameSize );
+    }
+
+    iNumChannels = iNewNumChannels;
+    iFrameSize   = iNewFrameSize;
+    iBlockSize   = iNewBlockSize;
+
+    // the overlap is half a frame, the removed/inserted segment is between an
+    // eighth and half a frame (0.17 to 0.67 ms for 64 samples frames)
+    iOverlap = iFrameSize / 2;
+    iMinLag  = std::max ( 1, iFrameSize / 8 );
+    iMaxLag  = iFrameSize / 2;
+
+    Reset();
+}
+
+template<typename TSample>
+void CAdaptivePlayout<TSample>::Reset()
+{
+    iBufLen        = 0;
+    eOperation     = PO_NONE;
+    iFramesSinceOp = 0;
+    iWindowCnt     = 0;
+    iWinMinMargin  = INT_MAX;
+}
+
+template<typename TSample>
+int CAdaptivePlayout<TSample>::PrepareFrame ( const int iFillLevel )
+{
+    int iNumBlocks = GetNumBlocksNeeded();
+
+    eOperation = PO_NONE;
+    iFramesSinceOp++;
+
+    // a missing block would be concealed, stretch the buffered samples instead
+    // if there are enough of them
+    if ( iFillLevel < iNumBlocks )
+    {
+        const int iLag = FindBestLag ( iMinLag, std::min ( iMaxLag, iBufLen - iOverlap ) );
+
+        if ( iLag > 0 )
+        {
+            Stretch ( iLag );
+            eOperation = PO_STRETCH;
+            iNumBlocks = GetNumBlocksNeeded();
+        }
+    }
+
+    // observe the minimum margin over the window (the window is restarted
+    // after each block taken in advance)
+    iWinMinMargin = std::min ( iWinMinMargin, iFillLevel - iNumBlocks );
+
+    const bool bWindowComplete = ( ++iWindowCnt >= PLAYOUT_WINDOW_FRAMES );
+
+    if ( ( eOperation != PO_NONE ) || ( iFramesSinceOp < PLAYOUT_OP_INTERVAL_FRAMES ) )
+    {
+        return iNumBlocks;
+    }
+
+    if ( iBufLen >= iMinLag )
+    {
+        // remove the left over samples without taking an additional block
+        eOperation = PO_COMPRESS;
+    }
+    else if ( bWindowComplete )
+    {
+        if ( ( iWinMinMargin > 0 ) && ( iFillLevel > iNumBlocks ) )
+        {
+            // the jitter buffer always had a spare block, take it in advance
+            eOperation = PO_COMPRESS;
+            iNumBlocks++;
+        }
+
+        iWindowCnt    = 0;
+        iWinMinMargin = INT_MAX;
+    }
+
+    return iNumBlocks;
+}
+
+template<typename TSample>
+typename CAdaptivePlayout<TSample>::EOperation CAdaptivePlayout<TSample>::GetFrame ( TSample* pOutData )
+{
+    if ( eOperation == PO_COMPRESS )
+    {
+        const int iLag = FindBestLag ( iMinLag, std::min ( iMaxLag, iBufLen - iFrameSize ) );
+
+        if ( iLag > 0 )
+        {
+            Compress ( iLag );
+        }
+        else
+        {
+            eOperation = PO_NONE;
+        }
+    }
+
+    const int iFrameValues = iFrameSize * iNumChannels;
+
+    if ( iBufLen >= iFrameSize )
+    {
+        TSample* pBuffer = &vecBuffer[0];
+
+        std::copy ( pBuffer, pBuffer + iFrameValues, pOutData );
+
+        // keep the remaining samples for the next frame
+        std::copy ( pBuffer + iFrameValues, pBuffer + iBufLen * iNumChannels, pBuffer );
+        iBufLen -= iFrameSize;
+    }
+    else
+    {
+        // not enough blocks were written (should not happen)
+        std::fill_n ( pOutData, iFrameValues, static_cast<TSample> ( 0 ) );
+    }
+
+    return eOperation;
+}
+
+template<typename TSample>
+int CAdaptivePlayout<TSample>::FindBestLag ( const int iMinLagIn, const int iMaxLagIn ) const
+{
+    // The lag is chosen such that the overlap segment at the beginning and the
+    // one shifted by the lag are most similar (normalized cross-correlation),
+    // all audio channels are considered together. Returns 0 if no lag fits.
+    const int iOverlapValues = iOverlap * iNumChannels;
+    float     fRefEnergy     = 0;
+
+    if ( ( iMaxLagIn < iMinLagIn ) || ( ( iMaxLagIn + iOverlap ) > iBufLen ) )
+    {
+        return 0;
+    }
+
+    for ( int k = 0; k < iOverlapValues; k++ )
+    {
+        fRefEnergy += static_cast<float> ( vecBuffer[k] ) * vecBuffer[k];
+    }
+
+    // silence can be cut anywhere, the longest segment is used
+    if ( fRefEnergy == 0 )
+    {
+        return iMaxLagIn;
+    }
+
+    int   iBestLag  = 0;
+    float fBestCorr = PLAYOUT_MIN_CORRELATION;
+
+    for ( int iLag = iMinLagIn; iLag <= iMaxLagIn; iLag++ )
+    {
+        const TSample* pShifted = &vecBuffer[iLag * iNumChannels];
+        float          fCross   = 0;
+        float          fEnergy  = 0;
+
+        for ( int k = 0; k < iOverlapValues; k++ )
+        {
+            fCross += static_cast<float> ( vecBuffer[k] ) * pShifted[k];
+            fEnergy += static_cast<float> ( pShifted[k] ) * pShifted[k];
+        }
+
+        if ( fEnergy > 0 )
+        {
+            const float fCorr = fCross / std::sqrt ( fRefEnergy * fEnergy );
+
+            // prefer the longer segment on equal similarity
+            if ( fCorr >= fBestCorr )
+            {
+                fBestCorr = fCorr;
+                iBestLag  = iLag;
+            }
+        }
+    }
+
+    return iBestLag;
+}
+
+template<typename TSample>
+void CAdaptivePlayout<TSample>::Compress ( const int iLag )
+{
+    // y[k] = x[k] faded out against x[k + lag] during the overlap, then x[k + lag]
+    const int iLagValues = iLag * iNumChannels;
+
+    for ( int i = 0; i < iOverlap; i++ )
+    {
+        const float fWeight = ( i + 0.5f ) / iOverlap;
+
+        for ( int c = 0; c < iNumChannels; c++ )
+        {
+            const int k = i * iNumChannels + c;
+
+            vecBuffer[k] = static_cast<TSample> ( ( 1.0f - fWeight ) * vecBuffer[k] + fWeight * vecBuffer[k + iLagValues] );
+        }
+    }
+
+    TSample* pBuffer = &vecBuffer[0];
+
+    std::copy ( pBuffer + ( iOverlap + iLag ) * iNumChannels, pBuffer + iBufLen * iNumChannels, pBuffer + iOverlap * iNumChannels );
+
+    iBufLen -= iLag;
+    iNumCompressed++;
+    iFramesSinceOp = 0;
+}
+
+template<typename TSample>
+void CAdaptivePlayout<TSample>::Stretch ( const int iLag )
+{
+    // y[k] = x[k] up to the lag, then x[k] faded out against x[k - lag] during
+    // the overlap, then x[k - lag] (note that the lag is at most the overlap)
+    const int iLagValues = iLag * iNumChannels;
+
+    for ( int i = 0; i < iOverlap; i++ )
+    {
+        const float fWeight = ( i + 0.5f ) / iOverlap;
+
+        for ( int c = 0; c < iNumChannels; c++ )
+        {
+            const int k = ( iLag + i ) * iNumChannels + c;
+
+            vecScratch[i * iNumChannels + c] = static_cast<TSample> ( ( 1.0f - fWeight ) * vecBuffer[k] + fWeight * vecBuffer[k - iLagValues] );
+        }
+    }
+
+    TSample* pBuffer = &vecBuffer[0];
+
+    std::copy_backward ( pBuffer + iOverlap * iNumChannels, pBuffer + iBufLen * iNumChannels, pBuffer + ( iBufLen + iLag ) * iNumChannels );
+    std::copy ( &vecScratch[0], &vecScratch[0] + iOverlap * iNumChannels, pBuffer + iLagValues );
+
+    iBufLen += iLag;
+    iNumStretched++;
+    iFramesSinceOp = 0;
+}
@@ -1750,7 +1750,7 @@ void CProtocol::CreateCLRegisterServerMes ( const CHostAddress& InetAddr, const
     int iPos = 0; // init position pointer
 
     // convert server info strings to utf-8
-    const QByteArray strUTF8LInetAddr = LInetAddr.InetAddr.toString().toUtf8();
+    const QByteArray strUTF8LInetAddr = LInetAddr.GetInetAddr().toString().toUtf8();
     const QByteArray strUTF8Name      = ServerInfo.strName.toUtf8();
     const QByteArray strUTF8City      = ServerInfo.strCity.toUtf8();
 
@@ -1767,7 +1767,7 @@ void CProtocol::CreateCLRegisterServerMes ( const CHostAddress& InetAddr, const
     CVector<uint8_t> vecData ( iEntrLen );
 
     // port number (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( LInetAddr.iPort ), 2 );
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( LInetAddr.GetPort() ), 2 );
 
     // country (2 bytes)
     PutCountryOnStream ( vecData, iPos, ServerInfo.eCountry );
@@ -1805,7 +1805,7 @@ bool CProtocol::EvaluateCLRegisterServerMes ( const CHostAddress& InetAddr, cons
     }
 
     // port number (2 bytes)
-    LInetAddr.iPort = static_cast<quint16> ( GetValFromStream ( vecData, iPos, 2 ) );
+    LInetAddr.SetPort ( static_cast<quint16> ( GetValFromStream ( vecData, iPos, 2 ) ) );
 
     // country (2 bytes)
     RecServerInfo.eCountry = GetCountryFromStream ( vecData, iPos );
@@ -1828,16 +1828,20 @@ bool CProtocol::EvaluateCLRegisterServerMes ( const CHostAddress& InetAddr, cons
         return true; // return error code
     }
 
+    QHostAddress LocHostAddr;
+
     if ( sLocHost.isEmpty() )
     {
         // old server, empty "topic", register as local host
-        LInetAddr.InetAddr.setAddress ( QHostAddress::LocalHost );
+        LocHostAddr.setAddress ( QHostAddress::LocalHost );
     }
-    else if ( !LInetAddr.InetAddr.setAddress ( sLocHost ) )
+    else if ( !LocHostAddr.setAddress ( sLocHost ) )
     {
         return true; // return error code
     }
 
+    LInetAddr.SetInetAddr ( LocHostAddr );
+
     // server city
     if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_CITY, RecServerInfo.strCity ) )
     {
@@ -1861,7 +1865,7 @@ void CProtocol::CreateCLRegisterServerExMes ( const CHostAddress& InetAddr, cons
     int iPos = 0; // init position pointer
 
     // convert server info strings to utf-8
-    const QByteArray strUTF8LInetAddr = LInetAddr.InetAddr.toString().toUtf8();
+    const QByteArray strUTF8LInetAddr = LInetAddr.GetInetAddr().toString().toUtf8();
     const QByteArray strUTF8Name      = ServerInfo.strName.toUtf8();
     const QByteArray strUTF8City      = ServerInfo.strCity.toUtf8();
     const QByteArray strUTF8Version   = QString ( VERSION ).toUtf8();
@@ -1881,7 +1885,7 @@ void CProtocol::CreateCLRegisterServerExMes ( const CHostAddress& InetAddr, cons
     CVector<uint8_t> vecData ( iEntrLen );
 
     // port number (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( LInetAddr.iPort ), 2 );
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( LInetAddr.GetPort() ), 2 );
 
     // country (2 bytes)
     PutCountryOnStream ( vecData, iPos, ServerInfo.eCountry );
@@ -1925,7 +1929,7 @@ bool CProtocol::EvaluateCLRegisterServerExMes ( const CHostAddress& InetAddr, co
     }
 
     // port number (2 bytes)
-    LInetAddr.iPort = static_cast<quint16> ( GetValFromStream ( vecData, iPos, 2 ) );
+    LInetAddr.SetPort ( static_cast<quint16> ( GetValFromStream ( vecData, iPos, 2 ) ) );
 
     // country (2 bytes)
     RecServerInfo.eCountry = GetCountryFromStream ( vecData, iPos );
@@ -1948,16 +1952,20 @@ bool CProtocol::EvaluateCLRegisterServerExMes ( const CHostAddress& InetAddr, co
         return true; // return error code
     }
 
+    QHostAddress LocHostAddr;
+
     if ( sLocHost.isEmpty() )
     {
         // old server, empty "topic", register as local host
-        LInetAddr.InetAddr.setAddress ( QHostAddress::LocalHost );
+        LocHostAddr.setAddress ( QHostAddress::LocalHost );
     }
-    else if ( !LInetAddr.InetAddr.setAddress ( sLocHost ) )
+    else if ( !LocHostAddr.setAddress ( sLocHost ) )
     {
         return true; // return error code
     }
 
+    LInetAddr.SetInetAddr ( LocHostAddr );
+
     // server city
     if ( GetStringFromStream ( vecData, iPos, MAX_LEN_SERVER_CITY, RecServerInfo.strCity ) )
     {
@@ -2035,11 +2043,11 @@ void CProtocol::CreateCLServerListMes ( const CHostAddress& InetAddr, const CVec
 
         // IP address (4 bytes)
         // note the Server List manager has put the internal details in HostAddr where required
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.InetAddr.toIPv4Address() ), 4 );
+        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.GetInetAddr().toIPv4Address() ), 4 );
 
         // port number (2 bytes)
         // note the Server List manager has put the internal details in HostAddr where required
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.iPort ), 2 );
+        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.GetPort() ), 2 );
 
         // country (2 bytes)
         PutCountryOnStream ( vecData, iPos, vecServerInfo[i].eCountry );
@@ -2158,11 +2166,11 @@ void CProtocol::CreateCLRedServerListMes ( const CHostAddress& InetAddr, const C
 
         // IP address (4 bytes)
         // note the Server List manager has put the internal details in HostAddr where required
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.InetAddr.toIPv4Address() ), 4 );
+        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.GetInetAddr().toIPv4Address() ), 4 );
 
         // port number (2 bytes)
         // note the Server List manager has put the internal details in HostAddr where required
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.iPort ), 2 );
+        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecServerInfo[i].HostAddr.GetPort() ), 2 );
 
         // name (note that the string length indicator is 1 in this special case)
         PutStringUTF8OnStream ( vecData, iPos, strUTF8Name, 1 );
@@ -2241,10 +2249,10 @@ void CProtocol::CreateCLSendEmptyMesMes ( const CHostAddress& InetAddr, const CH
     CVector<uint8_t> vecData ( 6 );
 
     // IP address (4 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( TargetInetAddr.InetAddr.toIPv4Address() ), 4 );
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( TargetInetAddr.GetInetAddr().toIPv4Address() ), 4 );
 
     // port number (2 bytes)
-    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( TargetInetAddr.iPort ), 2 );
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( TargetInetAddr.GetPort() ), 2 );
 
     CreateAndImmSendConLessMessage ( PROTMESSID_CLM_SEND_EMPTY_MESSAGE, vecData, InetAddr );
 }
@@ -154,6 +154,15 @@ public:
     void CreateCLChannelLevelListMes ( const CHostAddress& InetAddr, const CVector<uint16_t>& vecLevelList, const int iNumClients );
     void CreateCLRegisterServerResp ( const CHostAddress& InetAddr, const ESvrRegResult eResult );
 
+    // quick check of the frame header (without the CRC) to find out if a
+    // received packet may be a protocol message, ParseMessageFrame() fails
+    // for all other packets
+    static bool IsMessageFrameCandidate ( const uint8_t* pbyData, const int iNumBytesIn )
+    {
+        return ( iNumBytesIn >= MESS_LEN_WITHOUT_DATA_BYTE ) && ( pbyData[0] == 0 ) && ( pbyData[1] == 0 ) &&
+               ( ( pbyData[5] | ( pbyData[6] << 8 ) ) == iNumBytesIn - MESS_LEN_WITHOUT_DATA_BYTE );
+    }
+
     static bool ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
                                     const int               iNumBytesIn,
                                     CVector<uint8_t>&       vecbyMesBodyData,
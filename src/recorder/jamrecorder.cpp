@@ -245,8 +245,8 @@ void CJamSession::Frame ( const int              iChID,
         vecptrJamClients[iChID] = new CJamClient ( currentFrame, numAudioChannels, name, address, sessionDir );
     }
     else if ( numAudioChannels != vecptrJamClients[iChID]->NumAudioChannels() ||
-              address.InetAddr != vecptrJamClients[iChID]->ClientAddress().InetAddr ||
-              address.iPort != vecptrJamClients[iChID]->ClientAddress().iPort )
+              address.GetInetAddr() != vecptrJamClients[iChID]->ClientAddress().GetInetAddr() ||
+              address.GetPort() != vecptrJamClients[iChID]->ClientAddress().GetPort() )
     {
         DisconnectClient ( iChID );
         if ( numAudioChannels == 0 )
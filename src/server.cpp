@@ -24,32 +24,109 @@
 
 #include "server.h"
 
+/* Implementation *************************************************************/
+// The OPUS library is built with float internals, the int16 API converts the
+// samples on each call. The following overloads select the OPUS API matching
+// the sample type of the server frames.
+static inline int OpusCustomDecode ( OpusCustomDecoder* pDecoder, const unsigned char* pData, const int iLen, int16_t* psPcm, const int iFrameSize )
+{
+    return opus_custom_decode ( pDecoder, pData, iLen, psPcm, iFrameSize );
+}
+
+static inline int OpusCustomDecode ( OpusCustomDecoder* pDecoder, const unsigned char* pData, const int iLen, float* pfPcm, const int iFrameSize )
+{
+    return opus_custom_decode_float ( pDecoder, pData, iLen, pfPcm, iFrameSize );
+}
+
+static inline int OpusCustomEncode ( OpusCustomEncoder* pEncoder,
+                                     const int16_t*     psPcm,
+                                     const int          iFrameSize,
+                                     unsigned char*     pData,
+                                     const int          iMaxLen )
+{
+    return opus_custom_encode ( pEncoder, psPcm, iFrameSize, pData, iMaxLen );
+}
+
+static inline int OpusCustomEncode ( OpusCustomEncoder* pEncoder, const float* pfPcm, const int iFrameSize, unsigned char* pData, const int iMaxLen )
+{
+    return opus_custom_encode_float ( pEncoder, pfPcm, iFrameSize, pData, iMaxLen );
+}
+
+// peak of a decoded frame in int16 units
+static inline int GetFramePeak ( const int16_t* psData, const int iNumValues )
+{
+    int iPeak = 0;
+
+    for ( int i = 0; i < iNumValues; i++ )
+    {
+        iPeak = std::max ( iPeak, std::abs ( static_cast<int> ( psData[i] ) ) );
+    }
+
+    return iPeak;
+}
+
+static inline int GetFramePeak ( const float* pfData, const int iNumValues )
+{
+    float fPeak = 0;
+
+    for ( int i = 0; i < iNumValues; i++ )
+    {
+        fPeak = std::max ( fPeak, std::abs ( pfData[i] ) );
+    }
+
+    // round like the int16 decoder output so that residues below the int16
+    // resolution count as silence
+    return static_cast<int> ( fPeak * _MAXSHORT + 0.5f );
+}
+
 // CServer implementation ******************************************************
-CServer::CServer ( const int          iNewMaxNumChan,
-                   const QString&     strLoggingFileName,
-                   const QString&     strServerBindIP,
-                   const quint16      iPortNumber,
-                   const quint16      iQosNumber,
-                   const QString&     strHTMLStatusFileName,
-                   const QString&     strDirectoryAddress,
-                   const QString&     strServerListFileName,
-                   const QString&     strServerInfo,
-                   const QString&     strServerListFilter,
-                   const QString&     strServerPublicIP,
-                   const QString&     strNewWelcomeMessage,
-                   const QString&     strRecordingDirName,
-                   const bool         bNDisconnectAllClientsOnQuit,
-                   const bool         bNUseDoubleSystemFrameSize,
-                   const bool         bNUseMultithreading,
-                   const bool         bDisableRecording,
-                   const bool         bNDelayPan,
-                   const bool         bNEnableIPv6,
-                   const ELicenceType eNLicenceType ) :
+CServer::CServer ( const int                   iNewMaxNumChan,
+                   const QString&              strLoggingFileName,
+                   const QString&              strServerBindIP,
+                   const quint16               iPortNumber,
+                   const quint16               iQosNumber,
+                   const QString&              strHTMLStatusFileName,
+                   const QString&              strDirectoryAddress,
+                   const QString&              strServerListFileName,
+                   const QString&              strServerInfo,
+                   const QString&              strServerListFilter,
+                   const QString&              strServerPublicIP,
+                   const QString&              strNewWelcomeMessage,
+                   const QString&              strRecordingDirName,
+                   const bool                  bNDisconnectAllClientsOnQuit,
+                   const bool                  bNUseDoubleSystemFrameSize,
+                   const bool                  bNUseMultithreading,
+                   const SServerTuningOptions& Tuning,
+                   const bool                  bDisableRecording,
+                   const bool                  bNDelayPan,
+                   const bool                  bNEnableIPv6,
+                   const ELicenceType          eNLicenceType ) :
     bUseDoubleSystemFrameSize ( bNUseDoubleSystemFrameSize ),
     bUseMultithreading ( bNUseMultithreading ),
+    bUseRealTimeMixer ( Tuning.bUseRealTimeMixer ),
+    bNoClientEventPosted ( false ),
+    bUseSharedMixBus ( Tuning.bUseSharedMixBus ),
+    iMaxNumTopTalkers ( Tuning.iMaxNumTopTalkers ),
+    iNumTopTalkers ( 0 ),
+    iMixPairsLastTick ( 0 ),
+    iSkippedMixPairsLastTick ( 0 ),
+    iMixPairsTotal ( 0 ),
+    iSkippedMixPairsTotal ( 0 ),
+    bUseFloatPipeline ( Tuning.bUseFloatPipeline ),
+    bDecodeOnArrival ( Tuning.bDecodeOnArrival ),
+    iArrivalDecodedBlocksTotal ( 0 ),
+    iTickDecodedBlocksTotal ( 0 ),
+    iArrivalDecodeTimeNsTotal ( 0 ),
+    bUseInboundRing ( Tuning.bUseInboundRing ),
+    iInboundRingDropsTotal ( 0 ),
+    bUseAdaptivePlayout ( Tuning.bUseAdaptivePlayout && !Tuning.bDecodeOnArrival ),
+    iPlayoutCompressedTotal ( 0 ),
+    iPlayoutStretchedTotal ( 0 ),
     iMaxNumChannels ( iNewMaxNumChan ),
     iCurNumChannels ( 0 ),
-    Socket ( this, iPortNumber, iQosNumber, strServerBindIP, bNEnableIPv6 ),
+    iNumScratch ( 1 ),
+    iScratchBlockSize ( 1 ),
+    Socket ( this, iPortNumber, iQosNumber, strServerBindIP, bNEnableIPv6, Tuning.iNumRecvSockets > 1 ),
     Logging(),
     iFrameCount ( 0 ),
     bWriteStatusHTMLFile ( false ),
@@ -73,54 +150,38 @@ CServer::CServer ( const int          iNewMaxNumChan,
     bDisconnectAllClientsOnQuit ( bNDisconnectAllClientsOnQuit ),
     pSignalHandler ( CSignalHandler::getSingletonP() )
 {
-    int iOpusError;
     int i;
 
-    // create OPUS encoder/decoder for each channel (must be done before
-    // enabling the channels), create a mono and stereo encoder/decoder
-    // for each channel
+    // Note that the OPUS encoders/decoders are created by the codec pool when a
+    // channel negotiates its codec (see PrepareCodec()).
     for ( i = 0; i < iMaxNumChannels; i++ )
     {
-        // init OPUS -----------------------------------------------------------
-        OpusMode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
-
-        Opus64Mode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ, SYSTEM_FRAME_SIZE_SAMPLES, &iOpusError );
-
-        // init audio encoders and decoders
-        OpusEncoderMono[i]     = opus_custom_encoder_create ( OpusMode[i], 1, &iOpusError );   // mono encoder legacy
-        OpusDecoderMono[i]     = opus_custom_decoder_create ( OpusMode[i], 1, &iOpusError );   // mono decoder legacy
-        OpusEncoderStereo[i]   = opus_custom_encoder_create ( OpusMode[i], 2, &iOpusError );   // stereo encoder legacy
-        OpusDecoderStereo[i]   = opus_custom_decoder_create ( OpusMode[i], 2, &iOpusError );   // stereo decoder legacy
-        Opus64EncoderMono[i]   = opus_custom_encoder_create ( Opus64Mode[i], 1, &iOpusError ); // mono encoder OPUS64
-        Opus64DecoderMono[i]   = opus_custom_decoder_create ( Opus64Mode[i], 1, &iOpusError ); // mono decoder OPUS64
-        Opus64EncoderStereo[i] = opus_custom_encoder_create ( Opus64Mode[i], 2, &iOpusError ); // stereo encoder OPUS64
-        Opus64DecoderStereo[i] = opus_custom_decoder_create ( Opus64Mode[i], 2, &iOpusError ); // stereo decoder OPUS64
-
-        // we require a constant bit rate
-        opus_custom_encoder_ctl ( OpusEncoderMono[i], OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i], OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i], OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_VBR ( 0 ) );
-
-        // for 64 samples frame size we have to adjust the PLC behavior to avoid loud artifacts
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i], OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
-
-        // we want as low delay as possible
-        opus_custom_encoder_ctl ( OpusEncoderMono[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-
-        // set encoder low complexity for legacy 128 samples frame size
-        opus_custom_encoder_ctl ( OpusEncoderMono[i], OPUS_SET_COMPLEXITY ( 1 ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i], OPUS_SET_COMPLEXITY ( 1 ) );
-
         // init double-to-normal frame size conversion buffers -----------------
         // use worst case memory initialization to avoid allocating memory in
         // the time-critical thread
-        DoubleFrameSizeConvBufIn[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
-        DoubleFrameSizeConvBufOut[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        if ( bUseFloatPipeline )
+        {
+            DoubleFrameSizeConvBufInFloat[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+            DoubleFrameSizeConvBufOutFloat[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        }
+        else
+        {
+            DoubleFrameSizeConvBufIn[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+            DoubleFrameSizeConvBufOut[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        }
+
+        // the adaptive playout buffers are also allocated for the worst case
+        if ( bUseAdaptivePlayout )
+        {
+            if ( bUseFloatPipeline )
+            {
+                FloatPlayout[i].Init ( 2 /* stereo */, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES );
+            }
+            else
+            {
+                Int16Playout[i].Init ( 2 /* stereo */, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES );
+            }
+        }
     }
 
     // define colors for chat window identifiers
@@ -149,42 +210,38 @@ CServer::CServer ( const int          iNewMaxNumChan,
 
     // allocate worst case memory for the temporary vectors
     vecChanIDsCurConChan.Init ( iMaxNumChannels );
-    vecvecfGains.Init ( iMaxNumChannels );
-    vecvecfPannings.Init ( iMaxNumChannels );
-    vecvecsData.Init ( iMaxNumChannels );
-    vecvecsData2.Init ( iMaxNumChannels );
-    vecvecsSendData.Init ( iMaxNumChannels );
-    vecvecfIntermediateProcBuf.Init ( iMaxNumChannels );
-    vecvecbyCodedData.Init ( iMaxNumChannels );
+    pMixMatrixSnapshot = &MixMatrix.GetSnapshot();
+    vecfFadeInGains.Init ( iMaxNumChannels );
+    vecNumMixDeviations.Init ( iMaxNumChannels );
+    vecUseSharedMixBus.Init ( iMaxNumChannels );
+    vecSourcePeaks.Init ( iMaxNumChannels );
+    vecNumSkippedMixPairs.Init ( iMaxNumChannels );
     vecNumAudioChannels.Init ( iMaxNumChannels );
     vecNumFrameSizeConvBlocks.Init ( iMaxNumChannels );
     vecUseDoubleSysFraSizeConvBuf.Init ( iMaxNumChannels );
     vecAudioComprType.Init ( iMaxNumChannels );
+    vecNumTickDecodedBlocks.Init ( iMaxNumChannels );
 
-    for ( i = 0; i < iMaxNumChannels; i++ )
-    {
-        // init vectors storing information of all channels
-        vecvecfGains[i].Init ( iMaxNumChannels );
-        vecvecfPannings[i].Init ( iMaxNumChannels );
-
-        // we always use stereo audio buffers (which is the worst case)
-        vecvecsData[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
-        vecvecsData2[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
-
-        // (note that we only allocate iMaxNumChannels buffers for the send
-        // and coded data because of the OMP implementation)
-        vecvecsSendData[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+    // the audio buffers of the tick are allocated in the audio arena once the
+    // number of threads is known (see AllocateAudioArena())
+    vecsRecorderFrame.Init ( MAX_FRAME_NUM_VALUES );
 
-        // allocate worst case memory for intermediate processing buffers in float precision
-        vecvecfIntermediateProcBuf[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
-
-        // allocate worst case memory for the coded data
-        vecvecbyCodedData[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
-    }
+    // allocate worst case memory for the talker ranking (the talker levels use
+    // the signal level meter with mono output and are updated on every tick)
+    vecTalkerLevelMeters.Init ( MAX_NUM_CHANNELS, CStereoSignalLevelMeter ( false ) );
+    vecIsTopTalker.Init ( MAX_NUM_CHANNELS, 0 );
+    vecdTalkerLevels.Init ( iMaxNumChannels );
+    vecdTalkerScores.Init ( iMaxNumChannels );
+    vecTalkerRanking.Init ( iMaxNumChannels );
+    vecTopTalkers.Init ( iMaxNumChannels );
 
     // allocate worst case memory for the channel levels
     vecChannelLevels.Init ( iMaxNumChannels );
 
+    // allocate the queues between the mixer and the main thread
+    MixerEventQueue.Init ( 2 * iMaxNumChannels );
+    ChanResetQueue.Init ( 2 * iMaxNumChannels );
+
     // enable logging (if requested)
     if ( !strLoggingFileName.isEmpty() )
     {
@@ -224,7 +281,18 @@ CServer::CServer ( const int          iNewMaxNumChan,
     for ( i = 0; i < iMaxNumChannels; i++ )
     {
         vecChannels[i].SetEnable ( true );
-        vecChannelOrder[i] = i;
+        vecChannels[i].SetUseJitterHistogram ( Tuning.bUseJitterHistogram );
+    }
+
+    // the mixing kernels are selected depending on the CPU features on construction
+    qDebug() << "using" << CMixKernels::GetArchName ( MixKernels.GetArch() ) << "mixing kernels";
+
+    // check if the real-time mixer thread is possible (without a real-time
+    // priority the mixer thread would compete with all other threads)
+    if ( bUseRealTimeMixer && !HighPrecisionTimer.SetRealTimePriority ( true ) )
+    {
+        qWarning() << "real-time priority not available for the mixer thread, using the main thread";
+        bUseRealTimeMixer = false;
     }
 
     int iAvailableCores = QThread::idealThreadCount();
@@ -243,14 +311,108 @@ CServer::CServer ( const int          iNewMaxNumChan,
             iMaxNumThreads = iAvailableCores;
             qDebug() << "multithreading enabled, setting thread count to" << iMaxNumThreads;
 
-            pThreadPool = std::unique_ptr<CThreadPool> ( new CThreadPool{ static_cast<size_t> ( iMaxNumThreads ) } );
-            Futures.reserve ( iMaxNumThreads );
+            // the timer thread takes part in the processing, therefore one worker less is needed
+            // (the real-time workers park without spinning, they are woken up without delay)
+            pThreadPool = std::unique_ptr<CTickWorkerPool<CServer>> ( new CTickWorkerPool<CServer>{ static_cast<size_t> ( iMaxNumThreads - 1 ),
+                                                                                                     static_cast<size_t> ( iMaxNumThreads ),
+                                                                                                     bUseRealTimeMixer ? 0 : 1000 } );
+
+            // each thread processes one block of channels per tick
+            iNumScratch = iMaxNumThreads;
+        }
+    }
+
+    AllocateAudioArena();
+
+    // no destination is resolved before a channel is initialized
+    for ( i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        veciSendSockAddrLen[i]     = 0;
+        veciCodecConfigVersions[i] = -1; // the first tick takes the snapshot
+    }
+
+    // the decode worker is only fed by the receive thread if the audio arena is ready
+    if ( bDecodeOnArrival )
+    {
+        for ( i = 0; i < MAX_NUM_CHANNELS; i++ )
+        {
+            vecDecodedFrames[i].iState.store ( DF_EMPTY );
+            vecDecodedFrames[i].iNumBlocks            = 0;
+            vecDecodedFrames[i].eAudioCompressionType = CT_NONE;
+            vecDecodedFrames[i].iNumAudioChannels     = 0;
+            vecDecodedFrames[i].iCodecConfigVersion   = -1;
+        }
+
+        pDecodeWorker = std::unique_ptr<CItemWorker<CServer>> ( new CItemWorker<CServer> ( CServer::DecodeOnArrival, this, MAX_NUM_CHANNELS ) );
+    }
+
+    // the inbound rings must be ready before the receive thread is started
+    if ( bUseInboundRing )
+    {
+        for ( i = 0; i < iMaxNumChannels; i++ )
+        {
+            vecInboundRings[i].Init ( INBOUND_RING_NUM_PACKETS, INBOUND_RING_MAX_PACKET_SIZE );
+            vecInboundRingBusy[i].store ( false );
+            veciChanGenerations[i].store ( 0 );
+        }
+    }
+
+    // the blocks which are decoded on arrival cannot be time-scaled anymore
+    if ( Tuning.bUseAdaptivePlayout && bDecodeOnArrival )
+    {
+        qWarning() << "the adaptive playout cannot be used together with decode on arrival, using decode on arrival";
+    }
+
+    // the shared bus contains all sources, therefore it cannot be combined with the top talkers mode
+    if ( bUseSharedMixBus && ( iMaxNumTopTalkers > 0 ) )
+    {
+        qWarning() << "the shared mix bus cannot be used together with the top talkers mode, using the top talkers mode";
+        bUseSharedMixBus = false;
+    }
+
+    // allocate the queues which hand over the control-plane work of the
+    // real-time mixer thread to the main thread
+    if ( bUseRealTimeMixer )
+    {
+        // the mixer thread waits for the workers of the tick and for the decode
+        // worker, with a lower priority they could be starved by the mixer
+        // thread while it waits (priority inversion)
+        if ( pThreadPool )
+        {
+            for ( std::thread& Worker : pThreadPool->GetThreads() )
+            {
+                HighPrecisionTimer.ApplyRealTimePriority ( Worker );
+            }
+        }
+
+        if ( pDecodeWorker )
+        {
+            HighPrecisionTimer.ApplyRealTimePriority ( pDecodeWorker->GetThread() );
         }
+
+        JitBufChangeQueue.Init ( 2 * iMaxNumChannels );
+        LevelListQueue.Init ( 4 );
+        RecorderFrameQueue.Init ( RECORDER_QUEUE_NUM_TICKS * iMaxNumChannels );
+        vecMainChannelLevels.Init ( iMaxNumChannels );
+        vecsMainRecorderFrame.Init ( MAX_FRAME_NUM_VALUES );
     }
 
     // Connections -------------------------------------------------------------
     // connect timer timeout signal
-    QObject::connect ( &HighPrecisionTimer, &CHighPrecisionTimer::timeout, this, &CServer::OnTimer );
+    if ( bUseRealTimeMixer )
+    {
+        // the tick is processed directly in the high priority timer thread, the
+        // events for the main thread are polled from the mixer event queue
+        QObject::connect ( &HighPrecisionTimer, &CHighPrecisionTimer::timeout, this, &CServer::OnTimer, Qt::DirectConnection );
+
+        QObject::connect ( &MixerEventTimer, &QTimer::timeout, this, &CServer::OnMixerEventTimer );
+
+        MixerEventTimer.start ( MIXER_EVENT_POLL_INTERVAL_MS );
+    }
+    else
+    {
+        QObject::connect ( &HighPrecisionTimer, &CHighPrecisionTimer::timeout, this, &CServer::OnTimer );
+    }
 
     QObject::connect ( &ConnLessProtocol, &CProtocol::CLMessReadyForSending, this, &CServer::OnSendCLProtMessage );
 
@@ -301,9 +463,61 @@ CServer::CServer ( const int          iNewMaxNumChan,
 
     connectChannelSignalsToServerSlots<MAX_NUM_CHANNELS>();
 
+    // receive several datagrams per system call if requested
+    Socket.SetReceiveBatchSize ( Tuning.iRecvBatchSize );
+
+#ifdef USE_RECV_SHARDING
+    // Open additional receive sockets on the same port. The kernel distributes
+    // the clients over all sockets by hashing the address and port, so the
+    // packets of one client are always received by the same thread. All sockets
+    // feed the same channel table. Since the sockets share the local address
+    // and port, sending through the main socket keeps the source of the packets
+    // (and therefore the NAT mappings of the clients) unchanged.
+    for ( i = 1; i < Tuning.iNumRecvSockets; i++ )
+    {
+        vecpRecvShardSockets.push_back (
+            std::unique_ptr<CHighPrioSocket> ( new CHighPrioSocket ( this, iPortNumber, iQosNumber, strServerBindIP, bNEnableIPv6, true ) ) );
+
+        vecpRecvShardSockets.back()->SetReceiveBatchSize ( Tuning.iRecvBatchSize );
+    }
+#else
+    if ( Tuning.iNumRecvSockets > 1 )
+    {
+        qWarning() << "multiple receive sockets are not supported on this platform, using one socket";
+    }
+#endif
+
+    // receive and send through io_uring if requested (the regular socket calls
+    // are used if io_uring is not available)
+    if ( Tuning.bUseIoUring )
+    {
+        bool bIoUringOK = Socket.SetUseIoUring ( true );
+
+        for ( const std::unique_ptr<CHighPrioSocket>& pRecvShardSocket : vecpRecvShardSockets )
+        {
+            bIoUringOK = pRecvShardSocket->SetUseIoUring ( true ) && bIoUringOK;
+        }
+
+        if ( !bIoUringOK )
+        {
+            qWarning() << "io_uring could not be initialized, using the regular socket calls";
+        }
+
+        // each mixing thread sends its batch through an own ring
+        for ( i = 0; i < vecSendBatches.Size(); i++ )
+        {
+            Socket.PrepareSendBatch ( vecSendBatches[i] );
+        }
+    }
+
     // start the socket (it is important to start the socket after all
     // initializations and connections)
     Socket.Start();
+
+    for ( const std::unique_ptr<CHighPrioSocket>& pRecvShardSocket : vecpRecvShardSockets )
+    {
+        pRecvShardSocket->Start();
+    }
 }
 
 template<unsigned int slotId>
@@ -321,6 +535,12 @@ inline void CServer::connectChannelSignalsToServerSlots()
 
     void ( CServer::*pOnServerAutoSockBufSizeChangeCh ) ( int ) = &CServerSlots<slotId>::OnServerAutoSockBufSizeChangeCh;
 
+    void ( CServer::*pOnChanGainHasChangedCh ) ( int, float ) = &CServerSlots<slotId>::OnChanGainHasChangedCh;
+
+    void ( CServer::*pOnChanPanHasChangedCh ) ( int, float ) = &CServerSlots<slotId>::OnChanPanHasChangedCh;
+
+    void ( CServer::*pOnNetTranspPropsHaveChangedCh )() = &CServerSlots<slotId>::OnNetTranspPropsHaveChangedCh;
+
     // send message
     QObject::connect ( &vecChannels[iCurChanID], &CChannel::MessReadyForSending, this, pOnSendProtMessCh );
 
@@ -339,6 +559,14 @@ inline void CServer::connectChannelSignalsToServerSlots()
     // auto socket buffer size change
     QObject::connect ( &vecChannels[iCurChanID], &CChannel::ServerAutoSockBufSizeChange, this, pOnServerAutoSockBufSizeChangeCh );
 
+    // gain/pan of another channel has changed (publish it to the mixer)
+    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ChanGainHasChanged, this, pOnChanGainHasChangedCh );
+
+    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ChanPanHasChanged, this, pOnChanPanHasChangedCh );
+
+    // the client has negotiated its codec (create the codec state if required)
+    QObject::connect ( &vecChannels[iCurChanID], &CChannel::NetTranspPropsHaveChanged, this, pOnNetTranspPropsHaveChangedCh );
+
     connectChannelSignalsToServerSlots<slotId - 1>();
 }
 
@@ -350,21 +578,103 @@ void CServer::CreateAndSendJitBufMessage ( const int iCurChanID, const int iNNum
 
 CServer::~CServer()
 {
+    // the additional receive threads put packets in the channels
+    vecpRecvShardSockets.clear();
+
+    // the decode worker uses the channels and the audio arena, stop it first
+    pDecodeWorker.reset();
+}
+
+void CServer::AllocateAudioArena()
+{
+    // Since we have a real-time critical processing routine, no memory must be
+    // allocated in the tick. All buffers of the tick are placed in one arena
+    // and have the worst case size (stereo, double frame size).
+    // The frames of the unused sample type are not allocated.
+    const int iNumInt16Frames = bUseFloatPipeline ? 0 : 2 * iMaxNumChannels; // current and previous frames
+    const int iNumFloatFrames = bUseFloatPipeline ? 2 * iMaxNumChannels : 0;
+
+    // per channel slabs (index: channel count)
+    AudioArena.Reserve ( vecvecfGains, "gains", iMaxNumChannels, iMaxNumChannels );
+    AudioArena.Reserve ( vecvecfPannings, "pannings", iMaxNumChannels, iMaxNumChannels );
+    AudioArena.Reserve ( vecvecActiveSources, "active sources", iMaxNumChannels, iMaxNumChannels );
+    AudioArena.Reserve ( Int16Frames, "int16 frames", iNumInt16Frames, MAX_FRAME_NUM_VALUES );
+    AudioArena.Reserve ( FloatFrames, "float frames", iNumFloatFrames, MAX_FRAME_NUM_VALUES );
+
+    // per channel slabs for decode on arrival (index: channel ID)
+    const int iNumArrivalFrames = bDecodeOnArrival ? iMaxNumChannels : 0;
+
+    AudioArena.Reserve ( Int16ArrivalFrames, "int16 arrival frames", bUseFloatPipeline ? 0 : iNumArrivalFrames, MAX_FRAME_NUM_VALUES );
+    AudioArena.Reserve ( FloatArrivalFrames, "float arrival frames", bUseFloatPipeline ? iNumArrivalFrames : 0, MAX_FRAME_NUM_VALUES );
+
+    // per thread slabs (index: scratch)
+    AudioArena.Reserve ( MixScratch, "mix scratch", iNumScratch, MAX_FRAME_NUM_VALUES );
+    AudioArena.Reserve ( Int16SendScratch, "int16 send scratch", bUseFloatPipeline ? 0 : iNumScratch, MAX_FRAME_NUM_VALUES );
+    AudioArena.Reserve ( FloatSendScratch, "float send scratch", bUseFloatPipeline ? iNumScratch : 0, MAX_FRAME_NUM_VALUES );
+
+    // shared mix buses (written by the timer thread only)
+    AudioArena.Reserve ( SharedMixBusMono, "shared mix bus mono", 1, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES );
+    AudioArena.Reserve ( SharedMixBusStereo, "shared mix bus stereo", 1, MAX_FRAME_NUM_VALUES );
+
+    AudioArena.Allocate();
+
+#ifdef _DEBUG_
+    qDebug() << qUtf8Printable ( AudioArena.GetLayoutReport ( iMaxNumChannels ) );
+#endif
+
+    // the current frames are exchanged with the previous frames for the delay
+    // panning, therefore they are accessed through pointer tables (note that
+    // the previous frames are indexed by the channel ID)
+    vecpsData.Init ( iMaxNumChannels, nullptr );
+    vecpsPrevData.Init ( iMaxNumChannels, nullptr );
+    vecpfData.Init ( iMaxNumChannels, nullptr );
+    vecpfPrevData.Init ( iMaxNumChannels, nullptr );
+    vecpsArrivalData.Init ( iMaxNumChannels, nullptr );
+    vecpfArrivalData.Init ( iMaxNumChannels, nullptr );
+
     for ( int i = 0; i < iMaxNumChannels; i++ )
     {
-        // free audio encoders and decoders
-        opus_custom_encoder_destroy ( OpusEncoderMono[i] );
-        opus_custom_decoder_destroy ( OpusDecoderMono[i] );
-        opus_custom_encoder_destroy ( OpusEncoderStereo[i] );
-        opus_custom_decoder_destroy ( OpusDecoderStereo[i] );
-        opus_custom_encoder_destroy ( Opus64EncoderMono[i] );
-        opus_custom_decoder_destroy ( Opus64DecoderMono[i] );
-        opus_custom_encoder_destroy ( Opus64EncoderStereo[i] );
-        opus_custom_decoder_destroy ( Opus64DecoderStereo[i] );
+        if ( bUseFloatPipeline )
+        {
+            vecpfData[i]     = FloatFrames[i];
+            vecpfPrevData[i] = FloatFrames[iMaxNumChannels + i];
+
+            if ( bDecodeOnArrival )
+            {
+                vecpfArrivalData[i] = FloatArrivalFrames[i];
+            }
+        }
+        else
+        {
+            vecpsData[i]     = Int16Frames[i];
+            vecpsPrevData[i] = Int16Frames[iMaxNumChannels + i];
+
+            if ( bDecodeOnArrival )
+            {
+                vecpsArrivalData[i] = Int16ArrivalFrames[i];
+            }
+        }
+    }
+
+    // the coded data is handed over to the channel as a vector
+    vecvecbyCodedData.Init ( iNumScratch );
+
+    vecSendBatches.Init ( iNumScratch );
+
+    for ( int i = 0; i < iNumScratch; i++ )
+    {
+        vecvecbyCodedData[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
+        vecSendBatches[i].Init();
+    }
+}
+
+void CServer::FlushSendBatch ( const int iScratchIdx )
+{
+    CSendBatch& SendBatch = vecSendBatches[iScratchIdx];
 
-        // free audio modes
-        opus_custom_mode_destroy ( OpusMode[i] );
-        opus_custom_mode_destroy ( Opus64Mode[i] );
+    if ( !SendBatch.IsEmpty() )
+    {
+        Socket.SendBatch ( SendBatch );
     }
 }
 
@@ -445,12 +755,15 @@ void CServer::OnNewConnection ( int iChID, int iTotChans, CHostAddress RecHostAd
     // send recording state message on connection
     vecChannels[iChID].CreateRecorderStateMes ( JamController.GetRecorderState() );
 
-    // reset the conversion buffers
-    DoubleFrameSizeConvBufIn[iChID].Reset();
-    DoubleFrameSizeConvBufOut[iChID].Reset();
+    // reset the conversion buffers and the talker state (both are owned by
+    // the mixer, the reset is done at the beginning of the next tick)
+    if ( !ChanResetQueue.Put ( iChID ) )
+    {
+        qWarning() << "channel reset queue is full";
+    }
 
     // logging of new connected channel
-    Logging.AddNewConnection ( RecHostAddr.InetAddr, iTotChans );
+    Logging.AddNewConnection ( RecHostAddr.GetInetAddr(), iTotChans );
 }
 
 void CServer::OnServerFull ( CHostAddress RecHostAddr )
@@ -540,6 +853,10 @@ void CServer::Start()
     // only start if not already running
     if ( !IsRunning() )
     {
+        // restart the tick grid of the lateness measurement
+        TickLateness.Start ( static_cast<int64_t> ( iServerFrameSizeSamples ) * 1000000000 / SYSTEM_SAMPLE_RATE_HZ );
+        bNoClientEventPosted = false;
+
         // start timer
         HighPrecisionTimer.Start();
 
@@ -574,6 +891,9 @@ void CServer::OnTimer()
     // static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure();
     //### TEST: END ###//
 
+    // measure how late this tick is processed
+    TickLateness.Update();
+
     // Get data from all connected clients -------------------------------------
     // some inits
     int  iNumClients          = 0; // init connected client counter
@@ -582,64 +902,119 @@ void CServer::OnTimer()
     int  iMTBlockSize         = 0;     // init block size for multithreading
     bChannelIsNowDisconnected = false; // note that the flag must be a member function since QtConcurrent::run can only take 5 params
 
-    {
-        // Make put and get calls thread safe.
-        QMutexLocker locker ( &Mutex );
+    // Note that the tick does not take the server mutex which is held by the
+    // protocol and connection handlers: the resets of new connections are
+    // handed over by the reset queue and a channel is only added to or removed
+    // from the channel map under the channel order mutex, which the main thread
+    // never takes (see PutAudioDataLocked() and FreeChannel()).
 
-        // first, get number and IDs of connected channels
-        for ( int i = 0; i < iMaxNumChannels; i++ )
+    // apply the resets requested for new connections
+    int iResetChanID;
+
+    while ( ChanResetQueue.Get ( iResetChanID ) )
+    {
+        DoubleFrameSizeConvBufIn[iResetChanID].Reset();
+        DoubleFrameSizeConvBufOut[iResetChanID].Reset();
+        DoubleFrameSizeConvBufInFloat[iResetChanID].Reset();
+        DoubleFrameSizeConvBufOutFloat[iResetChanID].Reset();
+        vecTalkerLevelMeters[iResetChanID].Reset();
+        vecIsTopTalker[iResetChanID] = 0;
+        if ( bUseFloatPipeline )
         {
-            if ( vecChannels[i].IsConnected() )
-            {
-                // add ID and increment counter (note that the vector length is
-                // according to the worst case scenario, if the number of
-                // connected clients is less, only a subset of elements of this
-                // vector are actually used and the others are dummy elements)
-                vecChanIDsCurConChan[iNumClients] = i;
-                iNumClients++;
-            }
+            std::fill_n ( vecpfPrevData[iResetChanID], MAX_FRAME_NUM_VALUES, 0.0f );
+            FloatPlayout[iResetChanID].Reset();
+        }
+        else
+        {
+            std::fill_n ( vecpsPrevData[iResetChanID], MAX_FRAME_NUM_VALUES, static_cast<int16_t> ( 0 ) );
+            Int16Playout[iResetChanID].Reset();
         }
 
-        // use multithreading for any non-zero number of clients
-        // (overhead is low and it is worth doing for all numbers)
-        bUseMT = bUseMultithreading && iNumClients > 0;
-
-        // prepare and decode connected channels
-        if ( !bUseMT )
+        // a frame decoded on arrival (or a packet in the inbound ring) may
+        // still belong to the previous connection
+        if ( bDecodeOnArrival )
         {
-            // run the OPUS decoder for all data blocks
-            DecodeReceiveDataBlocks ( this, 0, iNumClients - 1, iNumClients );
+            LockDecodedFrame ( iResetChanID );
+            vecDecodedFrames[iResetChanID].iNumBlocks = 0;
+            CodecPool.Reset ( iResetChanID );
+            FlushInboundRing ( iResetChanID );
+            ReleaseDecodedFrame ( iResetChanID );
         }
         else
         {
-            // spread work equally among available threads
-            iNumBlocks   = std::min ( iNumClients, iMaxNumThreads );
-            iMTBlockSize = ( iNumClients - 1 ) / iNumBlocks + 1;
+            CodecPool.Reset ( iResetChanID );
+            FlushInboundRing ( iResetChanID );
+        }
+    }
 
-            // processing with multithreading
-            for ( int iBlockCnt = 0; iBlockCnt < iNumBlocks; iBlockCnt++ )
-            {
-                // The work for OPUS decoding is distributed over all available processor cores.
-                // By using the future synchronizer we make sure that all
-                // threads are done when we leave the timer callback function.
-                const int iStartChanCnt = iBlockCnt * iMTBlockSize;
-                const int iStopChanCnt  = std::min ( ( iBlockCnt + 1 ) * iMTBlockSize - 1, iNumClients - 1 );
+    // get the current gains/pans (the snapshot is not modified during this tick)
+    pMixMatrixSnapshot = &MixMatrix.GetSnapshot();
 
-                Futures.push_back ( pThreadPool->enqueue ( CServer::DecodeReceiveDataBlocks, this, iStartChanCnt, iStopChanCnt, iNumClients ) );
-            }
+    // first, get number and IDs of connected channels
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        if ( vecChannels[i].IsConnected() )
+        {
+            // add ID and increment counter (note that the vector length is
+            // according to the worst case scenario, if the number of
+            // connected clients is less, only a subset of elements of this
+            // vector are actually used and the others are dummy elements)
+            vecChanIDsCurConChan[iNumClients] = i;
 
-            // make sure all concurrent run threads have finished when we leave this function
-            for ( auto& future : Futures )
-            {
-                future.wait();
-            }
-            Futures.clear();
+            // the fade-in gains must be the same for all targets during this tick
+            vecfFadeInGains[iNumClients] = vecChannels[i].GetFadeInGain();
+
+            iNumClients++;
+        }
+    }
+
+    // use multithreading for any non-zero number of clients
+    // (overhead is low and it is worth doing for all numbers)
+    bUseMT = bUseMultithreading && iNumClients > 0;
+
+    // prepare and decode connected channels
+    if ( !bUseMT )
+    {
+        // all channels use the same scratch slabs
+        iScratchBlockSize = std::max ( iNumClients, 1 );
+
+        // run the OPUS decoder for all data blocks
+        DecodeReceiveDataBlocks ( this, 0, iNumClients - 1, iNumClients );
+    }
+    else
+    {
+        // spread work equally among available threads
+        iNumBlocks        = std::min ( iNumClients, iMaxNumThreads );
+        iMTBlockSize      = ( iNumClients - 1 ) / iNumBlocks + 1;
+        iScratchBlockSize = iMTBlockSize;
+
+        // processing with multithreading
+        for ( int iBlockCnt = 0; iBlockCnt < iNumBlocks; iBlockCnt++ )
+        {
+            // The work for OPUS decoding is distributed over all available processor cores.
+            // By using the barrier of the worker pool we make sure that all
+            // threads are done when we leave the timer callback function.
+            const int iStartChanCnt = iBlockCnt * iMTBlockSize;
+            const int iStopChanCnt  = std::min ( ( iBlockCnt + 1 ) * iMTBlockSize - 1, iNumClients - 1 );
+
+            pThreadPool->Enqueue ( CServer::DecodeReceiveDataBlocks, this, iStartChanCnt, iStopChanCnt, iNumClients );
         }
 
-        // a channel is now disconnected, take action on it
-        if ( bChannelIsNowDisconnected )
+        // make sure all concurrent run threads have finished when we leave this function
+        pThreadPool->RunAndWait();
+    }
+
+    // a channel is now disconnected, take action on it
+    if ( bChannelIsNowDisconnected )
+    {
+        // update channel list for all currently connected clients (the
+        // protocol must only be used from the main thread)
+        if ( bUseRealTimeMixer )
+        {
+            MixerEventQueue.Put ( ME_CHANNEL_LIST_CHANGED );
+        }
+        else
         {
-            // update channel list for all currently connected clients
             CreateAndSendChanListForAllConChannels();
         }
     }
@@ -649,19 +1024,66 @@ void CServer::OnTimer()
     // one client is connected.
     if ( iNumClients > 0 )
     {
+        bNoClientEventPosted = false;
+
+        // select the sources which are mixed in top talkers mode
+        if ( iMaxNumTopTalkers > 0 )
+        {
+            SelectTopTalkers ( iNumClients );
+        }
+
+        // mix the shared buses for the targets with mostly default gains/pans
+        if ( bUseSharedMixBus )
+        {
+            if ( bUseFloatPipeline )
+            {
+                CreateSharedMixBuses ( iNumClients, vecpfData );
+            }
+            else
+            {
+                CreateSharedMixBuses ( iNumClients, vecpsData );
+            }
+        }
+
         // calculate levels for all connected clients
-        const bool bSendChannelLevels = CreateLevelsForAllConChannels ( iNumClients, vecNumAudioChannels, vecvecsData, vecChannelLevels );
+        const bool bSendChannelLevels = bUseFloatPipeline
+                                            ? CreateLevelsForAllConChannels ( iNumClients, vecNumAudioChannels, vecpfData, vecChannelLevels )
+                                            : CreateLevelsForAllConChannels ( iNumClients, vecNumAudioChannels, vecpsData, vecChannelLevels );
+
+        // the real-time mixer thread hands over the channel levels to the main
+        // thread which sends them (a dropped list is replaced by the next one)
+        if ( bSendChannelLevels && bUseRealTimeMixer )
+        {
+            TickLevelList.iNumClients = iNumClients;
+
+            for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
+            {
+                TickLevelList.veciChanIDs[iChanCnt] = vecChanIDsCurConChan[iChanCnt];
+                TickLevelList.vecLevels[iChanCnt]   = vecChannelLevels[iChanCnt];
+            }
+
+            LevelListQueue.Put ( TickLevelList );
+        }
 
         for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
         {
             // get actual ID of current channel
             const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
 
-            // update socket buffer size
-            vecChannels[iCurChanID].UpdateSocketBufferSize();
+            // update socket buffer size (the jitter buffer of the real-time mixer
+            // is resized by the main thread, a dropped request is repeated with the
+            // next tick)
+            if ( !bUseRealTimeMixer )
+            {
+                vecChannels[iCurChanID].UpdateSocketBufferSize();
+            }
+            else if ( vecChannels[iCurChanID].IsSocketBufferSizeUpdateRequired() )
+            {
+                JitBufChangeQueue.Put ( iCurChanID );
+            }
 
             // send channel levels if they are ready
-            if ( bSendChannelLevels )
+            if ( bSendChannelLevels && !bUseRealTimeMixer )
             {
                 ConnLessProtocol.CreateCLChannelLevelListMes ( vecChannels[iCurChanID].GetAddress(), vecChannelLevels, iNumClients );
             }
@@ -669,11 +1091,40 @@ void CServer::OnTimer()
             // export the audio data for recording purpose
             if ( JamController.GetRecordingEnabled() )
             {
-                emit AudioFrame ( iCurChanID,
-                                  vecChannels[iCurChanID].GetName(),
-                                  vecChannels[iCurChanID].GetAddress(),
-                                  vecNumAudioChannels[iChanCnt],
-                                  vecvecsData[iChanCnt] );
+                // the recorder needs int16 samples
+                const int iNumValues      = iServerFrameSizeSamples * vecNumAudioChannels[iChanCnt];
+                int16_t*  psRecorderFrame = bUseRealTimeMixer ? TickRecorderFrame.vecsData : &vecsRecorderFrame[0];
+
+                if ( bUseFloatPipeline )
+                {
+                    for ( int i = 0; i < iNumValues; i++ )
+                    {
+                        psRecorderFrame[i] = Float2Short ( vecpfData[iChanCnt][i] * _MAXSHORT );
+                    }
+                }
+                else
+                {
+                    std::copy ( vecpsData[iChanCnt], vecpsData[iChanCnt] + iNumValues, psRecorderFrame );
+                }
+
+                if ( bUseRealTimeMixer )
+                {
+                    // the frame is emitted by the main thread (if the queue is
+                    // full, the frame is missing in the recording)
+                    TickRecorderFrame.iChanID           = iCurChanID;
+                    TickRecorderFrame.iNumAudioChannels = vecNumAudioChannels[iChanCnt];
+                    TickRecorderFrame.iNumValues        = iNumValues;
+
+                    RecorderFrameQueue.Put ( TickRecorderFrame );
+                }
+                else
+                {
+                    emit AudioFrame ( iCurChanID,
+                                      vecChannels[iCurChanID].GetName(),
+                                      vecChannels[iCurChanID].GetAddress(),
+                                      vecNumAudioChannels[iChanCnt],
+                                      vecsRecorderFrame );
+                }
             }
 
             // processing without multithreading
@@ -685,6 +1136,12 @@ void CServer::OnTimer()
             }
         }
 
+        if ( !bUseMT )
+        {
+            // all channels share the first send batch
+            FlushSendBatch ( 0 );
+        }
+
         // processing with multithreading
         if ( bUseMT )
         {
@@ -693,36 +1150,159 @@ void CServer::OnTimer()
                 // Generate a separate mix for each channel, OPUS encode the
                 // audio data and transmit the network packet. The work is
                 // distributed over all available processor cores.
-                // By using the future synchronizer we make sure that all
+                // By using the barrier of the worker pool we make sure that all
                 // threads are done when we leave the timer callback function.
                 const int iStartChanCnt = iBlockCnt * iMTBlockSize;
                 const int iStopChanCnt  = std::min ( ( iBlockCnt + 1 ) * iMTBlockSize - 1, iNumClients - 1 );
 
-                Futures.push_back ( pThreadPool->enqueue ( CServer::MixEncodeTransmitDataBlocks, this, iStartChanCnt, iStopChanCnt, iNumClients ) );
+                pThreadPool->Enqueue ( CServer::MixEncodeTransmitDataBlocks, this, iStartChanCnt, iStopChanCnt, iNumClients );
             }
 
             // make sure all concurrent run threads have finished when we leave this function
-            for ( auto& fFuture : Futures )
-            {
-                fFuture.wait();
-            }
-            Futures.clear();
+            pThreadPool->RunAndWait();
         }
-        if ( bDelayPan )
+
+        // update the sparse mixing statistics
+        int iNumSkippedMixPairs = 0;
+
+        for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
         {
-            for ( int i = 0; i < iNumClients; i++ )
-            {
-                for ( int j = 0; j < 2 * ( iServerFrameSizeSamples ); j++ )
-                {
-                    vecvecsData2[i][j] = vecvecsData[i][j];
-                }
-            }
+            iNumSkippedMixPairs += vecNumSkippedMixPairs[iChanCnt];
         }
-    }
-    else
+
+        iMixPairsLastTick        = iNumClients * iNumClients;
+        iSkippedMixPairsLastTick = iNumSkippedMixPairs;
+        iMixPairsTotal += iNumClients * iNumClients;
+        iSkippedMixPairsTotal += iNumSkippedMixPairs;
+
+        // update the decoding statistics (the blocks decoded on arrival are
+        // counted by the decode worker)
+        int iNumTickDecodedBlocks = 0;
+
+        for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
+        {
+            iNumTickDecodedBlocks += vecNumTickDecodedBlocks[iChanCnt];
+        }
+
+        iTickDecodedBlocksTotal += iNumTickDecodedBlocks;
+
+        // keep the current frames as previous frames for the delay panning:
+        // the buffers are only exchanged, the decoder overwrites the buffer it
+        // gets back in the next tick
+        if ( bDelayPan )
+        {
+            for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
+            {
+                if ( bUseFloatPipeline )
+                {
+                    std::swap ( vecpfData[iChanCnt], vecpfPrevData[vecChanIDsCurConChan[iChanCnt]] );
+                }
+                else
+                {
+                    std::swap ( vecpsData[iChanCnt], vecpsPrevData[vecChanIDsCurConChan[iChanCnt]] );
+                }
+            }
+        }
+    }
+    else
     {
         // Disable server if no clients are connected. In this case the server
         // does not consume any significant CPU when no client is connected.
+        // The real-time mixer thread cannot stop itself, this is done by the
+        // main thread.
+        if ( !bUseRealTimeMixer )
+        {
+            Stop();
+        }
+        else if ( !bNoClientEventPosted )
+        {
+            bNoClientEventPosted = MixerEventQueue.Put ( ME_NO_CLIENT_CONNECTED );
+        }
+    }
+}
+
+void CServer::OnMixerEventTimer()
+{
+    EMixerEvent eEvent;
+    bool        bChanListChanged   = false;
+    bool        bNoClientConnected = false;
+
+    // collect all events handed over by the real-time mixer thread
+    while ( MixerEventQueue.Get ( eEvent ) )
+    {
+        switch ( eEvent )
+        {
+        case ME_CHANNEL_LIST_CHANGED:
+            bChanListChanged = true;
+            break;
+
+        case ME_NO_CLIENT_CONNECTED:
+            bNoClientConnected = true;
+            break;
+        }
+    }
+
+    if ( bChanListChanged )
+    {
+        // update channel list for all currently connected clients
+        CreateAndSendChanListForAllConChannels();
+    }
+
+    // resize the jitter buffers which have a new auto setting (a channel may be
+    // queued several times until its buffer is resized)
+    int iChanID;
+
+    while ( JitBufChangeQueue.Get ( iChanID ) )
+    {
+        if ( vecChannels[iChanID].IsConnected() )
+        {
+            vecChannels[iChanID].UpdateSocketBufferSize();
+        }
+    }
+
+    // only the latest channel levels are sent
+    bool bLevelListReceived = false;
+
+    while ( LevelListQueue.Get ( MainLevelList ) )
+    {
+        bLevelListReceived = true;
+    }
+
+    if ( bLevelListReceived )
+    {
+        for ( int iChanCnt = 0; iChanCnt < MainLevelList.iNumClients; iChanCnt++ )
+        {
+            vecMainChannelLevels[iChanCnt] = MainLevelList.vecLevels[iChanCnt];
+        }
+
+        for ( int iChanCnt = 0; iChanCnt < MainLevelList.iNumClients; iChanCnt++ )
+        {
+            const int iCurChanID = MainLevelList.veciChanIDs[iChanCnt];
+
+            if ( vecChannels[iCurChanID].IsConnected() )
+            {
+                ConnLessProtocol.CreateCLChannelLevelListMes ( vecChannels[iCurChanID].GetAddress(),
+                                                               vecMainChannelLevels,
+                                                               MainLevelList.iNumClients );
+            }
+        }
+    }
+
+    // export the audio data of the mixer thread for recording purpose
+    while ( RecorderFrameQueue.Get ( MainRecorderFrame ) )
+    {
+        std::copy ( MainRecorderFrame.vecsData, MainRecorderFrame.vecsData + MainRecorderFrame.iNumValues, vecsMainRecorderFrame.begin() );
+
+        emit AudioFrame ( MainRecorderFrame.iChanID,
+                          vecChannels[MainRecorderFrame.iChanID].GetName(),
+                          vecChannels[MainRecorderFrame.iChanID].GetAddress(),
+                          MainRecorderFrame.iNumAudioChannels,
+                          vecsMainRecorderFrame );
+    }
+
+    // a client may have connected in the meantime
+    if ( bNoClientConnected && ( GetNumberOfConnectedClients() == 0 ) )
+    {
         Stop();
     }
 }
@@ -747,21 +1327,28 @@ void CServer::MixEncodeTransmitDataBlocks ( CServer* pServer, const int iStartCh
     {
         pServer->MixEncodeTransmitData ( iChanCnt, iNumClients );
     }
+
+    // the packets of the block are sent together
+    pServer->FlushSendBatch ( pServer->GetScratchIdx ( iStartChanCnt ) );
 }
 
 void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
 {
-    int                iUnused;
-    int                iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
-    OpusCustomDecoder* CurOpusDecoder;
-    unsigned char*     pCurCodedData;
+    int iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
 
     // get actual ID of current channel
     const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
 
+    // the source is treated as active until its decoded frame is checked
+    vecSourcePeaks[iChanCnt] = 1;
+
+    // the codec configuration may be changed by the protocol at any time, the tick
+    // only uses the snapshot which is taken here once per tick
+    UpdateCodecConfigSnapshot ( iCurChanID, vecCodecConfigs[iCurChanID], veciCodecConfigVersions[iCurChanID] );
+
     // get and store number of audio channels and compression type
-    vecNumAudioChannels[iChanCnt] = vecChannels[iCurChanID].GetNumAudioChannels();
-    vecAudioComprType[iChanCnt]   = vecChannels[iCurChanID].GetAudioCompressionType();
+    vecNumAudioChannels[iChanCnt] = vecCodecConfigs[iCurChanID].iNumAudioChannels;
+    vecAudioComprType[iChanCnt]   = vecCodecConfigs[iCurChanID].eAudComprType;
 
     // get info about required frame size conversion properties
     vecUseDoubleSysFraSizeConvBuf[iChanCnt] = ( !bUseDoubleSystemFrameSize && ( vecAudioComprType[iChanCnt] == CT_OPUS ) );
@@ -778,63 +1365,138 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
     // update conversion buffer size (nothing will happen if the size stays the same)
     if ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] )
     {
-        DoubleFrameSizeConvBufIn[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
-        DoubleFrameSizeConvBufOut[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
-    }
-
-    // select the opus decoder and raw audio frame length
-    if ( vecAudioComprType[iChanCnt] == CT_OPUS )
-    {
-        iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
-
-        if ( vecNumAudioChannels[iChanCnt] == 1 )
+        if ( bUseFloatPipeline )
         {
-            CurOpusDecoder = OpusDecoderMono[iCurChanID];
+            DoubleFrameSizeConvBufInFloat[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
+            DoubleFrameSizeConvBufOutFloat[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
         }
         else
         {
-            CurOpusDecoder = OpusDecoderStereo[iCurChanID];
+            DoubleFrameSizeConvBufIn[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
+            DoubleFrameSizeConvBufOut[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
         }
     }
-    else if ( vecAudioComprType[iChanCnt] == CT_OPUS64 )
-    {
-        iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
 
-        if ( vecNumAudioChannels[iChanCnt] == 1 )
-        {
-            CurOpusDecoder = Opus64DecoderMono[iCurChanID];
-        }
-        else
-        {
-            CurOpusDecoder = Opus64DecoderStereo[iCurChanID];
-        }
+    // select the raw audio frame length
+    if ( vecAudioComprType[iChanCnt] == CT_OPUS )
+    {
+        iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
     }
-    else
+    else if ( vecAudioComprType[iChanCnt] == CT_OPUS64 )
     {
-        CurOpusDecoder = nullptr;
+        iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
     }
 
+    // get the opus decoder (nullptr if the codec state is not yet prepared)
+    OpusCustomDecoder* CurOpusDecoder = CodecPool.GetDecoder ( iCurChanID, vecAudioComprType[iChanCnt], vecNumAudioChannels[iChanCnt] );
+
     // get gains of all connected channels
+    const int iTargetIdx = pMixMatrixSnapshot->GetIndex ( iCurChanID );
+
     for ( int j = 0; j < iNumClients; j++ )
     {
         // The second index of "vecvecdGains" does not represent
         // the channel ID! Therefore we have to use
         // "vecChanIDsCurConChan" to query the IDs of the currently
         // connected channels
-        vecvecfGains[iChanCnt][j] = vecChannels[iCurChanID].GetGain ( vecChanIDsCurConChan[j] );
+        const int iSourceIdx = pMixMatrixSnapshot->GetIndex ( vecChanIDsCurConChan[j] );
+
+        vecvecfGains[iChanCnt][j] = pMixMatrixSnapshot->GetGain ( iTargetIdx, iSourceIdx );
 
         // consider audio fade-in
-        vecvecfGains[iChanCnt][j] *= vecChannels[vecChanIDsCurConChan[j]].GetFadeInGain();
+        vecvecfGains[iChanCnt][j] *= vecfFadeInGains[j];
 
         // use the fade in of the current channel for all other connected clients
         // as well to avoid the client volumes are at 100% when joining a server (#628)
         if ( j != iChanCnt )
         {
-            vecvecfGains[iChanCnt][j] *= vecChannels[iCurChanID].GetFadeInGain();
+            vecvecfGains[iChanCnt][j] *= vecfFadeInGains[iChanCnt];
         }
 
         // panning
-        vecvecfPannings[iChanCnt][j] = vecChannels[iCurChanID].GetPan ( vecChanIDsCurConChan[j] );
+        vecvecfPannings[iChanCnt][j] = pMixMatrixSnapshot->GetPan ( iTargetIdx, iSourceIdx );
+    }
+
+    // count the sources which deviate from the shared mix bus
+    if ( bUseSharedMixBus )
+    {
+        vecNumMixDeviations[iChanCnt] = 0;
+
+        for ( int j = 0; j < iNumClients; j++ )
+        {
+            if ( IsSharedMixBusDeviation ( iChanCnt, j ) )
+            {
+                vecNumMixDeviations[iChanCnt]++;
+            }
+        }
+    }
+
+    // take over the blocks which were already decoded on arrival (the decode
+    // worker must not use the codec state and the jitter buffer of this
+    // channel until the frame is released)
+    int iNumDecodedBlocks = 0;
+
+    if ( bDecodeOnArrival )
+    {
+        iNumDecodedBlocks = bUseFloatPipeline ? TakeDecodedFrame ( iChanCnt, vecpfData, vecpfArrivalData )
+                                              : TakeDecodedFrame ( iChanCnt, vecpsData, vecpsArrivalData );
+    }
+
+    // hand the packets received since the last tick over to the jitter buffer
+    DrainInboundRing ( iCurChanID );
+
+    // decode the received data
+    if ( bUseFloatPipeline )
+    {
+        DecodeFrames ( iChanCnt,
+                       CurOpusDecoder,
+                       iClientFrameSizeSamples,
+                       vecpfData[iChanCnt],
+                       DoubleFrameSizeConvBufInFloat[iCurChanID],
+                       FloatPlayout[iCurChanID],
+                       iNumDecodedBlocks );
+    }
+    else
+    {
+        DecodeFrames ( iChanCnt,
+                       CurOpusDecoder,
+                       iClientFrameSizeSamples,
+                       vecpsData[iChanCnt],
+                       DoubleFrameSizeConvBufIn[iCurChanID],
+                       Int16Playout[iCurChanID],
+                       iNumDecodedBlocks );
+    }
+
+    if ( bDecodeOnArrival )
+    {
+        ReleaseDecodedFrame ( iCurChanID );
+
+        // the next frame may already be in the jitter buffer
+        pDecodeWorker->Post ( iCurChanID );
+    }
+}
+
+template<typename TSample>
+void CServer::DecodeFrames ( const int                  iChanCnt,
+                             OpusCustomDecoder*         CurOpusDecoder,
+                             const int                  iClientFrameSizeSamples,
+                             TSample*                   pData,
+                             CConvBuf<TSample>&         ConvBufIn,
+                             CAdaptivePlayout<TSample>& Playout,
+                             const int                  iNumDecodedBlocks )
+{
+    int            iUnused;
+    const uint8_t* pCurCodedData;
+
+    // get actual ID of current channel
+    const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
+
+    vecNumTickDecodedBlocks[iChanCnt] = 0;
+
+    if ( CurOpusDecoder == nullptr )
+    {
+        // nothing will be decoded, make sure no old audio data is mixed
+        std::fill_n ( pData, MAX_FRAME_NUM_VALUES, static_cast<TSample> ( 0 ) );
     }
 
     // If the server frame size is smaller than the received OPUS frame size, we need a conversion
@@ -842,16 +1504,31 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
     // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
     // is false and the Get() function is not called at all. Therefore if the buffer is not needed
     // we do not spend any time in the function but go directly inside the if condition.
-    if ( ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] == 0 ) ||
-         !DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecsData[iChanCnt], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] ) )
+    if ( ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] == 0 ) || !ConvBufIn.Get ( pData, SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] ) )
     {
         // get current number of OPUS coded bytes
-        const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetCeltNumCodedBytes();
+        const int iCeltNumCodedBytes = vecCodecConfigs[iCurChanID].iCeltNumCodedBytes;
+
+        // with the adaptive playout the blocks are decoded into the playout buffer
+        // which stretches or compresses the frame (never the case with the
+        // conversion buffer or decode on arrival)
+        const bool bUsePlayout = bUseAdaptivePlayout && ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] == 0 ) && ( iClientFrameSizeSamples > 0 );
+        int        iNumBlocks  = vecNumFrameSizeConvBlocks[iChanCnt];
+
+        if ( bUsePlayout )
+        {
+            Playout.SetFormat ( vecNumAudioChannels[iChanCnt], iServerFrameSizeSamples, iClientFrameSizeSamples );
+            iNumBlocks = Playout.PrepareFrame ( vecChannels[iCurChanID].GetSockBufFillLevel() );
+        }
 
-        for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[iChanCnt]; iB++ )
+        // the blocks decoded on arrival are skipped (never the case with the conversion buffer)
+        for ( int iB = iNumDecodedBlocks; iB < iNumBlocks; iB++ )
         {
-            // get data
-            const EGetDataStat eGetStat = vecChannels[iCurChanID].GetData ( vecvecbyCodedData[iChanCnt], iCeltNumCodedBytes );
+            vecNumTickDecodedBlocks[iChanCnt]++;
+
+            // get data (the coded data is decoded directly from the jitter buffer)
+            const uint8_t*     pbyCodedData;
+            const EGetDataStat eGetStat = vecChannels[iCurChanID].GetData ( pbyCodedData, iCeltNumCodedBytes );
 
             // if channel was just disconnected, set flag that connected
             // client list is sent to all other clients
@@ -860,11 +1537,16 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
             {
                 if ( JamController.GetRecordingEnabled() )
                 {
-                    emit ClientDisconnected ( iCurChanID ); // TODO do this outside the mutex lock?
+                    emit ClientDisconnected ( iCurChanID );
                 }
 
                 FreeChannel ( iCurChanID ); // note that the channel is now not in use
 
+                // the channel is still mixed in this tick, make sure no old audio data is used
+                std::fill_n ( pData, MAX_FRAME_NUM_VALUES, static_cast<TSample> ( 0 ) );
+                vecSourcePeaks[iChanCnt]   = 0;
+                vecdTalkerLevels[iChanCnt] = 0; // not selected as a top talker
+
                 // note that no mutex is needed for this shared resource since it is not a
                 // read-modify-write operation but an atomic write and also each thread can
                 // only set it to true and never to false
@@ -877,7 +1559,7 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
             // get pointer to coded data
             if ( eGetStat == GS_BUFFER_OK )
             {
-                pCurCodedData = &vecvecbyCodedData[iChanCnt][0];
+                pCurCodedData = pbyCodedData;
             }
             else
             {
@@ -886,15 +1568,43 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
             }
 
             // OPUS decode received data stream
-            if ( CurOpusDecoder != nullptr )
+            if ( bUsePlayout )
+            {
+                TSample* pBlockData = Playout.GetBlockWritePtr();
+
+                if ( CurOpusDecoder != nullptr )
+                {
+                    iUnused = OpusCustomDecode ( CurOpusDecoder, pCurCodedData, iCeltNumCodedBytes, pBlockData, iClientFrameSizeSamples );
+                }
+                else
+                {
+                    std::fill_n ( pBlockData, iClientFrameSizeSamples * vecNumAudioChannels[iChanCnt], static_cast<TSample> ( 0 ) );
+                }
+
+                Playout.BlockWritten();
+            }
+            else if ( CurOpusDecoder != nullptr )
             {
                 const int iOffset = iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt];
 
-                iUnused = opus_custom_decode ( CurOpusDecoder,
-                                               pCurCodedData,
-                                               iCeltNumCodedBytes,
-                                               &vecvecsData[iChanCnt][iOffset],
-                                               iClientFrameSizeSamples );
+                iUnused = OpusCustomDecode ( CurOpusDecoder, pCurCodedData, iCeltNumCodedBytes, &pData[iOffset], iClientFrameSizeSamples );
+            }
+        }
+
+        if ( bUsePlayout )
+        {
+            switch ( Playout.GetFrame ( pData ) )
+            {
+            case CAdaptivePlayout<TSample>::PO_COMPRESS:
+                iPlayoutCompressedTotal.fetch_add ( 1, std::memory_order_relaxed );
+                break;
+
+            case CAdaptivePlayout<TSample>::PO_STRETCH:
+                iPlayoutStretchedTotal.fetch_add ( 1, std::memory_order_relaxed );
+                break;
+
+            default:
+                break;
             }
         }
 
@@ -902,285 +1612,692 @@ void CServer::DecodeReceiveData ( const int iChanCnt, const int iNumClients )
         // and read out the small frame size immediately for further processing
         if ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] != 0 )
         {
-            DoubleFrameSizeConvBufIn[iCurChanID].PutAll ( vecvecsData[iChanCnt] );
-            DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecsData[iChanCnt], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
+            ConvBufIn.PutAll ( pData );
+            ConvBufIn.Get ( pData, SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
+        }
+    }
+
+    // get the peak of the decoded frame once so that the mixer can skip silent sources
+    vecSourcePeaks[iChanCnt] = GetFramePeak ( pData, iServerFrameSizeSamples * vecNumAudioChannels[iChanCnt] );
+
+    // update the short-term level used for the talker ranking
+    if ( iMaxNumTopTalkers > 0 )
+    {
+        CStereoSignalLevelMeter& TalkerLevelMeter = vecTalkerLevelMeters[iCurChanID];
+
+        TalkerLevelMeter.Update ( pData, iServerFrameSizeSamples, vecNumAudioChannels[iChanCnt] > 1 );
+        vecdTalkerLevels[iChanCnt] = TalkerLevelMeter.GetLevelForMeterdBLeftOrMono();
+    }
+
+    Q_UNUSED ( iUnused )
+}
+
+void CServer::DecodeFrameOnArrival ( const int iChanID )
+{
+    CChannel&      Channel = vecChannels[iChanID];
+    SDecodedFrame& Frame   = vecDecodedFrames[iChanID];
+
+    if ( !Channel.IsConnected() )
+    {
+        return;
+    }
+
+    // only an empty or partially decoded frame is continued (a ready frame is
+    // not yet used by the tick and during the tick the channel is locked)
+    int iState = DF_EMPTY;
+
+    if ( !Frame.iState.compare_exchange_strong ( iState, DF_BUSY, std::memory_order_acquire ) )
+    {
+        return;
+    }
+
+    // the tick does not access the inbound ring of this channel while the frame is busy
+    DrainInboundRing ( iChanID );
+
+    // the decode worker uses its own snapshot of the codec configuration, the
+    // tick drops the frame if it was decoded with a different format
+    UpdateCodecConfigSnapshot ( iChanID, Frame.CodecConfig, Frame.iCodecConfigVersion );
+
+    const EAudComprType eAudioCompressionType   = Frame.CodecConfig.eAudComprType;
+    const int           iNumAudioChannels       = Frame.CodecConfig.iNumAudioChannels;
+    int                 iNumBlocks              = 0; // not supported
+    int                 iClientFrameSizeSamples = 0;
+
+    // frames which need the conversion buffer are always decoded in the tick
+    if ( eAudioCompressionType == CT_OPUS64 )
+    {
+        iNumBlocks              = bUseDoubleSystemFrameSize ? 2 : 1;
+        iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+    else if ( ( eAudioCompressionType == CT_OPUS ) && bUseDoubleSystemFrameSize )
+    {
+        iNumBlocks              = 1;
+        iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+
+    OpusCustomDecoder* CurOpusDecoder = CodecPool.GetDecoder ( iChanID, eAudioCompressionType, iNumAudioChannels );
+
+    // a partially decoded frame of a different format cannot be continued
+    if ( ( Frame.iNumBlocks > 0 ) &&
+         ( ( Frame.eAudioCompressionType != eAudioCompressionType ) || ( Frame.iNumAudioChannels != iNumAudioChannels ) ) )
+    {
+        Frame.iNumBlocks = 0;
+    }
+
+    if ( ( iNumBlocks > 0 ) && ( CurOpusDecoder != nullptr ) )
+    {
+        QElapsedTimer DecodeTimer;
+        DecodeTimer.start();
+
+        const int iCeltNumCodedBytes = Frame.CodecConfig.iCeltNumCodedBytes;
+        int       iNumNewBlocks      = 0;
+
+        Frame.eAudioCompressionType = eAudioCompressionType;
+        Frame.iNumAudioChannels     = iNumAudioChannels;
+
+        // decode the blocks which were received directly from the jitter buffer,
+        // a missing block is left to the tick
+        const uint8_t* pbyCodedData;
+
+        while ( ( Frame.iNumBlocks < iNumBlocks ) && Channel.GetReceivedData ( pbyCodedData, iCeltNumCodedBytes ) )
+        {
+            const int iOffset = Frame.iNumBlocks * SYSTEM_FRAME_SIZE_SAMPLES * iNumAudioChannels;
+
+            if ( bUseFloatPipeline )
+            {
+                OpusCustomDecode ( CurOpusDecoder,
+                                   pbyCodedData,
+                                   iCeltNumCodedBytes,
+                                   &vecpfArrivalData[iChanID][iOffset],
+                                   iClientFrameSizeSamples );
+            }
+            else
+            {
+                OpusCustomDecode ( CurOpusDecoder,
+                                   pbyCodedData,
+                                   iCeltNumCodedBytes,
+                                   &vecpsArrivalData[iChanID][iOffset],
+                                   iClientFrameSizeSamples );
+            }
+
+            Frame.iNumBlocks++;
+            iNumNewBlocks++;
+        }
+
+        if ( iNumNewBlocks > 0 )
+        {
+            iArrivalDecodedBlocksTotal += iNumNewBlocks;
+            iArrivalDecodeTimeNsTotal += DecodeTimer.nsecsElapsed();
+        }
+    }
+
+    // hand the frame over to the tick
+    Frame.iState.store ( ( ( iNumBlocks > 0 ) && ( Frame.iNumBlocks == iNumBlocks ) ) ? DF_READY : DF_EMPTY, std::memory_order_release );
+}
+
+void CServer::UpdateCodecConfigSnapshot ( const int iChanID, CCodecConfig& CodecConfig, int& iCodecConfigVersion )
+{
+    // the configuration is only copied (under the channel mutex) if it has changed
+    if ( vecChannels[iChanID].GetCodecConfigVersion() != iCodecConfigVersion )
+    {
+        iCodecConfigVersion = vecChannels[iChanID].GetCodecConfig ( CodecConfig );
+    }
+}
+
+void CServer::LockDecodedFrame ( const int iChanID )
+{
+    std::atomic<int>& iState = vecDecodedFrames[iChanID].iState;
+
+    // wait for the decode worker if it is just decoding a block of this channel
+    for ( ;; )
+    {
+        int iCurState = iState.load ( std::memory_order_relaxed );
+
+        if ( ( iCurState != DF_BUSY ) && iState.compare_exchange_weak ( iCurState, DF_TICK, std::memory_order_acquire ) )
+        {
+            return;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+void CServer::ReleaseDecodedFrame ( const int iChanID )
+{
+    // the frame is consumed, the decode worker may decode the next one
+    vecDecodedFrames[iChanID].iState.store ( DF_EMPTY, std::memory_order_release );
+}
+
+template<typename TSample>
+int CServer::TakeDecodedFrame ( const int iChanCnt, CVector<TSample*>& vecpData, CVector<TSample*>& vecpArrivalData )
+{
+    // get actual ID of current channel
+    const int      iCurChanID = vecChanIDsCurConChan[iChanCnt];
+    SDecodedFrame& Frame      = vecDecodedFrames[iCurChanID];
+
+    LockDecodedFrame ( iCurChanID );
+
+    int iNumDecodedBlocks = Frame.iNumBlocks;
+    Frame.iNumBlocks      = 0;
+
+    // the blocks are dropped if the format has changed in the meantime
+    if ( ( Frame.eAudioCompressionType != vecAudioComprType[iChanCnt] ) || ( Frame.iNumAudioChannels != vecNumAudioChannels[iChanCnt] ) ||
+         ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] != 0 ) )
+    {
+        iNumDecodedBlocks = 0;
+    }
+
+    // the decoded frame becomes the current frame, the previous current frame
+    // is used for the next decoding on arrival
+    if ( iNumDecodedBlocks > 0 )
+    {
+        std::swap ( vecpData[iChanCnt], vecpArrivalData[iCurChanID] );
+    }
+
+    return iNumDecodedBlocks;
+}
+
+/// @brief Mix all audio data from all clients together, encode and transmit
+void CServer::MixEncodeTransmitData ( const int iChanCnt, const int iNumClients )
+{
+    // get actual ID of current channel
+    const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
+
+    // the send frame is only used during this call, it is taken from the scratch of the current thread
+    const int iScratchIdx = GetScratchIdx ( iChanCnt );
+
+    if ( bUseFloatPipeline )
+    {
+        MixEncodeTransmitFrames ( iChanCnt,
+                                  iNumClients,
+                                  vecpfData,
+                                  vecpfPrevData,
+                                  FloatSendScratch[iScratchIdx],
+                                  DoubleFrameSizeConvBufOutFloat[iCurChanID] );
+    }
+    else
+    {
+        MixEncodeTransmitFrames ( iChanCnt,
+                                  iNumClients,
+                                  vecpsData,
+                                  vecpsPrevData,
+                                  Int16SendScratch[iScratchIdx],
+                                  DoubleFrameSizeConvBufOut[iCurChanID] );
+    }
+}
+
+template<typename TSample>
+void CServer::MixEncodeTransmitFrames ( const int                iChanCnt,
+                                        const int                iNumClients,
+                                        const CVector<TSample*>& vecpData,
+                                        const CVector<TSample*>& vecpPrevData,
+                                        TSample*                 pSendData,
+                                        CConvBuf<TSample>&       ConvBufOut )
+{
+    int    j, iUnused;
+    float* pfMix = MixScratch[GetScratchIdx ( iChanCnt )]; // the mix is accumulated in the scratch of the current thread
+
+    // the coded data buffer of the current thread
+    CVector<uint8_t>& vecbyCodedData = vecvecbyCodedData[GetScratchIdx ( iChanCnt )];
+
+    // get the mixing kernels for the sample type of the frames
+    const CMixKernels::CAccumKernels<TSample>& Accum = MixKernels.Accum<TSample>();
+
+    // get actual ID of current channel
+    const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
+
+    // init intermediate processing vector with zeros since we mix all channels on that vector
+    std::fill_n ( pfMix, MAX_FRAME_NUM_VALUES, 0.0f );
+
+    // distinguish between shared bus, stereo and mono mode
+    if ( vecUseSharedMixBus[iChanCnt] )
+    {
+        // Shared mix bus ------------------------------------------------------
+        MixFromSharedMixBus ( iChanCnt, iNumClients, vecpData );
+    }
+    else if ( vecNumAudioChannels[iChanCnt] == 1 )
+    {
+        // Mono target channel -------------------------------------------------
+        const int iNumActiveSources = CreateActiveSourceList ( iChanCnt, iNumClients );
+
+        for ( int iActCnt = 0; iActCnt < iNumActiveSources; iActCnt++ )
+        {
+            j = vecvecActiveSources[iChanCnt][iActCnt];
+
+            // get a pointer to the audio data and gain of the current client
+            const TSample* pData = vecpData[j];
+            const float    fGain = vecvecfGains[iChanCnt][j];
+
+            // note that a gain of 1 does not need a special case, the
+            // multiplication is exact and the vectorized kernels are fast
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                // mono
+                Accum.MonoToMono ( pfMix, pData, iServerFrameSizeSamples, fGain );
+            }
+            else
+            {
+                // stereo: apply stereo-to-mono attenuation
+                Accum.StereoToMono ( pfMix, pData, iServerFrameSizeSamples, fGain );
+            }
+        }
+    }
+    else
+    {
+        // Stereo target channel -----------------------------------------------
+
+        const int  maxPanDelay     = MAX_DELAY_PANNING_SAMPLES;
+        const bool bCurUseDelayPan = bDelayPan; // the setting may be changed by the main thread
+
+        const int iNumActiveSources = CreateActiveSourceList ( iChanCnt, iNumClients );
+
+        for ( int iActCnt = 0; iActCnt < iNumActiveSources; iActCnt++ )
+        {
+            j = vecvecActiveSources[iChanCnt][iActCnt];
+
+            // get a pointer to the audio data and gain/pan of the current client
+            const TSample* pData = vecpData[j];
+
+            const float fGain = vecvecfGains[iChanCnt][j];
+            const float fPan  = bCurUseDelayPan ? 0.5f : vecvecfPannings[iChanCnt][j];
+
+            // calculate combined gain/pan for each stereo channel where we define
+            // the panning that center equals full gain for both channels
+            const float fGainL = MathUtils::GetLeftPan ( fPan, false ) * fGain;
+            const float fGainR = MathUtils::GetRightPan ( fPan, false ) * fGain;
+
+            if ( !bCurUseDelayPan )
+            {
+                // no address shift, use the vectorized kernels
+                if ( vecNumAudioChannels[j] == 1 )
+                {
+                    // mono: copy same mono data in both out stereo audio channels
+                    Accum.MonoToStereo ( pfMix, pData, iServerFrameSizeSamples, fGainL, fGainR );
+                }
+                else
+                {
+                    // stereo
+                    Accum.StereoToStereo ( pfMix, pData, iServerFrameSizeSamples, fGainL, fGainR );
+                }
+
+                continue;
+            }
+
+            // pan address shift, the delayed samples are taken from the previous frame
+            const int iPanDel  = lround ( (float) ( 2 * maxPanDelay - 2 ) * ( vecvecfPannings[iChanCnt][j] - 0.5f ) );
+            const int iPanDelL = ( iPanDel > 0 ) ? iPanDel : 0;
+            const int iPanDelR = ( iPanDel < 0 ) ? -iPanDel : 0;
+
+            // select the specialised kernel once per source
+            CMixKernels::TDelayPanFct<TSample> DelayPanToStereo;
+
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                // mono: copy same mono data in both out stereo audio channels
+                DelayPanToStereo =
+                    ( fGain == 1 ) ? CMixKernels::DelayPanToStereo<TSample, 1, true> : CMixKernels::DelayPanToStereo<TSample, 1, false>;
+            }
+            else
+            {
+                // stereo
+                DelayPanToStereo =
+                    ( fGain == 1 ) ? CMixKernels::DelayPanToStereo<TSample, 2, true> : CMixKernels::DelayPanToStereo<TSample, 2, false>;
+            }
+
+            DelayPanToStereo ( pfMix,
+                               pData,
+                               vecpPrevData[vecChanIDsCurConChan[j]],
+                               iServerFrameSizeSamples,
+                               iPanDelL,
+                               iPanDelR,
+                               fGainL,
+                               fGainR );
+        }
+    }
+
+    // convert the mix to the sample type of the encoder with clipping
+    StoreMix ( pSendData, pfMix, iServerFrameSizeSamples * vecNumAudioChannels[iChanCnt] );
+
+    int iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
+
+    // get current number of CELT coded bytes
+    const int iCeltNumCodedBytes = vecCodecConfigs[iCurChanID].iCeltNumCodedBytes;
+
+    // select the raw audio frame length
+    if ( vecAudioComprType[iChanCnt] == CT_OPUS )
+    {
+        iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+    else if ( vecAudioComprType[iChanCnt] == CT_OPUS64 )
+    {
+        iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+
+    // get the opus encoder (nullptr if the codec state is not yet prepared)
+    OpusCustomEncoder* pCurOpusEncoder = CodecPool.GetEncoder ( iCurChanID, vecAudioComprType[iChanCnt], vecNumAudioChannels[iChanCnt] );
+
+    // If the server frame size is smaller than the received OPUS frame size, we need a conversion
+    // buffer which stores the large buffer.
+    // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
+    // is false and the Get() function is not called at all. Therefore if the buffer is not needed
+    // we do not spend any time in the function but go directly inside the if condition.
+    if ( ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] == 0 ) ||
+         ConvBufOut.Put ( pSendData, SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] ) )
+    {
+        if ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] != 0 )
+        {
+            // get the large frame from the conversion buffer
+            ConvBufOut.GetAll ( pSendData, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
+        }
+
+        // OPUS encoding
+        if ( pCurOpusEncoder != nullptr )
+        {
+            // the encoder settings (bit rate, etc.) are only applied if the
+            // negotiated network transport properties have changed
+            const int iCodecConfigVersion = veciCodecConfigVersions[iCurChanID];
+
+            if ( !CodecPool.IsConfigApplied ( iCurChanID, vecAudioComprType[iChanCnt], vecNumAudioChannels[iChanCnt], iCodecConfigVersion ) )
+            {
+                CodecPool.ApplyConfig ( iCurChanID, vecCodecConfigs[iCurChanID], iCodecConfigVersion );
+            }
+
+            for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[iChanCnt]; iB++ )
+            {
+                const int iOffset = iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt];
+
+                iUnused = OpusCustomEncode ( pCurOpusEncoder,
+                                             &pSendData[iOffset],
+                                             iClientFrameSizeSamples,
+                                             &vecbyCodedData[0],
+                                             iCeltNumCodedBytes );
+
+                // send separate mix to current clients, the packets of the current thread are batched
+                if ( veciSendSockAddrLen[iCurChanID] > 0 )
+                {
+                    vecChannels[iCurChanID].PrepAndSendPacket ( &Socket,
+                                                                vecSendBatches[GetScratchIdx ( iChanCnt )],
+                                                                vecbyCodedData,
+                                                                iCeltNumCodedBytes,
+                                                                vecSendSockAddr[iCurChanID],
+                                                                veciSendSockAddrLen[iCurChanID] );
+                }
+                else
+                {
+                    vecChannels[iCurChanID].PrepAndSendPacket ( &Socket, vecbyCodedData, iCeltNumCodedBytes );
+                }
+            }
         }
     }
 
-    Q_UNUSED ( iUnused )
+    Q_UNUSED ( iUnused )
+}
+
+void CServer::SelectTopTalkers ( const int iNumClients )
+{
+    // the hysteresis in units of the level meter
+    const double dHysteresis = TOP_TALKERS_HYSTERESIS_DB * NUM_STEPS_LED_BAR / ( UPPER_BOUND_SIG_METER - LOW_BOUND_SIG_METER );
+
+    // The current top talkers get an advantage so that a new candidate must be
+    // clearly louder to replace one of them. This avoids that the mix switches
+    // back and forth between sources with similar levels.
+    for ( int j = 0; j < iNumClients; j++ )
+    {
+        vecdTalkerScores[j] = vecdTalkerLevels[j];
+
+        if ( vecIsTopTalker[vecChanIDsCurConChan[j]] )
+        {
+            vecdTalkerScores[j] += dHysteresis;
+        }
+
+        vecTalkerRanking[j] = j;
+    }
+
+    const int iNumRanked = std::min ( iMaxNumTopTalkers, iNumClients );
+
+    std::partial_sort ( vecTalkerRanking.begin(),
+                        vecTalkerRanking.begin() + iNumRanked,
+                        vecTalkerRanking.begin() + iNumClients,
+                        [this] ( const int a, const int b ) { return vecdTalkerScores[a] > vecdTalkerScores[b]; } );
+
+    for ( int j = 0; j < iNumClients; j++ )
+    {
+        vecIsTopTalker[vecChanIDsCurConChan[j]] = 0;
+    }
+
+    // sources below the range of the level meter are not selected
+    iNumTopTalkers = 0;
+
+    for ( int i = 0; i < iNumRanked; i++ )
+    {
+        const int j = vecTalkerRanking[i];
+
+        if ( vecdTalkerLevels[j] > 0 )
+        {
+            vecIsTopTalker[vecChanIDsCurConChan[j]] = 1;
+            vecTopTalkers[iNumTopTalkers++]         = j;
+        }
+    }
+}
+
+int CServer::CreateActiveSourceList ( const int iChanCnt, const int iNumClients )
+{
+    int* piActiveSources   = vecvecActiveSources[iChanCnt];
+    int  iNumActiveSources = 0;
+
+    // Only sources with a non-zero gain which are not digital silence
+    // contribute to the mix. With delay panning, the previous frame of a
+    // silent source may still be audible, therefore only the gain is checked.
+    if ( iMaxNumTopTalkers > 0 )
+    {
+        // top talkers mode: only consider the own channel and the top talkers
+        if ( ( vecvecfGains[iChanCnt][iChanCnt] != 0 ) && ( bDelayPan || ( vecSourcePeaks[iChanCnt] > 0 ) ) )
+        {
+            piActiveSources[iNumActiveSources++] = iChanCnt;
+        }
+
+        for ( int i = 0; i < iNumTopTalkers; i++ )
+        {
+            const int j = vecTopTalkers[i];
+
+            if ( ( j != iChanCnt ) && ( vecvecfGains[iChanCnt][j] != 0 ) && ( bDelayPan || ( vecSourcePeaks[j] > 0 ) ) )
+            {
+                piActiveSources[iNumActiveSources++] = j;
+            }
+        }
+    }
+    else
+    {
+        for ( int j = 0; j < iNumClients; j++ )
+        {
+            if ( ( vecvecfGains[iChanCnt][j] != 0 ) && ( bDelayPan || ( vecSourcePeaks[j] > 0 ) ) )
+            {
+                piActiveSources[iNumActiveSources++] = j;
+            }
+        }
+    }
+
+    vecNumSkippedMixPairs[iChanCnt] = iNumClients - iNumActiveSources;
+
+    return iNumActiveSources;
+}
+
+void CServer::GetSharedMixBusCorrection ( const int iChanCnt, const int j, float& fCorrL, float& fCorrR ) const
+{
+    // the shared buses contain all sources with their fade-in gain, the bus is
+    // scaled with the fade-in gain of the target (the own signal of the target
+    // is corrected like any other source)
+    const float fGain    = vecvecfGains[iChanCnt][j];
+    const float fBusGain = vecfFadeInGains[iChanCnt] * vecfFadeInGains[j];
+
+    if ( vecNumAudioChannels[iChanCnt] == 1 )
+    {
+        fCorrL = fGain - fBusGain;
+        fCorrR = fCorrL;
+    }
+    else
+    {
+        // the shared stereo bus uses center panning
+        const float fPan = vecvecfPannings[iChanCnt][j];
+
+        fCorrL = MathUtils::GetLeftPan ( fPan, false ) * fGain - fBusGain;
+        fCorrR = MathUtils::GetRightPan ( fPan, false ) * fGain - fBusGain;
+    }
 }
 
-/// @brief Mix all audio data from all clients together, encode and transmit
-void CServer::MixEncodeTransmitData ( const int iChanCnt, const int iNumClients )
+bool CServer::IsSharedMixBusDeviation ( const int iChanCnt, const int j ) const
 {
-    int               i, j, k, iUnused;
-    CVector<float>&   vecfIntermProcBuf = vecvecfIntermediateProcBuf[iChanCnt]; // use reference for faster access
-    CVector<int16_t>& vecsSendData      = vecvecsSendData[iChanCnt];            // use reference for faster access
+    float fCorrL, fCorrR;
 
-    // get actual ID of current channel
-    const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
+    GetSharedMixBusCorrection ( iChanCnt, j, fCorrL, fCorrR );
 
-    // init intermediate processing vector with zeros since we mix all channels on that vector
-    vecfIntermProcBuf.Reset ( 0 );
+    return ( fCorrL != 0 ) || ( fCorrR != 0 );
+}
 
-    // distinguish between stereo and mono mode
-    if ( vecNumAudioChannels[iChanCnt] == 1 )
+template<typename TSample>
+void CServer::CreateSharedMixBuses ( const int iNumClients, const CVector<TSample*>& vecpData )
+{
+    const CMixKernels::CAccumKernels<TSample>& Accum = MixKernels.Accum<TSample>();
+
+    bool bMonoBusNeeded   = false;
+    bool bStereoBusNeeded = false;
+
+    // Only use the shared bus for a target if it needs less corrections than
+    // half the number of sources, otherwise the full mix is cheaper. The
+    // delay panning cannot be expressed as a gain correction, therefore the
+    // shared bus is not used in that case.
+    for ( int iChanCnt = 0; iChanCnt < iNumClients; iChanCnt++ )
     {
-        // Mono target channel -------------------------------------------------
-        for ( j = 0; j < iNumClients; j++ )
-        {
-            // get a reference to the audio data and gain of the current client
-            const CVector<int16_t>& vecsData = vecvecsData[j];
-            const float             fGain    = vecvecfGains[iChanCnt][j];
+        vecUseSharedMixBus[iChanCnt] = !bDelayPan && ( 2 * vecNumMixDeviations[iChanCnt] < iNumClients );
 
-            // if channel gain is 1, avoid multiplication for speed optimization
-            if ( fGain == 1.0f )
+        if ( vecUseSharedMixBus[iChanCnt] )
+        {
+            if ( vecNumAudioChannels[iChanCnt] == 1 )
             {
-                if ( vecNumAudioChannels[j] == 1 )
-                {
-                    // mono
-                    for ( i = 0; i < iServerFrameSizeSamples; i++ )
-                    {
-                        vecfIntermProcBuf[i] += vecsData[i];
-                    }
-                }
-                else
-                {
-                    // stereo: apply stereo-to-mono attenuation
-                    for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                    {
-                        vecfIntermProcBuf[i] += ( static_cast<float> ( vecsData[k] ) + vecsData[k + 1] ) / 2;
-                    }
-                }
+                bMonoBusNeeded = true;
             }
             else
             {
-                if ( vecNumAudioChannels[j] == 1 )
-                {
-                    // mono
-                    for ( i = 0; i < iServerFrameSizeSamples; i++ )
-                    {
-                        vecfIntermProcBuf[i] += vecsData[i] * fGain;
-                    }
-                }
-                else
-                {
-                    // stereo: apply stereo-to-mono attenuation
-                    for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                    {
-                        vecfIntermProcBuf[i] += fGain * ( static_cast<float> ( vecsData[k] ) + vecsData[k + 1] ) / 2;
-                    }
-                }
+                bStereoBusNeeded = true;
             }
         }
-
-        // convert from double to short with clipping
-        for ( i = 0; i < iServerFrameSizeSamples; i++ )
-        {
-            vecsSendData[i] = Float2Short ( vecfIntermProcBuf[i] );
-        }
     }
-    else
-    {
-        // Stereo target channel -----------------------------------------------
-
-        const int maxPanDelay = MAX_DELAY_PANNING_SAMPLES;
 
-        int iPanDelL = 0, iPanDelR = 0, iPanDel;
-        int iLpan, iRpan, iPan;
+    if ( bMonoBusNeeded )
+    {
+        SharedMixBusMono.Reset ( 0, 0.0f );
 
-        for ( j = 0; j < iNumClients; j++ )
+        for ( int j = 0; j < iNumClients; j++ )
         {
-            // get a reference to the audio data and gain/pan of the current client
-            const CVector<int16_t>& vecsData  = vecvecsData[j];
-            const CVector<int16_t>& vecsData2 = vecvecsData2[j];
-
-            const float fGain = vecvecfGains[iChanCnt][j];
-            const float fPan  = bDelayPan ? 0.5f : vecvecfPannings[iChanCnt][j];
-
-            // calculate combined gain/pan for each stereo channel where we define
-            // the panning that center equals full gain for both channels
-            const float fGainL = MathUtils::GetLeftPan ( fPan, false ) * fGain;
-            const float fGainR = MathUtils::GetRightPan ( fPan, false ) * fGain;
-
-            if ( bDelayPan )
+            if ( vecSourcePeaks[j] == 0 )
             {
-                iPanDel  = lround ( (float) ( 2 * maxPanDelay - 2 ) * ( vecvecfPannings[iChanCnt][j] - 0.5f ) );
-                iPanDelL = ( iPanDel > 0 ) ? iPanDel : 0;
-                iPanDelR = ( iPanDel < 0 ) ? -iPanDel : 0;
+                continue; // silent sources do not contribute
             }
 
             if ( vecNumAudioChannels[j] == 1 )
             {
-                // mono: copy same mono data in both out stereo audio channels
-                for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                {
-                    // left/right channel
-                    if ( bDelayPan )
-                    {
-                        // pan address shift
-
-                        // left channel
-                        iLpan = i - iPanDelL;
-                        if ( iLpan < 0 )
-                        {
-                            // get from second
-                            iLpan = iLpan + iServerFrameSizeSamples;
-                            vecfIntermProcBuf[k] += vecsData2[iLpan] * fGainL;
-                        }
-                        else
-                        {
-                            vecfIntermProcBuf[k] += vecsData[iLpan] * fGainL;
-                        }
-
-                        // right channel
-                        iRpan = i - iPanDelR;
-                        if ( iRpan < 0 )
-                        {
-                            // get from second
-                            iRpan = iRpan + iServerFrameSizeSamples;
-                            vecfIntermProcBuf[k + 1] += vecsData2[iRpan] * fGainR;
-                        }
-                        else
-                        {
-                            vecfIntermProcBuf[k + 1] += vecsData[iRpan] * fGainR;
-                        }
-                    }
-                    else
-                    {
-                        vecfIntermProcBuf[k] += vecsData[i] * fGainL;
-                        vecfIntermProcBuf[k + 1] += vecsData[i] * fGainR;
-                    }
-                }
+                Accum.MonoToMono ( SharedMixBusMono[0], vecpData[j], iServerFrameSizeSamples, vecfFadeInGains[j] );
             }
             else
             {
-                // stereo
-                for ( i = 0; i < ( 2 * iServerFrameSizeSamples ); i++ )
-                {
-                    // left/right channel
-                    if ( bDelayPan )
-                    {
-                        // pan address shift
-                        if ( ( i & 1 ) == 0 )
-                        {
-                            iPan = i - 2 * iPanDelL; // if even : left channel
-                        }
-                        else
-                        {
-                            iPan = i - 2 * iPanDelR; // if odd  : right channel
-                        }
-                        // interleaved channels
-                        if ( iPan < 0 )
-                        {
-                            // get from second
-                            iPan = iPan + 2 * iServerFrameSizeSamples;
-                            vecfIntermProcBuf[i] += vecsData2[iPan] * fGain;
-                        }
-                        else
-                        {
-                            vecfIntermProcBuf[i] += vecsData[iPan] * fGain;
-                        }
-                    }
-                    else
-                    {
-                        if ( ( i & 1 ) == 0 )
-                        {
-                            // if even : left channel
-                            vecfIntermProcBuf[i] += vecsData[i] * fGainL;
-                        }
-                        else
-                        {
-                            // if odd  : right channel
-                            vecfIntermProcBuf[i] += vecsData[i] * fGainR;
-                        }
-                    }
-                }
+                Accum.StereoToMono ( SharedMixBusMono[0], vecpData[j], iServerFrameSizeSamples, vecfFadeInGains[j] );
             }
         }
+    }
+
+    if ( bStereoBusNeeded )
+    {
+        SharedMixBusStereo.Reset ( 0, 0.0f );
 
-        // convert from double to short with clipping
-        for ( i = 0; i < ( 2 * iServerFrameSizeSamples ); i++ )
+        for ( int j = 0; j < iNumClients; j++ )
         {
-            vecsSendData[i] = Float2Short ( vecfIntermProcBuf[i] );
+            if ( vecSourcePeaks[j] == 0 )
+            {
+                continue; // silent sources do not contribute
+            }
+
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                Accum.MonoToStereo ( SharedMixBusStereo[0],
+                                     vecpData[j],
+                                     iServerFrameSizeSamples,
+                                     vecfFadeInGains[j],
+                                     vecfFadeInGains[j] );
+            }
+            else
+            {
+                Accum.StereoToStereo ( SharedMixBusStereo[0],
+                                       vecpData[j],
+                                       iServerFrameSizeSamples,
+                                       vecfFadeInGains[j],
+                                       vecfFadeInGains[j] );
+            }
         }
     }
+}
 
-    int                iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
-    OpusCustomEncoder* pCurOpusEncoder         = nullptr;
+template<typename TSample>
+void CServer::MixFromSharedMixBus ( const int iChanCnt, const int iNumClients, const CVector<TSample*>& vecpData )
+{
+    float* pfMix = MixScratch[GetScratchIdx ( iChanCnt )]; // use the mix scratch of the current thread
 
-    // get current number of CELT coded bytes
-    const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetCeltNumCodedBytes();
+    const CMixKernels::CAccumKernels<TSample>& Accum = MixKernels.Accum<TSample>();
 
-    // select the opus encoder and raw audio frame length
-    if ( vecAudioComprType[iChanCnt] == CT_OPUS )
-    {
-        iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    const bool   bIsMono     = ( vecNumAudioChannels[iChanCnt] == 1 );
+    const int    iNumValues  = bIsMono ? iServerFrameSizeSamples : 2 * iServerFrameSizeSamples;
+    const float* pfBus       = bIsMono ? SharedMixBusMono[0] : SharedMixBusStereo[0];
+    const float  fTargetGain = vecfFadeInGains[iChanCnt];
 
-        if ( vecNumAudioChannels[iChanCnt] == 1 )
-        {
-            pCurOpusEncoder = OpusEncoderMono[iCurChanID];
-        }
-        else
-        {
-            pCurOpusEncoder = OpusEncoderStereo[iCurChanID];
-        }
+    // start with the shared bus
+    for ( int i = 0; i < iNumValues; i++ )
+    {
+        pfMix[i] = fTargetGain * pfBus[i];
     }
-    else if ( vecAudioComprType[iChanCnt] == CT_OPUS64 )
+
+    // apply the per-pair deviations from the shared bus (silent sources are
+    // not part of the bus and need no correction), a pair which is served by
+    // the bus is still mixed, only muted and silent sources are skipped pairs
+    vecNumSkippedMixPairs[iChanCnt] = 0;
+
+    for ( int j = 0; j < iNumClients; j++ )
     {
-        iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+        float fCorrL, fCorrR;
 
-        if ( vecNumAudioChannels[iChanCnt] == 1 )
+        if ( ( vecvecfGains[iChanCnt][j] == 0 ) || ( vecSourcePeaks[j] == 0 ) )
         {
-            pCurOpusEncoder = Opus64EncoderMono[iCurChanID];
+            vecNumSkippedMixPairs[iChanCnt]++;
         }
-        else
+
+        GetSharedMixBusCorrection ( iChanCnt, j, fCorrL, fCorrR );
+
+        if ( ( ( fCorrL == 0 ) && ( fCorrR == 0 ) ) || ( vecSourcePeaks[j] == 0 ) )
         {
-            pCurOpusEncoder = Opus64EncoderStereo[iCurChanID];
+            continue;
         }
-    }
 
-    // If the server frame size is smaller than the received OPUS frame size, we need a conversion
-    // buffer which stores the large buffer.
-    // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
-    // is false and the Get() function is not called at all. Therefore if the buffer is not needed
-    // we do not spend any time in the function but go directly inside the if condition.
-    if ( ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] == 0 ) ||
-         DoubleFrameSizeConvBufOut[iCurChanID].Put ( vecsSendData, SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] ) )
-    {
-        if ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] != 0 )
+        if ( bIsMono )
         {
-            // get the large frame from the conversion buffer
-            DoubleFrameSizeConvBufOut[iCurChanID].GetAll ( vecsSendData, DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt] );
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                Accum.MonoToMono ( pfMix, vecpData[j], iServerFrameSizeSamples, fCorrL );
+            }
+            else
+            {
+                Accum.StereoToMono ( pfMix, vecpData[j], iServerFrameSizeSamples, fCorrL );
+            }
         }
-
-        // OPUS encoding
-        if ( pCurOpusEncoder != nullptr )
+        else
         {
-            //### TODO: BEGIN ###//
-            // find a better place than this: the setting does not change all the time so for speed
-            // optimization it would be better to set it only if the network frame size is changed
-            opus_custom_encoder_ctl ( pCurOpusEncoder,
-                                      OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iClientFrameSizeSamples ) ) );
-            //### TODO: END ###//
-
-            for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[iChanCnt]; iB++ )
+            if ( vecNumAudioChannels[j] == 1 )
             {
-                const int iOffset = iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[iChanCnt];
-
-                iUnused = opus_custom_encode ( pCurOpusEncoder,
-                                               &vecsSendData[iOffset],
-                                               iClientFrameSizeSamples,
-                                               &vecvecbyCodedData[iChanCnt][0],
-                                               iCeltNumCodedBytes );
-
-                // send separate mix to current clients
-                vecChannels[iCurChanID].PrepAndSendPacket ( &Socket, vecvecbyCodedData[iChanCnt], iCeltNumCodedBytes );
+                Accum.MonoToStereo ( pfMix, vecpData[j], iServerFrameSizeSamples, fCorrL, fCorrR );
+            }
+            else
+            {
+                Accum.StereoToStereo ( pfMix, vecpData[j], iServerFrameSizeSamples, fCorrL, fCorrR );
             }
         }
     }
-
-    Q_UNUSED ( iUnused )
 }
 
 CVector<CChannelInfo> CServer::CreateChannelList()
@@ -1282,72 +2399,62 @@ void CServer::CreateOtherMuteStateChanged ( const int iCurChanID, const int iOth
 
 int CServer::GetNumberOfConnectedClients()
 {
-    QMutexLocker locker ( &MutexChanOrder );
-
-    return iCurNumChannels;
+    // the counter is only modified under the channel order mutex, the
+    // readers do not need the lock
+    return iCurNumChannels.load ( std::memory_order_relaxed );
 }
 
 // CServer::FindChannel() is called for every received audio packet or connected protocol
 // packet, to find the channel ID associated with the source IP address and port.
-// In order to search as efficiently as possible, a list of active channel IDs is stored
-// in vecChannelOrder[], sorted by IP and port (according to CHostAddress::Compare()),
-// and a binary search is used to find either the existing channel, or the position at
-// which a new channel should be inserted.
+// The active channels are stored in a hash table (see CChannelMap) which is read without
+// any lock. Only if a new channel is created (the caller must hold the channel order
+// mutex in this case) the lowest free channel ID is assigned to the new address.
 
 int CServer::FindChannel ( const CHostAddress& CheckAddr, const bool bAllowNew )
 {
-    int iNewChanID = INVALID_CHANNEL_ID;
-
-    QMutexLocker locker ( &MutexChanOrder );
+    int iChanID = ChannelMap.Find ( CheckAddr );
 
-    int l = 0, r = iCurNumChannels, i;
-
-    // use binary search to find the channel
-    while ( r > l )
+    if ( iChanID != INVALID_INDEX )
     {
-        int t   = ( r + l ) / 2;
-        int cmp = CheckAddr.Compare ( vecChannels[vecChannelOrder[t]].GetAddress() );
-
-        if ( cmp == 0 )
-        {
-            // address and port match
-            return vecChannelOrder[t];
-        }
-
-        if ( cmp > 0 )
-        {
-            l = t + 1;
-        }
-        else
-        {
-            r = t;
-        }
+        // address and port match
+        return iChanID;
     }
 
     // existing channel not found - return if we cannot create a new channel
-    if ( !bAllowNew || iCurNumChannels >= iMaxNumChannels )
+    if ( !bAllowNew )
+    {
+        return INVALID_CHANNEL_ID;
+    }
+
+    if ( iCurNumChannels >= iMaxNumChannels )
     {
         return INVALID_CHANNEL_ID;
     }
 
-    // allocate a new channel
-    i          = iCurNumChannels++; // save index of free channel and increment count
-    iNewChanID = vecChannelOrder[i];
-    InitChannel ( iNewChanID, CheckAddr );
+    // allocate the lowest free channel ID
+    iChanID = 0;
+
+    while ( ChannelMap.IsMapped ( iChanID ) )
+    {
+        iChanID++;
+    }
+
+    iCurNumChannels++;
+    InitChannel ( iChanID, CheckAddr );
 
-    // now l == r == position in vecChannelOrder to insert iNewChanID
-    // move channel IDs up by one starting at the top and working down
-    while ( i > r )
+    // the packets of the previous client of this channel ID which are still in
+    // the inbound ring are dropped (the old address is already unmapped)
+    if ( bUseInboundRing )
     {
-        int j              = i--;
-        vecChannelOrder[j] = vecChannelOrder[i];
+        veciChanGenerations[iChanID].fetch_add ( 1, std::memory_order_release );
     }
-    // insert the new channel ID in the correct place
-    vecChannelOrder[i] = iNewChanID;
+
+    // the channel is only visible to the readers after it is initialized
+    ChannelMap.Insert ( CheckAddr, iChanID );
 
     // DumpChannels ( __FUNCTION__ );
 
-    return iNewChanID;
+    return iChanID;
 }
 
 void CServer::InitChannel ( const int iNewChanID, const CHostAddress& InetAddr )
@@ -1355,6 +2462,12 @@ void CServer::InitChannel ( const int iNewChanID, const CHostAddress& InetAddr )
     // initialize new channel by storing the calling host address
     vecChannels[iNewChanID].SetAddress ( InetAddr );
 
+    // resolve the destination address for the batched send path
+    if ( !Socket.GetSockAddr ( InetAddr, vecSendSockAddr[iNewChanID], veciSendSockAddrLen[iNewChanID] ) )
+    {
+        veciSendSockAddrLen[iNewChanID] = 0;
+    }
+
     // reset channel info
     vecChannels[iNewChanID].ResetInfo();
 
@@ -1370,36 +2483,38 @@ void CServer::InitChannel ( const int iNewChanID, const CHostAddress& InetAddr )
         vecChannels[i].SetGain ( iNewChanID, 1.0 );
         vecChannels[i].SetPan ( iNewChanID, 0.5 );
     }
+
+    // the same for the values used by the mixer
+    MixMatrix.ResetChannel ( iNewChanID );
 }
 
 // CServer::FreeChannel() is called to remove a channel from the list of active channels.
-// The remaining ordered IDs are moved down by one space, and the freed ID is moved to the
-// end, ready to be reused by the next new connection.
+// The freed ID is ready to be reused by the next new connection.
 
 void CServer::FreeChannel ( const int iCurChanID )
 {
     QMutexLocker locker ( &MutexChanOrder );
 
-    for ( int i = 0; i < iCurNumChannels; i++ )
+    if ( ( iCurChanID >= 0 ) && ( iCurChanID < iMaxNumChannels ) && ChannelMap.IsMapped ( iCurChanID ) )
     {
-        if ( vecChannelOrder[i] == iCurChanID )
+        // a packet of the same address may have reconnected the channel after
+        // the time-out, in this case the channel stays in use
+        if ( vecChannels[iCurChanID].IsConnected() )
         {
-            --iCurNumChannels;
+            return;
+        }
 
-            // move channel IDs down by one starting at the freed channel and working up the active channels
-            // and then the free channels until its position in the free list is reached
-            while ( i < iCurNumChannels || ( i + 1 < iMaxNumChannels && vecChannelOrder[i + 1] < iCurChanID ) )
-            {
-                int j              = i++;
-                vecChannelOrder[j] = vecChannelOrder[i];
-            }
-            // put deleted channel in the vacated position ready for re-use
-            vecChannelOrder[i] = iCurChanID;
+        --iCurNumChannels;
 
-            // DumpChannels ( __FUNCTION__ );
+        // the channel is not mixed anymore
+        MixMatrix.RemoveChannel ( iCurChanID );
 
-            return;
-        }
+        // packets from this address do not find the channel anymore
+        ChannelMap.Remove ( iCurChanID );
+
+        // DumpChannels ( __FUNCTION__ );
+
+        return;
     }
 
     qWarning() << "FreeChannel() called with invalid channel ID";
@@ -1411,14 +2526,10 @@ void CServer::DumpChannels ( const QString& title )
 
     for ( int i = 0; i < iMaxNumChannels; i++ )
     {
-        int iChanID = vecChannelOrder[i];
-
-        if ( i == iCurNumChannels )
+        if ( ChannelMap.IsMapped ( i ) )
         {
-            qDebug() << "----------";
+            qDebug() << qUtf8Printable ( QString ( "[%1] %2" ).arg ( i, 3 ).arg ( vecChannels[i].GetAddress().toString() ) );
         }
-
-        qDebug() << qUtf8Printable ( QString ( "%1: [%2] %3" ).arg ( i, 3 ).arg ( iChanID ).arg ( vecChannels[iChanID].GetAddress().toString() ) );
     }
 }
 
@@ -1444,12 +2555,167 @@ void CServer::OnProtocolMessageReceived ( int iRecCounter, int iRecID, CVector<u
     }
 }
 
-bool CServer::PutAudioData ( const CVector<uint8_t>& vecbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID )
+bool CServer::PutAudioData ( const uint8_t* pbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID )
+{
+    // the packets of connected channels are handed over without any lock
+    if ( bUseInboundRing && PutInboundRing ( pbyRecBuf, iNumBytesRead, HostAdr, iCurChanID ) )
+    {
+        return false;
+    }
+
+    QMutexLocker locker ( &Mutex );
+
+    return PutAudioDataLocked ( pbyRecBuf, iNumBytesRead, HostAdr, iCurChanID );
+}
+
+void CServer::PutAudioDataBatch ( SReceivedPacket* pPackets, const int iNumPackets )
 {
+    int iNumLockedPackets = iNumPackets;
+
+    // the packets of connected channels are handed over without any lock
+    if ( bUseInboundRing )
+    {
+        iNumLockedPackets = 0;
+
+        for ( int i = 0; i < iNumPackets; i++ )
+        {
+            SReceivedPacket& Packet = pPackets[i];
+
+            Packet.bNewConnection = false;
+
+            if ( !PutInboundRing ( Packet.pbyData, Packet.iNumBytes, *Packet.pHostAddr, Packet.iChanID ) )
+            {
+                // mark the packet for the locked path
+                Packet.iChanID = INVALID_INDEX;
+                iNumLockedPackets++;
+            }
+        }
+    }
+
+    if ( iNumLockedPackets == 0 )
+    {
+        return;
+    }
+
+    // the lock is only acquired once for all packets of a receive batch
     QMutexLocker locker ( &Mutex );
 
+    for ( int i = 0; i < iNumPackets; i++ )
+    {
+        SReceivedPacket& Packet = pPackets[i];
+
+        if ( !bUseInboundRing || ( Packet.iChanID == INVALID_INDEX ) )
+        {
+            Packet.bNewConnection = PutAudioDataLocked ( Packet.pbyData, Packet.iNumBytes, *Packet.pHostAddr, Packet.iChanID );
+        }
+    }
+}
+
+bool CServer::PutInboundRing ( const uint8_t* pbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID )
+{
+    // packets of unknown or not yet connected channels change the connection
+    // state, this is done on the locked path
+    const int iChanID = ChannelMap.Find ( HostAdr );
+
+    if ( ( iChanID == INVALID_INDEX ) || !vecChannels[iChanID].IsConnected() || ( iNumBytesRead > INBOUND_RING_MAX_PACKET_SIZE ) )
+    {
+        return false;
+    }
+
+    // the channel ID may have been freed and assigned to another address
+    // since the lookup, the second lookup after reading the generation makes
+    // sure that the generation belongs to the connection of this address
+    const uint32_t iGeneration = veciChanGenerations[iChanID].load ( std::memory_order_acquire );
+
+    if ( ChannelMap.Find ( HostAdr ) != iChanID )
+    {
+        return false;
+    }
+
+    // only one receive thread may put into the ring at a time (the previous
+    // client of a reassigned channel ID may be received by another socket)
+    if ( vecInboundRingBusy[iChanID].exchange ( true, std::memory_order_acquire ) )
+    {
+        return false;
+    }
+
+    const bool bPutOK = vecInboundRings[iChanID].Put ( pbyRecBuf, iNumBytesRead, iGeneration );
+
+    vecInboundRingBusy[iChanID].store ( false, std::memory_order_release );
+
+    iCurChanID = iChanID;
+
+    if ( !bPutOK )
+    {
+        // the consumer is stalled, the jitter buffer would overflow anyway
+        iInboundRingDropsTotal.fetch_add ( 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    if ( bDecodeOnArrival )
+    {
+        // decode the frame as soon as it is due
+        pDecodeWorker->Post ( iChanID );
+    }
+
+    return true;
+}
+
+void CServer::DrainInboundRing ( const int iChanID )
+{
+    // consumer side of the inbound ring, called by the tick or (with decode on
+    // arrival) by the holder of the decoded frame of the channel
+    if ( !bUseInboundRing )
+    {
+        return;
+    }
+
+    CSpscPacketRing& Ring    = vecInboundRings[iChanID];
+    CChannel&        Channel = vecChannels[iChanID];
+    int              iNumBytes;
+    uint32_t         iTag;
+    const uint8_t*   pbyData;
+
+    while ( ( pbyData = Ring.Front ( iNumBytes, iTag ) ) != nullptr )
+    {
+        // the connection state is only changed on the locked path, packets
+        // which arrive after the disconnection or which belong to a previous
+        // connection of this channel ID are dropped
+        if ( Channel.IsConnected() && ( iTag == veciChanGenerations[iChanID].load ( std::memory_order_relaxed ) ) )
+        {
+            Channel.PutAudioData ( pbyData, iNumBytes, Channel.GetAddress() );
+        }
+
+        Ring.Pop();
+    }
+}
+
+void CServer::FlushInboundRing ( const int iChanID )
+{
+    if ( !bUseInboundRing )
+    {
+        return;
+    }
+
+    CSpscPacketRing& Ring = vecInboundRings[iChanID];
+    int              iNumBytes;
+    uint32_t         iTag;
+
+    while ( Ring.Front ( iNumBytes, iTag ) != nullptr )
+    {
+        Ring.Pop();
+    }
+}
+
+bool CServer::PutAudioDataLocked ( const uint8_t* pbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID )
+{
     bool bNewConnection = false; // init return value
 
+    // the connection state of a channel is only changed under the channel order
+    // mutex, otherwise a packet could reconnect a channel which is just freed by
+    // the tick (the tick does not take the server mutex)
+    QMutexLocker locker ( &MutexChanOrder );
+
     // Get channel ID ------------------------------------------------------
     // check address
     iCurChanID = FindChannel ( HostAdr, true /* allow new */ );
@@ -1458,11 +2724,18 @@ bool CServer::PutAudioData ( const CVector<uint8_t>& vecbyRecBuf, const int iNum
     if ( iCurChanID != INVALID_CHANNEL_ID )
     {
         // put packet in socket buffer
-        if ( vecChannels[iCurChanID].PutAudioData ( vecbyRecBuf, iNumBytesRead, HostAdr ) == PS_NEW_CONNECTION )
+        const EPutDataStat eStatus = vecChannels[iCurChanID].PutAudioData ( pbyRecBuf, iNumBytesRead, HostAdr );
+
+        if ( eStatus == PS_NEW_CONNECTION )
         {
             // in case we have a new connection return this information
             bNewConnection = true;
         }
+        else if ( ( eStatus == PS_AUDIO_OK ) && bDecodeOnArrival )
+        {
+            // decode the frame as soon as it is due
+            pDecodeWorker->Post ( iCurChanID );
+        }
     }
 
     // return the state if a new connection was happening
@@ -1585,10 +2858,11 @@ void CServer::customEvent ( QEvent* pEvent )
 }
 
 /// @brief Compute frame peak level for each client
-bool CServer::CreateLevelsForAllConChannels ( const int                       iNumClients,
-                                              const CVector<int>&             vecNumAudioChannels,
-                                              const CVector<CVector<int16_t>> vecvecsData,
-                                              CVector<uint16_t>&              vecLevelsOut )
+template<typename TSample>
+bool CServer::CreateLevelsForAllConChannels ( const int                iNumClients,
+                                              const CVector<int>&      vecNumAudioChannels,
+                                              const CVector<TSample*>& vecpData,
+                                              CVector<uint16_t>&       vecLevelsOut )
 {
     bool bLevelsWereUpdated = false;
 
@@ -1601,7 +2875,7 @@ bool CServer::CreateLevelsForAllConChannels ( const int                       iN
         for ( int j = 0; j < iNumClients; j++ )
         {
             // update and get signal level for meter in dB for each channel
-            const double dCurSigLevelForMeterdB = vecChannels[vecChanIDsCurConChan[j]].UpdateAndGetLevelForMeterdB ( vecvecsData[j],
+            const double dCurSigLevelForMeterdB = vecChannels[vecChanIDsCurConChan[j]].UpdateAndGetLevelForMeterdB ( vecpData[j],
                                                                                                                      iServerFrameSizeSamples,
                                                                                                                      vecNumAudioChannels[j] > 1 );
 
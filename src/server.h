@@ -40,6 +40,12 @@
 #include "socket.h"
 #include "channel.h"
 #include "util.h"
+#include "mixkernels.h"
+#include "mixmatrix.h"
+#include "channelmap.h"
+#include "codecpool.h"
+#include "playout.h"
+#include "audioarena.h"
 #include "serverlogging.h"
 #include "serverlist.h"
 #include "recorder/jamcontroller.h"
@@ -50,7 +56,73 @@
 // no valid channel number
 #define INVALID_CHANNEL_ID ( MAX_NUM_CHANNELS + 1 )
 
+// interval for processing the events of the real-time mixer thread
+#define MIXER_EVENT_POLL_INTERVAL_MS 10
+
+// level advantage of the current top talkers against new candidates
+#define TOP_TALKERS_HYSTERESIS_DB 6.0
+
+// worst case number of values of an audio frame (stereo, double frame size)
+#define MAX_FRAME_NUM_VALUES ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES )
+
+// number of ticks the recorder frames of the real-time mixer thread are queued
+// for the main thread (the queue is polled every MIXER_EVENT_POLL_INTERVAL_MS)
+#define RECORDER_QUEUE_NUM_TICKS 32
+
+// number of packets and maximum packet size of the inbound ring of a channel
+// (larger packets take the locked path)
+#define INBOUND_RING_NUM_PACKETS     64
+#define INBOUND_RING_MAX_PACKET_SIZE 512
+
+/* Enums **********************************************************************/
+// events handed over from the real-time mixer thread to the main thread
+enum EMixerEvent
+{
+    ME_CHANNEL_LIST_CHANGED, // a channel was disconnected
+    ME_NO_CLIENT_CONNECTED   // the server can be stopped
+};
+
+// state of the frame which is decoded on arrival (per channel)
+enum EDecodedFrameState
+{
+    DF_EMPTY, // the decode worker may decode the next blocks
+    DF_BUSY,  // the decode worker is decoding
+    DF_READY, // all blocks of the frame are decoded
+    DF_TICK   // the tick uses the frame, the codec state and the jitter buffer
+};
+
 /* Classes ********************************************************************/
+// tuning options of the mixer and the network path of the server (the defaults
+// correspond to the original processing)
+struct SServerTuningOptions
+{
+    SServerTuningOptions() :
+        bUseRealTimeMixer ( false ),
+        bUseSharedMixBus ( false ),
+        iMaxNumTopTalkers ( 0 ),
+        bUseFloatPipeline ( false ),
+        bDecodeOnArrival ( false ),
+        iRecvBatchSize ( 1 ),
+        iNumRecvSockets ( 1 ),
+        bUseIoUring ( false ),
+        bUseJitterHistogram ( false ),
+        bUseInboundRing ( false ),
+        bUseAdaptivePlayout ( false )
+    {}
+
+    bool bUseRealTimeMixer;   // process the tick in the high priority timer thread
+    bool bUseSharedMixBus;    // mix the targets with default gains/pans from one bus
+    int  iMaxNumTopTalkers;   // only mix the loudest sources (0: mix all sources)
+    bool bUseFloatPipeline;   // decode, mix and encode float samples
+    bool bDecodeOnArrival;    // decode the packets in the decode worker on arrival
+    int  iRecvBatchSize;      // maximum number of packets per receive system call
+    int  iNumRecvSockets;     // number of sockets sharing the server port
+    bool bUseIoUring;         // receive the packets with io_uring
+    bool bUseJitterHistogram; // jitter buffer auto sizing with the arrival histogram
+    bool bUseInboundRing;     // hand over the packets of connected channels without lock
+    bool bUseAdaptivePlayout; // time-scale the audio instead of concealing underruns
+};
+
 template<unsigned int slotId>
 class CServerSlots : public CServerSlots<slotId - 1>
 {
@@ -64,6 +136,12 @@ public:
 
     void OnServerAutoSockBufSizeChangeCh ( int iNNumFra ) { CreateAndSendJitBufMessage ( slotId - 1, iNNumFra ); }
 
+    void OnChanGainHasChangedCh ( int iChanID, float fNewGain ) { SetMixMatrixGain ( slotId - 1, iChanID, fNewGain ); }
+
+    void OnChanPanHasChangedCh ( int iChanID, float fNewPan ) { SetMixMatrixPan ( slotId - 1, iChanID, fNewPan ); }
+
+    void OnNetTranspPropsHaveChangedCh() { PrepareCodec ( slotId - 1 ); }
+
 protected:
     virtual void SendProtMessage ( int iChID, CVector<uint8_t> vecMessage ) = 0;
 
@@ -74,6 +152,12 @@ protected:
     virtual void CreateOtherMuteStateChanged ( const int iCurChanID, const int iOtherChanID, const bool bIsMuted ) = 0;
 
     virtual void CreateAndSendJitBufMessage ( const int iCurChanID, const int iNNumFra ) = 0;
+
+    virtual void SetMixMatrixGain ( const int iCurChanID, const int iOtherChanID, const float fNewGain ) = 0;
+
+    virtual void SetMixMatrixPan ( const int iCurChanID, const int iOtherChanID, const float fNewPan ) = 0;
+
+    virtual void PrepareCodec ( const int iCurChanID ) = 0;
 };
 
 template<>
@@ -85,26 +169,27 @@ class CServer : public QObject, public CServerSlots<MAX_NUM_CHANNELS>
     Q_OBJECT
 
 public:
-    CServer ( const int          iNewMaxNumChan,
-              const QString&     strLoggingFileName,
-              const QString&     strServerBindIP,
-              const quint16      iPortNumber,
-              const quint16      iQosNumber,
-              const QString&     strHTMLStatusFileName,
-              const QString&     strDirectoryAddress,
-              const QString&     strServerListFileName,
-              const QString&     strServerInfo,
-              const QString&     strServerListFilter,
-              const QString&     strServerPublicIP,
-              const QString&     strNewWelcomeMessage,
-              const QString&     strRecordingDirName,
-              const bool         bNDisconnectAllClientsOnQuit,
-              const bool         bNUseDoubleSystemFrameSize,
-              const bool         bNUseMultithreading,
-              const bool         bDisableRecording,
-              const bool         bNDelayPan,
-              const bool         bNEnableIPv6,
-              const ELicenceType eNLicenceType );
+    CServer ( const int                   iNewMaxNumChan,
+              const QString&              strLoggingFileName,
+              const QString&              strServerBindIP,
+              const quint16               iPortNumber,
+              const quint16               iQosNumber,
+              const QString&              strHTMLStatusFileName,
+              const QString&              strDirectoryAddress,
+              const QString&              strServerListFileName,
+              const QString&              strServerInfo,
+              const QString&              strServerListFilter,
+              const QString&              strServerPublicIP,
+              const QString&              strNewWelcomeMessage,
+              const QString&              strRecordingDirName,
+              const bool                  bNDisconnectAllClientsOnQuit,
+              const bool                  bNUseDoubleSystemFrameSize,
+              const bool                  bNUseMultithreading,
+              const SServerTuningOptions& Tuning,
+              const bool                  bDisableRecording,
+              const bool                  bNDelayPan,
+              const bool                  bNEnableIPv6,
+              const ELicenceType          eNLicenceType );
 
     virtual ~CServer();
 
@@ -112,7 +197,8 @@ public:
     void Stop();
     bool IsRunning() { return HighPrecisionTimer.isActive(); }
 
-    bool PutAudioData ( const CVector<uint8_t>& vecbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID );
+    bool PutAudioData ( const uint8_t* pbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID );
+    void PutAudioDataBatch ( SReceivedPacket* pPackets, const int iNumPackets );
 
     int GetNumberOfConnectedClients();
 
@@ -130,6 +216,8 @@ public:
     // GUI settings ------------------------------------------------------------
     int GetClientNumAudioChannels ( const int iChanNum ) { return vecChannels[iChanNum].GetNumAudioChannels(); }
 
+    CCodecConfig GetClientCodecConfig ( const int iChanNum ) { return vecChannels[iChanNum].GetCodecConfig(); }
+
     void           SetDirectoryType ( const EDirectoryType eNCSAT ) { ServerListManager.SetDirectoryType ( eNCSAT ); }
     EDirectoryType GetDirectoryType() { return ServerListManager.GetDirectoryType(); }
     bool           IsDirectory() { return ServerListManager.IsDirectory(); }
@@ -169,10 +257,37 @@ public:
     void SetEnableDelayPanning ( bool bDelayPanningOn ) { bDelayPan = bDelayPanningOn; }
     bool IsDelayPanningEnabled() { return bDelayPan; }
 
+    // mixer statistics
+    bool                          IsRealTimeMixer() const { return bUseRealTimeMixer; }
+    const CTickLatenessHistogram& GetTickLatenessHistogram() const { return TickLateness; }
+    int                           GetMixPairsLastTick() const { return iMixPairsLastTick; }
+    int                           GetSkippedMixPairsLastTick() const { return iSkippedMixPairsLastTick; }
+    int64_t                       GetMixPairsTotal() const { return iMixPairsTotal; }
+    int64_t                       GetSkippedMixPairsTotal() const { return iSkippedMixPairsTotal; }
+    bool                          IsDecodeOnArrival() const { return bDecodeOnArrival; }
+    int64_t                       GetArrivalDecodedBlocksTotal() const { return iArrivalDecodedBlocksTotal; }
+    int64_t                       GetTickDecodedBlocksTotal() const { return iTickDecodedBlocksTotal; }
+    int64_t                       GetArrivalDecodeTimeUsTotal() const { return iArrivalDecodeTimeNsTotal / 1000; }
+    int                           GetReceiveBatchSize() const { return Socket.GetReceiveBatchSize(); }
+    double                        GetAvgReceiveBatchSize() const { return Socket.GetAvgReceiveBatchSize(); }
+    int                           GetNumReceiveSockets() const { return static_cast<int> ( vecpRecvShardSockets.size() ) + 1; }
+    bool                          GetUseIoUring() const { return Socket.GetUseIoUring(); }
+    bool                          GetUseJitterHistogram() const { return vecChannels[0].GetUseJitterHistogram(); }
+    bool                          GetUseInboundRing() const { return bUseInboundRing; }
+    bool                          GetUseAdaptivePlayout() const { return bUseAdaptivePlayout; }
+    int64_t                       GetPlayoutCompressedTotal() const { return iPlayoutCompressedTotal.load ( std::memory_order_relaxed ); }
+    int64_t                       GetPlayoutStretchedTotal() const { return iPlayoutStretchedTotal.load ( std::memory_order_relaxed ); }
+    int64_t                       GetInboundRingDropsTotal() const { return iInboundRingDropsTotal.load ( std::memory_order_relaxed ); }
+
 protected:
     // access functions for actual channels
     bool IsConnected ( const int iChanNum ) { return vecChannels[iChanNum].IsConnected(); }
 
+    bool PutAudioDataLocked ( const uint8_t* pbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID );
+    bool PutInboundRing ( const uint8_t* pbyRecBuf, const int iNumBytesRead, const CHostAddress& HostAdr, int& iCurChanID );
+    void DrainInboundRing ( const int iChanID );
+    void FlushInboundRing ( const int iChanID );
+
     int                   FindChannel ( const CHostAddress& CheckAddr, const bool bAllowNew = false );
     void                  InitChannel ( const int iNewChanID, const CHostAddress& InetAddr );
     void                  FreeChannel ( const int iCurChanID );
@@ -188,6 +303,21 @@ protected:
 
     virtual void CreateAndSendJitBufMessage ( const int iCurChanID, const int iNNumFra );
 
+    virtual void SetMixMatrixGain ( const int iCurChanID, const int iOtherChanID, const float fNewGain )
+    {
+        MixMatrix.SetGain ( iCurChanID, iOtherChanID, fNewGain );
+    }
+
+    virtual void SetMixMatrixPan ( const int iCurChanID, const int iOtherChanID, const float fNewPan )
+    {
+        MixMatrix.SetPan ( iCurChanID, iOtherChanID, fNewPan );
+    }
+
+    virtual void PrepareCodec ( const int iCurChanID )
+    {
+        CodecPool.Prepare ( iCurChanID, vecChannels[iCurChanID].GetAudioCompressionType(), vecChannels[iCurChanID].GetNumAudioChannels() );
+    }
+
     virtual void SendProtMessage ( int iChID, CVector<uint8_t> vecMessage );
 
     template<unsigned int slotId>
@@ -202,8 +332,58 @@ protected:
 
     void DecodeReceiveData ( const int iChanCnt, const int iNumClients );
 
+    template<typename TSample>
+    void DecodeFrames ( const int                  iChanCnt,
+                        OpusCustomDecoder*         CurOpusDecoder,
+                        const int                  iClientFrameSizeSamples,
+                        TSample*                   pData,
+                        CConvBuf<TSample>&         ConvBufIn,
+                        CAdaptivePlayout<TSample>& Playout,
+                        const int                  iNumDecodedBlocks );
+
+    static void DecodeOnArrival ( CServer* pServer, const int iChanID ) { pServer->DecodeFrameOnArrival ( iChanID ); }
+
+    void DecodeFrameOnArrival ( const int iChanID );
+    void UpdateCodecConfigSnapshot ( const int iChanID, CCodecConfig& CodecConfig, int& iCodecConfigVersion );
+    void LockDecodedFrame ( const int iChanID );
+    void ReleaseDecodedFrame ( const int iChanID );
+
+    template<typename TSample>
+    int TakeDecodedFrame ( const int iChanCnt, CVector<TSample*>& vecpData, CVector<TSample*>& vecpArrivalData );
+
     void MixEncodeTransmitData ( const int iChanCnt, const int iNumClients );
 
+    template<typename TSample>
+    void MixEncodeTransmitFrames ( const int                iChanCnt,
+                                   const int                iNumClients,
+                                   const CVector<TSample*>& vecpData,
+                                   const CVector<TSample*>& vecpPrevData,
+                                   TSample*                 pSendData,
+                                   CConvBuf<TSample>&       ConvBufOut );
+
+    // final conversion of the float mix for the encoder
+    void StoreMix ( int16_t* psSendData, const float* pfMix, const int iNumValues ) { MixKernels.Saturate ( psSendData, pfMix, iNumValues ); }
+
+    void StoreMix ( float* pfSendData, const float* pfMix, const int iNumValues ) { MixKernels.Clip ( pfSendData, pfMix, iNumValues ); }
+
+    // the scratch slabs are shared by the channels of one multithreading block
+    int GetScratchIdx ( const int iChanCnt ) const { return iChanCnt / iScratchBlockSize; }
+
+    void AllocateAudioArena();
+
+    void FlushSendBatch ( const int iScratchIdx );
+
+    void SelectTopTalkers ( const int iNumClients );
+    int  CreateActiveSourceList ( const int iChanCnt, const int iNumClients );
+    void GetSharedMixBusCorrection ( const int iChanCnt, const int j, float& fCorrL, float& fCorrR ) const;
+    bool IsSharedMixBusDeviation ( const int iChanCnt, const int j ) const;
+
+    template<typename TSample>
+    void CreateSharedMixBuses ( const int iNumClients, const CVector<TSample*>& vecpData );
+
+    template<typename TSample>
+    void MixFromSharedMixBus ( const int iChanCnt, const int iNumClients, const CVector<TSample*>& vecpData );
+
     virtual void customEvent ( QEvent* pEvent );
 
     void CreateAndSendRecorderStateForAllConChannels();
@@ -213,57 +393,202 @@ protected:
     int  iServerFrameSizeSamples;
 
     // variables needed for multithreading support
-    bool                       bUseMultithreading;
-    int                        iMaxNumThreads;
-    CVector<std::future<void>> Futures;
+    bool bUseMultithreading;
+    int  iMaxNumThreads;
+
+    // real-time mixer thread: the tick runs directly in the timer thread and
+    // all interaction with the main thread goes through lock-free queues
+    bool                    bUseRealTimeMixer;
+    bool                    bNoClientEventPosted;
+    CSpscQueue<EMixerEvent> MixerEventQueue;   // mixer thread -> main thread
+    CSpscQueue<int>         ChanResetQueue;    // main thread -> mixer thread
+    QTimer                  MixerEventTimer;
+    CTickLatenessHistogram  TickLateness;
+
+    // the control-plane work of the tick (jitter buffer resizing, channel level
+    // messages and recorder frames) is done by the main thread in case of the
+    // real-time mixer, the mixer thread only hands over the data by value
+    struct SLevelListEvent
+    {
+        int      iNumClients;
+        int      veciChanIDs[MAX_NUM_CHANNELS];
+        uint16_t vecLevels[MAX_NUM_CHANNELS];
+    };
 
-    bool CreateLevelsForAllConChannels ( const int                       iNumClients,
-                                         const CVector<int>&             vecNumAudioChannels,
-                                         const CVector<CVector<int16_t>> vecvecsData,
-                                         CVector<uint16_t>&              vecLevelsOut );
+    struct SRecorderFrameEvent
+    {
+        int     iChanID;
+        int     iNumAudioChannels;
+        int     iNumValues;
+        int16_t vecsData[MAX_FRAME_NUM_VALUES];
+    };
+
+    CSpscQueue<int>                 JitBufChangeQueue;  // mixer thread -> main thread, channel IDs
+    CSpscQueue<SLevelListEvent>     LevelListQueue;     // mixer thread -> main thread
+    CSpscQueue<SRecorderFrameEvent> RecorderFrameQueue; // mixer thread -> main thread
+    SLevelListEvent                 TickLevelList;      // used by the mixer thread only
+    SRecorderFrameEvent             TickRecorderFrame;  // used by the mixer thread only
+    SLevelListEvent                 MainLevelList;      // used by the main thread only
+    SRecorderFrameEvent             MainRecorderFrame;  // used by the main thread only
+    CVector<uint16_t>               vecMainChannelLevels;
+    CVector<int16_t>                vecsMainRecorderFrame;
+
+    // shared bus mixing: one common mix per output format, the personal mixes
+    // only apply the deviations from the default gains/pans
+    bool               bUseSharedMixBus;
+    CVector<int>       vecNumMixDeviations;
+    CVector<int>       vecUseSharedMixBus;
+    CArenaSlabs<float> SharedMixBusMono;
+    CArenaSlabs<float> SharedMixBusStereo;
+
+    // top talkers mixing: only the loudest sources and the own channel are mixed
+    int                              iMaxNumTopTalkers; // zero if disabled
+    int                              iNumTopTalkers;
+    CVector<CStereoSignalLevelMeter> vecTalkerLevelMeters; // index: channel ID
+    CVector<int>                     vecIsTopTalker;       // index: channel ID
+    CVector<double>                  vecdTalkerLevels;
+    CVector<double>                  vecdTalkerScores;
+    CVector<int>                     vecTalkerRanking;
+    CVector<int>                     vecTopTalkers;
+
+    // sparse mixing: muted pairs and silent sources are skipped by the mixer
+    CVector<int>          vecSourcePeaks;
+    CVector<int>          vecNumSkippedMixPairs;
+    CArenaSlabs<int>      vecvecActiveSources;
+    std::atomic<int>      iMixPairsLastTick;
+    std::atomic<int>      iSkippedMixPairsLastTick;
+    std::atomic<int64_t>  iMixPairsTotal;
+    std::atomic<int64_t>  iSkippedMixPairsTotal;
+
+    // float pipeline: the frames are decoded to float, mixed and encoded from
+    // float, the int16 frames are only filled for the jam recorder
+    bool               bUseFloatPipeline;
+    CArenaSlabs<float> FloatFrames;      // current and previous frames
+    CVector<float*>    vecpfData;        // index: channel count
+    CVector<float*>    vecpfPrevData;    // index: channel ID
+    CArenaSlabs<float> FloatSendScratch; // index: scratch
+
+    // decode on arrival: a worker fed by the receive thread decodes the next
+    // frame of a channel as soon as it is received, the tick only decodes
+    // (or conceals) the blocks which were not received in time
+    struct SDecodedFrame
+    {
+        std::atomic<int> iState;
+        int              iNumBlocks;
+        EAudComprType    eAudioCompressionType;
+        int              iNumAudioChannels;
+        CCodecConfig     CodecConfig; // snapshot of the decode worker
+        int              iCodecConfigVersion;
+    };
+
+    bool                                  bDecodeOnArrival;
+    std::unique_ptr<CItemWorker<CServer>> pDecodeWorker;
+    SDecodedFrame                         vecDecodedFrames[MAX_NUM_CHANNELS]; // index: channel ID
+    CArenaSlabs<int16_t>                  Int16ArrivalFrames;
+    CArenaSlabs<float>                    FloatArrivalFrames;
+    CVector<int16_t*>                     vecpsArrivalData; // index: channel ID
+    CVector<float*>                       vecpfArrivalData; // index: channel ID
+    CVector<int>                          vecNumTickDecodedBlocks;
+    std::atomic<int64_t>                  iArrivalDecodedBlocksTotal;
+    std::atomic<int64_t>                  iTickDecodedBlocksTotal;
+    std::atomic<int64_t>                  iArrivalDecodeTimeNsTotal;
+
+    // inbound ring: the receive thread hands the audio packets of a connected
+    // channel over to the tick (or the decode worker) without taking a lock,
+    // the packets of new channels still take the locked path since they
+    // change the connection state (SO_REUSEPORT delivers all packets of a
+    // client to the same socket, but with several receive sockets a channel ID
+    // can be reassigned to a client of another socket while the previous client
+    // still hands over a packet, therefore a producer must hold the busy flag
+    // of the ring, a second producer takes the locked path)
+    // The packets are tagged with the connection generation of the channel,
+    // which is incremented whenever the channel ID is assigned to a new
+    // address, so that a packet of the previous client is never handed to a
+    // new client which reuses the channel ID.
+    bool                  bUseInboundRing;
+    CSpscPacketRing       vecInboundRings[MAX_NUM_CHANNELS];     // index: channel ID
+    std::atomic<bool>     vecInboundRingBusy[MAX_NUM_CHANNELS];  // index: channel ID
+    std::atomic<uint32_t> veciChanGenerations[MAX_NUM_CHANNELS]; // index: channel ID
+    std::atomic<int64_t>  iInboundRingDropsTotal;
+
+    // adaptive playout: the decoded frames are stretched or compressed to keep
+    // the jitter buffer fill level low
+    bool                      bUseAdaptivePlayout;
+    CAdaptivePlayout<int16_t> Int16Playout[MAX_NUM_CHANNELS];
+    CAdaptivePlayout<float>   FloatPlayout[MAX_NUM_CHANNELS];
+    std::atomic<int64_t>      iPlayoutCompressedTotal;
+    std::atomic<int64_t>      iPlayoutStretchedTotal;
+
+    void PostMixerEvent ( const EMixerEvent eEvent );
+
+    template<typename TSample>
+    bool CreateLevelsForAllConChannels ( const int                iNumClients,
+                                         const CVector<int>&      vecNumAudioChannels,
+                                         const CVector<TSample*>& vecpData,
+                                         CVector<uint16_t>&       vecLevelsOut );
 
     // do not use the vector class since CChannel does not have appropriate
     // copy constructor/operator
     CChannel vecChannels[MAX_NUM_CHANNELS];
     int      iMaxNumChannels;
 
-    int    iCurNumChannels;
-    int    vecChannelOrder[MAX_NUM_CHANNELS];
-    QMutex MutexChanOrder;
+    // the address to channel ID map is read without lock, the mutex serializes connects and disconnects
+    std::atomic<int> iCurNumChannels;
+    CChannelMap      ChannelMap;
+    QMutex           MutexChanOrder;
 
+    // the server mutex serializes the protocol and connection handlers, it is never taken by the tick
     CProtocol ConnLessProtocol;
     QMutex    Mutex;
     QMutex    MutexWelcomeMessage;
     bool      bChannelIsNowDisconnected;
 
     // audio encoder/decoder
-    OpusCustomMode*    Opus64Mode[MAX_NUM_CHANNELS];
-    OpusCustomEncoder* Opus64EncoderMono[MAX_NUM_CHANNELS];
-    OpusCustomDecoder* Opus64DecoderMono[MAX_NUM_CHANNELS];
-    OpusCustomEncoder* Opus64EncoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomDecoder* Opus64DecoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomMode*    OpusMode[MAX_NUM_CHANNELS];
-    OpusCustomEncoder* OpusEncoderMono[MAX_NUM_CHANNELS];
-    OpusCustomDecoder* OpusDecoderMono[MAX_NUM_CHANNELS];
-    OpusCustomEncoder* OpusEncoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomDecoder* OpusDecoderStereo[MAX_NUM_CHANNELS];
+    CCodecPool         CodecPool;
     CConvBuf<int16_t>  DoubleFrameSizeConvBufIn[MAX_NUM_CHANNELS];
     CConvBuf<int16_t>  DoubleFrameSizeConvBufOut[MAX_NUM_CHANNELS];
+    CConvBuf<float>    DoubleFrameSizeConvBufInFloat[MAX_NUM_CHANNELS];
+    CConvBuf<float>    DoubleFrameSizeConvBufOutFloat[MAX_NUM_CHANNELS];
 
     CVector<QString> vstrChatColors;
     CVector<int>     vecChanIDsCurConChan;
 
-    CVector<CVector<float>>   vecvecfGains;
-    CVector<CVector<float>>   vecvecfPannings;
-    CVector<CVector<int16_t>> vecvecsData;
-    CVector<CVector<int16_t>> vecvecsData2;
+    // gains/pans of all channel pairs, the snapshot is taken at the start of each tick
+    CMixMatrix                   MixMatrix;
+    const CMixMatrix::CSnapshot* pMixMatrixSnapshot;
+
+    // per-tick working set: the per-channel slabs are indexed by the channel
+    // count, the scratch slabs by the multithreading block (see GetScratchIdx())
+    CAudioArena               AudioArena;
+    int                       iNumScratch;
+    int                       iScratchBlockSize;
+    CArenaSlabs<float>        vecvecfGains;
+    CArenaSlabs<float>        vecvecfPannings;
+    CVector<float>            vecfFadeInGains;
+    CArenaSlabs<int16_t>      Int16Frames;      // current and previous frames
+    CVector<int16_t*>         vecpsData;        // index: channel count
+    CVector<int16_t*>         vecpsPrevData;    // index: channel ID
+    CArenaSlabs<int16_t>      Int16SendScratch; // index: scratch
+    CArenaSlabs<float>        MixScratch;       // index: scratch
     CVector<int>              vecNumAudioChannels;
     CVector<int>              vecNumFrameSizeConvBlocks;
     CVector<int>              vecUseDoubleSysFraSizeConvBuf;
     CVector<EAudComprType>    vecAudioComprType;
-    CVector<CVector<int16_t>> vecvecsSendData;
-    CVector<CVector<float>>   vecvecfIntermediateProcBuf;
-    CVector<CVector<uint8_t>> vecvecbyCodedData;
+    CVector<CVector<uint8_t>> vecvecbyCodedData; // index: scratch
+    CVector<CSendBatch>       vecSendBatches;    // index: scratch
+    CVector<int16_t>          vecsRecorderFrame;
+
+    // codec configuration of the channels as seen by the tick, it is only copied
+    // from the channel if its version has changed
+    CCodecConfig vecCodecConfigs[MAX_NUM_CHANNELS];         // index: channel ID
+    int          veciCodecConfigVersions[MAX_NUM_CHANNELS]; // index: channel ID
+
+    // destination addresses of the channels, resolved once when the channel is initialized
+    uSockAddr vecSendSockAddr[MAX_NUM_CHANNELS];
+    int       veciSendSockAddrLen[MAX_NUM_CHANNELS]; // zero if the address cannot be used for batching
+
+    // vectorized mixing kernels (selected by CPU detection)
+    CMixKernels MixKernels;
 
     // Channel levels
     CVector<uint16_t> vecChannelLevels;
@@ -271,6 +596,10 @@ protected:
     // actual working objects
     CHighPrioSocket Socket;
 
+    // additional sockets on the server port, each with its own receive thread
+    // (the audio is always sent through the main socket)
+    std::vector<std::unique_ptr<CHighPrioSocket>> vecpRecvShardSockets;
+
     // logging
     CServerLogging Logging;
 
@@ -306,7 +635,7 @@ protected:
 
     CSignalHandler* pSignalHandler;
 
-    std::unique_ptr<CThreadPool> pThreadPool;
+    std::unique_ptr<CTickWorkerPool<CServer>> pThreadPool;
 
 signals:
     void Started();
@@ -330,6 +659,8 @@ signals:
 public slots:
     void OnTimer();
 
+    void OnMixerEventTimer();
+
     void OnNewConnection ( int iChID, int iTotChans, CHostAddress RecHostAddr );
 
     void OnServerFull ( CHostAddress RecHostAddr );
@@ -74,9 +74,9 @@ CServerListEntry CServerListEntry::parse ( QString strHAddr,
 
     CHostAddress haServerLocalAddr;
     NetworkUtil::ParseNetworkAddress ( strLHAddr, haServerLocalAddr, bEnableIPv6 );
-    if ( haServerLocalAddr.iPort == 0 )
+    if ( haServerLocalAddr.GetPort() == 0 )
     {
-        haServerLocalAddr.iPort = haServerHostAddr.iPort;
+        haServerLocalAddr.SetPort ( haServerHostAddr.GetPort() );
     }
 
     // Capture parsing success of integers
@@ -140,7 +140,7 @@ CServerListManager::CServerListManager ( const quint16  iNPortNum,
     iSvrRegRetries ( 0 )
 {
 
-    CHostAddress haServerAddr ( NetworkUtil::GetLocalAddress().InetAddr, iNPortNum );
+    CHostAddress haServerAddr ( NetworkUtil::GetLocalAddress().GetInetAddr(), iNPortNum );
 
     // set the server internal address, including internal port number
     QHostAddress qhaServerPublicIP;
@@ -148,7 +148,7 @@ CServerListManager::CServerListManager ( const quint16  iNPortNum,
     if ( strServerPublicIP == "" )
     {
         // No user-supplied override via --serverpublicip -> use auto-detection
-        qhaServerPublicIP = haServerAddr.InetAddr;
+        qhaServerPublicIP = haServerAddr.GetInetAddr();
     }
     else
     {
@@ -163,7 +163,7 @@ CServerListManager::CServerListManager ( const quint16  iNPortNum,
         // set the server internal address, including internal port number
         QHostAddress qhaServerPublicIP6;
 
-        qhaServerPublicIP6 = NetworkUtil::GetLocalAddress6().InetAddr;
+        qhaServerPublicIP6 = NetworkUtil::GetLocalAddress6().GetInetAddr();
         qDebug() << "Using" << qhaServerPublicIP6.toString() << "as external IPv6.";
         ServerPublicIP6 = CHostAddress ( qhaServerPublicIP6, iNPortNum );
     }
@@ -559,7 +559,7 @@ void CServerListManager::Append ( const CHostAddress&    InetAddr,
     if ( bIsDirectory )
     {
         // if the client IP address is a private one, it's on the same LAN as the directory
-        bool serverIsExternal = !NetworkUtil::IsPrivateNetworkIP ( InetAddr.InetAddr );
+        bool serverIsExternal = !NetworkUtil::IsPrivateNetworkIP ( InetAddr.GetInetAddr() );
 
         qInfo() << qUtf8Printable ( QString ( "Requested to register entry for %1 (%2): %3 (%4)" )
                                         .arg ( InetAddr.toString() )
@@ -584,7 +584,7 @@ void CServerListManager::Append ( const CHostAddress&    InetAddr,
         if ( !vWhiteList.empty() )
         {
             // if the server is not listed, refuse registration and send registration response
-            if ( !vWhiteList.contains ( InetAddr.InetAddr ) )
+            if ( !vWhiteList.contains ( InetAddr.GetInetAddr() ) )
             {
                 pConnLessProtocol->CreateCLRegisterServerResp ( InetAddr, SRR_NOT_FULFILL_REQIREMENTS );
                 return; // leave function early, i.e., we do not register this server
@@ -670,15 +670,15 @@ void CServerListManager::RetrieveAll ( const CHostAddress& InetAddr )
     if ( bIsDirectory )
     {
         // if the client IP address is a private one, it's on the same LAN as the directory
-        bool clientIsInternal = NetworkUtil::IsPrivateNetworkIP ( InetAddr.InetAddr );
+        bool clientIsInternal = NetworkUtil::IsPrivateNetworkIP ( InetAddr.GetInetAddr() );
 
         CHostAddress clientPublicAddr = InetAddr;
-        if ( clientIsInternal && CHostAddress().InetAddr != ServerList[0].LHostAddr.InetAddr &&
-             !NetworkUtil::IsPrivateNetworkIP ( ServerList[0].LHostAddr.InetAddr ) )
+        if ( clientIsInternal && CHostAddress().GetInetAddr() != ServerList[0].LHostAddr.GetInetAddr() &&
+             !NetworkUtil::IsPrivateNetworkIP ( ServerList[0].LHostAddr.GetInetAddr() ) )
         {
             // client and directory on same LAN, directory has public IP set, that should be suitable for the
             // client, too (i.e. same router with same public IP will be used for both), so use it for client public IP
-            clientPublicAddr.InetAddr = ServerList[0].LHostAddr.InetAddr;
+            clientPublicAddr.SetInetAddr ( ServerList[0].LHostAddr.GetInetAddr() );
         }
 
         const ushort iCurServerListSize = static_cast<ushort> ( ServerList.size() );
@@ -697,11 +697,13 @@ void CServerListManager::RetrieveAll ( const CHostAddress& InetAddr )
             // copy list item
             CServerInfo& siCurListEntry = vecServerInfo[iIdx] = ServerList[iIdx];
 
-            bool serverIsInternal = NetworkUtil::IsPrivateNetworkIP ( siCurListEntry.HostAddr.InetAddr );
+            bool serverIsInternal = NetworkUtil::IsPrivateNetworkIP ( siCurListEntry.HostAddr.GetInetAddr() );
+
+            // external server and client have different public IPs
+            bool differentPublicIPs = InetAddr.GetInetAddr() != siCurListEntry.HostAddr.GetInetAddr();
 
             bool wantHostAddr = clientIsInternal /* HostAddr is local IP if local server else external IP, so do not replace */ ||
-                                ( !serverIsInternal &&
-                                  InetAddr.InetAddr != siCurListEntry.HostAddr.InetAddr /* external server and client have different public IPs */ );
+                                ( !serverIsInternal && differentPublicIPs );
 
             if ( !wantHostAddr )
             {
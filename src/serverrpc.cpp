@@ -67,6 +67,13 @@ CServerRpc::CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* pare
     /// @result {string} result.clients[*].city - The city name provided by the user for this channel.
     /// @result {number} result.clients[*].countryName - The text name of the country specified by the user for this channel (see QLocale::Country).
     /// @result {number} result.clients[*].skillLevelCode - The skill level id provided by the user for this channel.
+    /// @result {object} result.clients[*].codec - The codec configuration negotiated with the client.
+    /// @result {string} result.clients[*].codec.type - The audio codec ("opus", "opus64" or "none").
+    /// @result {number} result.clients[*].codec.channels - The number of audio channels of the codec.
+    /// @result {number} result.clients[*].codec.codedBytes - The number of coded bytes per audio frame.
+    /// @result {number} result.clients[*].codec.bitRate - The encoder bit rate in bits per second.
+    /// @result {number} result.clients[*].codec.complexity - The encoder complexity.
+    /// @result {number} result.clients[*].codec.packetLossPerc - The expected packet loss in percent the encoder is tuned for.
     pRpcServer->HandleMethod ( "jamulusserver/getClients", [=] ( const QJsonObject& params, QJsonObject& response ) {
         QJsonArray                clients;
         CVector<CHostAddress>     vecHostAddresses;
@@ -85,11 +92,33 @@ CServerRpc::CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* pare
         // fill list with connected clients
         for ( int i = 0; i < iNumChannels; i++ )
         {
-            if ( vecHostAddresses[i].InetAddr == QHostAddress ( static_cast<quint32> ( 0 ) ) )
+            if ( vecHostAddresses[i].GetInetAddr() == QHostAddress ( static_cast<quint32> ( 0 ) ) )
             {
                 continue;
             }
 
+            const CCodecConfig CodecConfig = pServer->GetClientCodecConfig ( i );
+
+            QString strCodecType = "none";
+
+            if ( CodecConfig.eAudComprType == CT_OPUS )
+            {
+                strCodecType = "opus";
+            }
+            else if ( CodecConfig.eAudComprType == CT_OPUS64 )
+            {
+                strCodecType = "opus64";
+            }
+
+            QJsonObject codec{
+                { "type", strCodecType },
+                { "channels", CodecConfig.iNumAudioChannels },
+                { "codedBytes", CodecConfig.iCeltNumCodedBytes },
+                { "bitRate", CodecConfig.iBitRateBps },
+                { "complexity", CodecConfig.iComplexity },
+                { "packetLossPerc", CodecConfig.iPacketLossPerc },
+            };
+
             QJsonObject client{
                 { "id", i },
                 { "address", vecHostAddresses[i].toString ( CHostAddress::SM_IP_PORT ) },
@@ -100,6 +129,7 @@ CServerRpc::CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* pare
                 { "city", vecChanInfo[i].strCity },
                 { "countryName", QLocale::countryToString ( vecChanInfo[i].eCountry ) },
                 { "skillLevelCode", vecChanInfo[i].eSkillLevel },
+                { "codec", codec },
             };
             clients.append ( client );
 
@@ -115,6 +145,72 @@ CServerRpc::CServerRpc ( CServer* pServer, CRpcServer* pRpcServer, QObject* pare
         Q_UNUSED ( params );
     } );
 
+    /// @rpc_method jamulusserver/getMixerStatistics
+    /// @brief Returns timing statistics of the server audio processing.
+    /// @param {object} params - No parameters (empty object).
+    /// @result {boolean} result.realTimeMixer - True if the audio is processed in a dedicated real-time thread.
+    /// @result {number} result.maxTickLatenessUs - The largest lateness of a processing tick in microseconds.
+    /// @result {array} result.tickLateness - Histogram of the lateness of the processing ticks since the server was started.
+    /// @result {number} result.tickLateness[*].upToUs - Upper bound of the bin in microseconds (-1 for the last bin).
+    /// @result {number} result.tickLateness[*].count - The number of ticks in the bin.
+    /// @result {number} result.mixPairsLastTick - The number of source/target pairs of the last processing tick.
+    /// @result {number} result.skippedMixPairsLastTick - The number of pairs of the last tick which were skipped since they were muted or silent.
+    /// @result {number} result.mixPairsTotal - The number of source/target pairs since the server was started.
+    /// @result {number} result.skippedMixPairsTotal - The number of skipped pairs since the server was started.
+    /// @result {boolean} result.decodeOnArrival - True if the audio is decoded on arrival instead of in the processing tick.
+    /// @result {number} result.arrivalDecodedBlocksTotal - The number of audio blocks decoded on arrival (off the critical path of the tick).
+    /// @result {number} result.tickDecodedBlocksTotal - The number of audio blocks decoded or concealed in the processing tick.
+    /// @result {number} result.arrivalDecodeTimeUsTotal - The time spent decoding on arrival in microseconds.
+    /// @result {number} result.receiveBatchSize - The maximum number of datagrams received per system call.
+    /// @result {number} result.avgReceiveBatchSize - The average number of datagrams received per system call.
+    /// @result {number} result.receiveSockets - The number of sockets receiving on the server port.
+    /// @result {boolean} result.ioUring - True if the network packets are received through io_uring.
+    /// @result {boolean} result.jitterHistogram - True if the auto jitter buffer size is derived from a delay histogram.
+    /// @result {boolean} result.inboundRing - True if the received audio is handed over to the mixer through lock-free rings.
+    /// @result {number} result.inboundRingDropsTotal - The number of audio packets dropped because an inbound ring was full.
+    /// @result {boolean} result.adaptivePlayout - True if the decoded audio is stretched or compressed to follow the jitter buffer fill level.
+    /// @result {number} result.playoutCompressedTotal - The number of frames shortened by the adaptive playout.
+    /// @result {number} result.playoutStretchedTotal - The number of frames lengthened by the adaptive playout.
+    pRpcServer->HandleMethod ( "jamulusserver/getMixerStatistics", [=] ( const QJsonObject& params, QJsonObject& response ) {
+        const CTickLatenessHistogram& TickLateness = pServer->GetTickLatenessHistogram();
+        QJsonArray                    tickLateness;
+
+        for ( int i = 0; i < NUM_TICK_LATENESS_BINS; i++ )
+        {
+            QJsonObject bin{
+                { "upToUs", CTickLatenessHistogram::GetBinUpperBoundUs ( i ) },
+                { "count", static_cast<double> ( TickLateness.GetCount ( i ) ) },
+            };
+            tickLateness.append ( bin );
+        }
+
+        QJsonObject result{
+            { "realTimeMixer", pServer->IsRealTimeMixer() },
+            { "maxTickLatenessUs", TickLateness.GetMaxLatenessUs() },
+            { "tickLateness", tickLateness },
+            { "mixPairsLastTick", pServer->GetMixPairsLastTick() },
+            { "skippedMixPairsLastTick", pServer->GetSkippedMixPairsLastTick() },
+            { "mixPairsTotal", static_cast<double> ( pServer->GetMixPairsTotal() ) },
+            { "skippedMixPairsTotal", static_cast<double> ( pServer->GetSkippedMixPairsTotal() ) },
+            { "decodeOnArrival", pServer->IsDecodeOnArrival() },
+            { "arrivalDecodedBlocksTotal", static_cast<double> ( pServer->GetArrivalDecodedBlocksTotal() ) },
+            { "tickDecodedBlocksTotal", static_cast<double> ( pServer->GetTickDecodedBlocksTotal() ) },
+            { "arrivalDecodeTimeUsTotal", static_cast<double> ( pServer->GetArrivalDecodeTimeUsTotal() ) },
+            { "receiveBatchSize", pServer->GetReceiveBatchSize() },
+            { "avgReceiveBatchSize", pServer->GetAvgReceiveBatchSize() },
+            { "receiveSockets", pServer->GetNumReceiveSockets() },
+            { "ioUring", pServer->GetUseIoUring() },
+            { "jitterHistogram", pServer->GetUseJitterHistogram() },
+            { "inboundRing", pServer->GetUseInboundRing() },
+            { "inboundRingDropsTotal", static_cast<double> ( pServer->GetInboundRingDropsTotal() ) },
+            { "adaptivePlayout", pServer->GetUseAdaptivePlayout() },
+            { "playoutCompressedTotal", static_cast<double> ( pServer->GetPlayoutCompressedTotal() ) },
+            { "playoutStretchedTotal", static_cast<double> ( pServer->GetPlayoutStretchedTotal() ) },
+        };
+        response["result"] = result;
+        Q_UNUSED ( params );
+    } );
+
     /// @rpc_method jamulusserver/getServerProfile
     /// @brief Returns the server registration profile and status.
     /// @param {object} params - No parameters (empty object).
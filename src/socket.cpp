@@ -30,9 +30,47 @@
 #    include <ws2tcpip.h>
 #else
 #    include <arpa/inet.h>
+#    include <cerrno>
 #endif
 
 /* Implementation *************************************************************/
+// Send batch ------------------------------------------------------------------
+void CSendBatch::Init()
+{
+    vecbyData.Init ( MAX_SEND_BATCH_BYTES );
+    veciOffset.assign ( MAX_SEND_BATCH_SIZE, 0 );
+    veciNumBytes.assign ( MAX_SEND_BATCH_SIZE, 0 );
+    vecSockAddr.assign ( MAX_SEND_BATCH_SIZE, uSockAddr() );
+    veciSockAddrLen.assign ( MAX_SEND_BATCH_SIZE, 0 );
+#ifdef USE_SENDMMSG
+    vecIov.assign ( MAX_SEND_BATCH_SIZE, iovec() );
+    vecMsgHdr.assign ( MAX_SEND_BATCH_SIZE, mmsghdr() );
+#endif
+
+    Clear();
+}
+
+bool CSendBatch::Add ( const CVector<uint8_t>& vecbyNewData, const uSockAddr& SockAddr, const int iSockAddrLen )
+{
+    const int iNewNumBytes = vecbyNewData.Size();
+
+    if ( ( iNumPackets >= static_cast<int> ( veciOffset.size() ) ) || ( iNumBytes + iNewNumBytes > vecbyData.Size() ) )
+    {
+        return false;
+    }
+
+    std::copy ( vecbyNewData.begin(), vecbyNewData.end(), vecbyData.begin() + iNumBytes );
+
+    veciOffset[iNumPackets]      = iNumBytes;
+    veciNumBytes[iNumPackets]    = iNewNumBytes;
+    vecSockAddr[iNumPackets]     = SockAddr;
+    veciSockAddrLen[iNumPackets] = iSockAddrLen;
+
+    iNumPackets++;
+    iNumBytes += iNewNumBytes;
+
+    return true;
+}
 
 // Connections -------------------------------------------------------------
 // it is important to do the following connections in this class since we
@@ -44,7 +82,13 @@ CSocket::CSocket ( CChannel* pNewChannel, const quint16 iPortNumber, const quint
     pChannel ( pNewChannel ),
     bIsClient ( true ),
     bJitterBufferOK ( true ),
-    bEnableIPv6 ( bEnableIPv6 )
+    bEnableIPv6 ( bEnableIPv6 ),
+    bReusePort ( false ),
+    iRecvBatchSize ( 1 ),
+    iNumRecvCalls ( 0 ),
+    iNumRecvPackets ( 0 ),
+    bUseIoUringRecv ( false ),
+    bUseIoUringSend ( false )
 {
     Init ( iPortNumber, iQosNumber, strServerBindIP );
 
@@ -56,11 +100,22 @@ CSocket::CSocket ( CChannel* pNewChannel, const quint16 iPortNumber, const quint
     QObject::connect ( this, static_cast<void ( CSocket::* )()> ( &CSocket::NewConnection ), pChannel, &CChannel::OnNewConnection );
 }
 
-CSocket::CSocket ( CServer* pNServP, const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP, bool bEnableIPv6 ) :
+CSocket::CSocket ( CServer*       pNServP,
+                   const quint16  iPortNumber,
+                   const quint16  iQosNumber,
+                   const QString& strServerBindIP,
+                   bool           bEnableIPv6,
+                   const bool     bNReusePort ) :
     pServer ( pNServP ),
     bIsClient ( false ),
     bJitterBufferOK ( true ),
-    bEnableIPv6 ( bEnableIPv6 )
+    bEnableIPv6 ( bEnableIPv6 ),
+    bReusePort ( bNReusePort ),
+    iRecvBatchSize ( 1 ),
+    iNumRecvCalls ( 0 ),
+    iNumRecvPackets ( 0 ),
+    bUseIoUringRecv ( false ),
+    bUseIoUringSend ( false )
 {
     Init ( iPortNumber, iQosNumber, strServerBindIP );
 
@@ -213,6 +268,16 @@ void CSocket::Init ( const quint16 iNewPortNumber, const quint16 iNewQosNumber,
         // gets the desired port number
         *UdpPort = htons ( iPortNumber );
 
+#ifdef USE_RECV_SHARDING
+        if ( bReusePort )
+        {
+            // all receive sockets of the server are bound to the same port, the
+            // kernel assigns each client (address and port) to one of them
+            const int one = 1;
+            setsockopt ( UdpSocket, SOL_SOCKET, SO_REUSEPORT, &one, sizeof ( one ) );
+        }
+#endif
+
         bSuccess = ( ::bind ( UdpSocket, &UdpSocketAddr.sa, UdpSocketAddrLen ) == 0 );
     }
 
@@ -251,79 +316,31 @@ CSocket::~CSocket()
 #endif
 }
 
+bool CSocket::GetSockAddr ( const CHostAddress& HostAddr, uSockAddr& SockAddr, int& iSockAddrLen ) const
+{
+    // the native form is cached in the host address, no conversion is needed
+    return HostAddr.GetSockAddr ( &SockAddr.sa, iSockAddrLen, bEnableIPv6 );
+}
+
 void CSocket::SendPacket ( const CVector<uint8_t>& vecbySendBuf, const CHostAddress& HostAddr )
 {
     int status = 0;
 
     uSockAddr UdpSocketAddr;
-
-    memset ( &UdpSocketAddr, 0, sizeof ( UdpSocketAddr ) );
+    int       UdpSocketAddrLen;
 
     QMutexLocker locker ( &Mutex );
 
     const int iVecSizeOut = vecbySendBuf.Size();
 
-    if ( iVecSizeOut > 0 )
+    if ( ( iVecSizeOut > 0 ) && GetSockAddr ( HostAddr, UdpSocketAddr, UdpSocketAddrLen ) )
     {
-        // send packet through network (we have to convert the constant unsigned
-        // char vector in "const char*", for this we first convert the const
-        // uint8_t vector in a read/write uint8_t vector and then do the cast to
-        // const char *)
+        // send packet through network (the buffer is passed directly, without a
+        // temporary copy of the vector)
 
         for ( int tries = 0; tries < 2; tries++ ) // retry loop in case send fails on iOS
         {
-            if ( HostAddr.InetAddr.protocol() == QAbstractSocket::IPv4Protocol )
-            {
-                if ( bEnableIPv6 )
-                {
-                    // Linux and Mac allow to pass an AF_INET address to a dual-stack socket,
-                    // but Windows does not. So use a V4MAPPED address in an AF_INET6 sockaddr,
-                    // which works on all platforms.
-
-                    UdpSocketAddr.sa6.sin6_family = AF_INET6;
-                    UdpSocketAddr.sa6.sin6_port   = htons ( HostAddr.iPort );
-
-                    uint32_t* addr = (uint32_t*) &UdpSocketAddr.sa6.sin6_addr;
-
-                    addr[0] = 0;
-                    addr[1] = 0;
-                    addr[2] = htonl ( 0xFFFF );
-                    addr[3] = htonl ( HostAddr.InetAddr.toIPv4Address() );
-
-                    status = sendto ( UdpSocket,
-                                      (const char*) &( (CVector<uint8_t>) vecbySendBuf )[0],
-                                      iVecSizeOut,
-                                      0,
-                                      &UdpSocketAddr.sa,
-                                      sizeof ( UdpSocketAddr.sa6 ) );
-                }
-                else
-                {
-                    UdpSocketAddr.sa4.sin_family      = AF_INET;
-                    UdpSocketAddr.sa4.sin_port        = htons ( HostAddr.iPort );
-                    UdpSocketAddr.sa4.sin_addr.s_addr = htonl ( HostAddr.InetAddr.toIPv4Address() );
-
-                    status = sendto ( UdpSocket,
-                                      (const char*) &( (CVector<uint8_t>) vecbySendBuf )[0],
-                                      iVecSizeOut,
-                                      0,
-                                      &UdpSocketAddr.sa,
-                                      sizeof ( UdpSocketAddr.sa4 ) );
-                }
-            }
-            else if ( bEnableIPv6 )
-            {
-                UdpSocketAddr.sa6.sin6_family = AF_INET6;
-                UdpSocketAddr.sa6.sin6_port   = htons ( HostAddr.iPort );
-                inet_pton ( AF_INET6, HostAddr.InetAddr.toString().toLocal8Bit().constData(), &UdpSocketAddr.sa6.sin6_addr );
-
-                status = sendto ( UdpSocket,
-                                  (const char*) &( (CVector<uint8_t>) vecbySendBuf )[0],
-                                  iVecSizeOut,
-                                  0,
-                                  &UdpSocketAddr.sa,
-                                  sizeof ( UdpSocketAddr.sa6 ) );
-            }
+            status = sendto ( UdpSocket, (const char*) &vecbySendBuf[0], iVecSizeOut, 0, &UdpSocketAddr.sa, UdpSocketAddrLen );
 
             if ( status >= 0 )
             {
@@ -340,6 +357,55 @@ void CSocket::SendPacket ( const CVector<uint8_t>& vecbySendBuf, const CHostAddr
     }
 }
 
+void CSocket::SendBatch ( CSendBatch& Batch )
+{
+    // Note that the socket itself is thread safe, the mutex of SendPacket() is
+    // only required for the socket re-initialization on iOS (client only).
+#ifdef USE_SENDMMSG
+    for ( int i = 0; i < Batch.iNumPackets; i++ )
+    {
+        Batch.vecIov[i].iov_base = &Batch.vecbyData[Batch.veciOffset[i]];
+        Batch.vecIov[i].iov_len  = Batch.veciNumBytes[i];
+
+        Batch.vecMsgHdr[i].msg_hdr.msg_name    = &Batch.vecSockAddr[i];
+        Batch.vecMsgHdr[i].msg_hdr.msg_namelen = Batch.veciSockAddrLen[i];
+        Batch.vecMsgHdr[i].msg_hdr.msg_iov     = &Batch.vecIov[i];
+        Batch.vecMsgHdr[i].msg_hdr.msg_iovlen  = 1;
+    }
+
+#    ifdef USE_IO_URING
+    if ( Batch.pSendRing )
+    {
+        SendBatchIoUring ( Batch );
+        Batch.Clear();
+        return;
+    }
+#    endif
+
+    int iNumSent = 0;
+
+    while ( iNumSent < Batch.iNumPackets )
+    {
+        const int iRet = sendmmsg ( UdpSocket, &Batch.vecMsgHdr[iNumSent], Batch.iNumPackets - iNumSent, 0 );
+
+        // a packet which cannot be sent is dropped (like with sendto)
+        iNumSent += ( iRet > 0 ) ? iRet : 1;
+    }
+#else
+    for ( int i = 0; i < Batch.iNumPackets; i++ )
+    {
+        sendto ( UdpSocket,
+                 (const char*) &Batch.vecbyData[Batch.veciOffset[i]],
+                 Batch.veciNumBytes[i],
+                 0,
+                 &Batch.vecSockAddr[i].sa,
+                 Batch.veciSockAddrLen[i] );
+    }
+#endif
+
+    Batch.Clear();
+}
+
 bool CSocket::GetAndResetbJitterBufferOKFlag()
 {
     // check jitter buffer status
@@ -365,6 +431,18 @@ void CSocket::OnDataReceived()
         use the signal/slot mechanism (i.e. we use messages for that).
     */
 
+    if ( bUseIoUringRecv.load ( std::memory_order_relaxed ) )
+    {
+        OnDataReceivedIoUring();
+        return;
+    }
+
+    if ( iRecvBatchSize > 1 )
+    {
+        OnDataReceivedBatch();
+        return;
+    }
+
     // read block from network interface and query address of sender
     uSockAddr UdpSocketAddr;
 #ifdef _WIN32
@@ -381,25 +459,11 @@ void CSocket::OnDataReceived()
         return;
     }
 
-    if ( UdpSocketAddr.sa.sa_family == AF_INET6 )
-    {
-        if ( IN6_IS_ADDR_V4MAPPED ( &( UdpSocketAddr.sa6.sin6_addr ) ) )
-        {
-            const uint32_t addr = ( (const uint32_t*) ( &( UdpSocketAddr.sa6.sin6_addr ) ) )[3];
-            RecHostAddr.InetAddr.setAddress ( ntohl ( addr ) );
-        }
-        else
-        {
-            RecHostAddr.InetAddr.setAddress ( UdpSocketAddr.sa6.sin6_addr.s6_addr );
-        }
-        RecHostAddr.iPort = ntohs ( UdpSocketAddr.sa6.sin6_port );
-    }
-    else
-    {
-        // convert address of client
-        RecHostAddr.InetAddr.setAddress ( ntohl ( UdpSocketAddr.sa4.sin_addr.s_addr ) );
-        RecHostAddr.iPort = ntohs ( UdpSocketAddr.sa4.sin_port );
-    }
+    // update the receive statistics (only written by this thread)
+    iNumRecvCalls.store ( iNumRecvCalls.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    iNumRecvPackets.store ( iNumRecvPackets.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+
+    RecHostAddr.SetSockAddr ( &UdpSocketAddr.sa );
 
     // check if this is a protocol message
     int              iRecCounter;
@@ -431,7 +495,7 @@ void CSocket::OnDataReceived()
         {
             // client:
 
-            switch ( pChannel->PutAudioData ( vecbyRecBuf, iNumBytesRead, RecHostAddr ) )
+            switch ( pChannel->PutAudioData ( &vecbyRecBuf[0], iNumBytesRead, RecHostAddr ) )
             {
             case PS_AUDIO_ERR:
             case PS_GEN_ERROR:
@@ -459,25 +523,425 @@ void CSocket::OnDataReceived()
 
             int iCurChanID;
 
-            if ( pServer->PutAudioData ( vecbyRecBuf, iNumBytesRead, RecHostAddr, iCurChanID ) )
+            const bool bNewConnection = pServer->PutAudioData ( &vecbyRecBuf[0], iNumBytesRead, RecHostAddr, iCurChanID );
+
+            OnServerAudioDataPut ( iCurChanID, bNewConnection, RecHostAddr );
+        }
+    }
+}
+
+void CSocket::OnServerAudioDataPut ( const int iCurChanID, const bool bNewConnection, const CHostAddress& HostAddr )
+{
+    if ( bNewConnection )
+    {
+        // we have a new connection, emit a signal
+        emit NewConnection ( iCurChanID, pServer->GetNumberOfConnectedClients(), HostAddr );
+
+        // this was an audio packet, start server if it is in sleep mode
+        if ( !pServer->IsRunning() )
+        {
+            // (note that Qt will delete the event object when done)
+            QCoreApplication::postEvent ( pServer, new CCustomEvent ( MS_PACKET_RECEIVED, 0, 0 ) );
+        }
+    }
+
+    // check if no channel is available
+    if ( iCurChanID == INVALID_CHANNEL_ID )
+    {
+        // fire message for the state that no free channel is available
+        emit ServerFull ( HostAddr );
+    }
+}
+
+void CSocket::SetReceiveBatchSize ( const int iNewBatchSize )
+{
+#ifdef USE_RECVMMSG
+    // only the server puts the audio packets of a batch at once
+    iRecvBatchSize = bIsClient ? 1 : std::max ( 1, std::min ( iNewBatchSize, MAX_RECV_BATCH_SIZE ) );
+
+    if ( iRecvBatchSize <= 1 )
+    {
+        return;
+    }
+
+    // allocate all buffers of the batch, the message headers point to them
+    vecvecbyRecBatchBuf.Init ( iRecvBatchSize );
+    vecRecBatchHostAddr.Init ( iRecvBatchSize );
+    vecRecBatchSockAddr.assign ( iRecvBatchSize, uSockAddr() );
+    veciRecBatchNumBytes.assign ( iRecvBatchSize, 0 );
+    vecpbyRecBatchData.assign ( iRecvBatchSize, nullptr );
+    vecRecBatchPackets.assign ( iRecvBatchSize, SReceivedPacket() );
+    vecRecBatchIov.assign ( iRecvBatchSize, iovec() );
+    vecRecBatchMsgHdr.assign ( iRecvBatchSize, mmsghdr() );
+
+    for ( int i = 0; i < iRecvBatchSize; i++ )
+    {
+        vecvecbyRecBatchBuf[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
+
+        vecRecBatchIov[i].iov_base = &vecvecbyRecBatchBuf[i][0];
+        vecRecBatchIov[i].iov_len  = MAX_SIZE_BYTES_NETW_BUF;
+
+        vecRecBatchMsgHdr[i].msg_hdr.msg_iov    = &vecRecBatchIov[i];
+        vecRecBatchMsgHdr[i].msg_hdr.msg_iovlen = 1;
+        vecRecBatchMsgHdr[i].msg_hdr.msg_name   = &vecRecBatchSockAddr[i];
+    }
+#else
+    if ( iNewBatchSize > 1 )
+    {
+        qWarning() << "batched receive is not supported on this platform, receiving one packet per call";
+    }
+#endif
+}
+
+double CSocket::GetAvgReceiveBatchSize() const
+{
+    const int64_t iCurNumRecvCalls = iNumRecvCalls.load ( std::memory_order_relaxed );
+
+    if ( iCurNumRecvCalls == 0 )
+    {
+        return 0.0;
+    }
+
+    return static_cast<double> ( iNumRecvPackets.load ( std::memory_order_relaxed ) ) / iCurNumRecvCalls;
+}
+
+void CSocket::OnDataReceivedBatch()
+{
+#ifdef USE_RECVMMSG
+    // the name length is overwritten by the kernel on each call
+    for ( int i = 0; i < iRecvBatchSize; i++ )
+    {
+        vecRecBatchMsgHdr[i].msg_hdr.msg_namelen = sizeof ( uSockAddr );
+    }
+
+    // block until at least one datagram is available, then take all which
+    // are already queued (up to the batch size)
+    const int iNumMsgs = recvmmsg ( UdpSocket, &vecRecBatchMsgHdr[0], iRecvBatchSize, MSG_WAITFORONE, nullptr );
+
+    // check if an error occurred or no data could be read
+    if ( iNumMsgs <= 0 )
+    {
+        return;
+    }
+
+    for ( int i = 0; i < iNumMsgs; i++ )
+    {
+        veciRecBatchNumBytes[i] = static_cast<int> ( vecRecBatchMsgHdr[i].msg_len );
+        vecpbyRecBatchData[i]   = &vecvecbyRecBatchBuf[i][0];
+    }
+
+    ProcessReceivedBatch ( iNumMsgs );
+#endif
+}
+
+void CSocket::ProcessReceivedBatch ( const int iNumMsgs )
+{
+#ifdef USE_RECVMMSG
+    // update the receive statistics (only written by this thread)
+    iNumRecvCalls.store ( iNumRecvCalls.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    iNumRecvPackets.store ( iNumRecvPackets.load ( std::memory_order_relaxed ) + iNumMsgs, std::memory_order_relaxed );
+
+    // the protocol messages are handed over to the main thread right away, the
+    // audio packets are collected for the server
+    int iNumAudioPackets = 0;
+
+    for ( int i = 0; i < iNumMsgs; i++ )
+    {
+        const int      iNumBytesRead = veciRecBatchNumBytes[i];
+        const uint8_t* pbyData       = vecpbyRecBatchData[i];
+
+        if ( iNumBytesRead <= 0 )
+        {
+            continue;
+        }
+
+        vecRecBatchHostAddr[i].SetSockAddr ( &vecRecBatchSockAddr[i].sa );
+
+        // check if this is a protocol message
+        int              iRecCounter;
+        int              iRecID;
+        CVector<uint8_t> vecbyMesBodyData;
+        bool             bIsProtocolMessage = false;
+
+        if ( CProtocol::IsMessageFrameCandidate ( pbyData, iNumBytesRead ) )
+        {
+            // the parser needs the message in the batch buffer
+            if ( pbyData != &vecvecbyRecBatchBuf[i][0] )
+            {
+                std::copy ( pbyData, pbyData + iNumBytesRead, vecvecbyRecBatchBuf[i].begin() );
+            }
+
+            bIsProtocolMessage = !CProtocol::ParseMessageFrame ( vecvecbyRecBatchBuf[i], iNumBytesRead, vecbyMesBodyData, iRecCounter, iRecID );
+        }
+
+        if ( bIsProtocolMessage )
+        {
+            // this is a protocol message, check the type of the message
+            if ( CProtocol::IsConnectionLessMessageID ( iRecID ) )
+            {
+                emit ProtocolCLMessageReceived ( iRecID, vecbyMesBodyData, vecRecBatchHostAddr[i] );
+            }
+            else
+            {
+                emit ProtocolMessageReceived ( iRecCounter, iRecID, vecbyMesBodyData, vecRecBatchHostAddr[i] );
+            }
+        }
+        else
+        {
+            // this is most probably a regular audio packet
+            SReceivedPacket& Packet = vecRecBatchPackets[iNumAudioPackets++];
+
+            Packet.pbyData   = pbyData;
+            Packet.iNumBytes = iNumBytesRead;
+            Packet.pHostAddr = &vecRecBatchHostAddr[i];
+        }
+    }
+
+    if ( iNumAudioPackets > 0 )
+    {
+        pServer->PutAudioDataBatch ( &vecRecBatchPackets[0], iNumAudioPackets );
+
+        for ( int i = 0; i < iNumAudioPackets; i++ )
+        {
+            OnServerAudioDataPut ( vecRecBatchPackets[i].iChanID, vecRecBatchPackets[i].bNewConnection, *vecRecBatchPackets[i].pHostAddr );
+        }
+    }
+#endif
+}
+
+bool CSocket::SetUseIoUring ( const bool bEnable )
+{
+#ifdef USE_IO_URING
+    if ( !bEnable || bIsClient )
+    {
+        return false;
+    }
+
+    // the completions are handed over in batches, i.e. the batch buffers are required
+    if ( iRecvBatchSize <= 1 )
+    {
+        SetReceiveBatchSize ( MAX_RECV_BATCH_SIZE );
+    }
+
+    // each provided buffer holds the receive header, the sender address and the payload
+    const int iRecvBufSize = static_cast<int> ( sizeof ( io_uring_recvmsg_out ) + sizeof ( uSockAddr ) ) + MAX_SIZE_BYTES_NETW_BUF;
+
+    // the multishot receive may post one completion per provided buffer
+    if ( !RecvRing.Init ( 64, 2 * IO_URING_RECV_NUM_BUFS ) || !RecvRing.RegisterBufRing ( 0, IO_URING_RECV_NUM_BUFS, iRecvBufSize ) )
+    {
+        RecvRing.Close();
+        return false;
+    }
+
+    // the message header only defines the sender address length, the data is
+    // written to the provided buffers
+    memset ( &RecvRingMsgHdr, 0, sizeof ( RecvRingMsgHdr ) );
+    RecvRingMsgHdr.msg_namelen = sizeof ( uSockAddr );
+
+    bRecvRingArmed  = false;
+    bUseIoUringSend = true;
+    veciRecvRingBufIDs.reserve ( iRecvBatchSize );
+    bUseIoUringRecv.store ( true, std::memory_order_relaxed );
+
+    return true;
+#else
+    if ( bEnable )
+    {
+        qWarning() << "io_uring is not supported on this platform";
+    }
+
+    return false;
+#endif
+}
+
+void CSocket::PrepareSendBatch ( CSendBatch& Batch )
+{
+#ifdef USE_IO_URING
+    // each sending thread has its own ring (one submission per packet of the batch)
+    if ( !bUseIoUringSend || Batch.pSendRing )
+    {
+        return;
+    }
+
+    std::unique_ptr<CIoUring> pRing ( new CIoUring() );
+
+    if ( pRing->Init ( MAX_SEND_BATCH_SIZE ) )
+    {
+        Batch.pSendRing = std::move ( pRing );
+    }
+#else
+    Q_UNUSED ( Batch )
+#endif
+}
+
+void CSocket::SendBatchIoUring ( CSendBatch& Batch )
+{
+#ifdef USE_IO_URING
+    // one send request per packet, all are submitted with one system call and
+    // the batch buffers must stay valid until all completions are reaped
+    CIoUring&    Ring         = *Batch.pSendRing;
+    int          iNumPending  = 0;
+    unsigned int iNumPrepared = 0;
+
+    for ( int i = 0; i < Batch.iNumPackets; i++ )
+    {
+        struct io_uring_sqe* pSqe = Ring.GetSqe();
+
+        if ( pSqe == nullptr )
+        {
+            // the submission queue is full, submit the prepared requests first
+            // (if this fails, the remaining packets are dropped)
+            const int iNumSubmitted = Ring.Submit();
+
+            if ( iNumSubmitted <= 0 )
+            {
+                break;
+            }
+
+            iNumPending += iNumSubmitted;
+            iNumPrepared = 0;
+            i--;
+            continue;
+        }
+
+        pSqe->opcode = IORING_OP_SENDMSG;
+        pSqe->fd     = UdpSocket;
+        pSqe->addr   = reinterpret_cast<uint64_t> ( &Batch.vecMsgHdr[i].msg_hdr );
+        pSqe->len    = 1;
+        iNumPrepared++;
+    }
+
+    if ( iNumPrepared > 0 )
+    {
+        iNumPending += std::max ( 0, Ring.Submit() );
+    }
+
+    // the requests which were not taken by the kernel are dropped, otherwise
+    // they would be submitted with the next batch which reuses the buffers
+    Ring.DiscardUnsubmitted();
+
+    // a packet which cannot be sent is dropped (like with sendto), but all
+    // submitted requests must be completed before the buffers can be reused
+    while ( iNumPending > 0 )
+    {
+        struct io_uring_cqe* pCqe = Ring.PeekCqe();
+
+        if ( pCqe == nullptr )
+        {
+            if ( ( Ring.Submit ( 1, IO_URING_WAIT_TIMEOUT_MS ) < 0 ) && ( errno != EINTR ) && ( errno != ETIME ) && ( errno != EAGAIN ) &&
+                 ( errno != EBUSY ) )
             {
-                // we have a new connection, emit a signal
-                emit NewConnection ( iCurChanID, pServer->GetNumberOfConnectedClients(), RecHostAddr );
-
-                // this was an audio packet, start server if it is in sleep mode
-                if ( !pServer->IsRunning() )
-                {
-                    // (note that Qt will delete the event object when done)
-                    QCoreApplication::postEvent ( pServer, new CCustomEvent ( MS_PACKET_RECEIVED, 0, 0 ) );
-                }
+                // the ring cannot be used anymore, the kernel cancels the pending
+                // requests when it is closed and the batch falls back to sendmmsg
+                qWarning() << "io_uring send failed, falling back to sendmmsg:" << strerror ( errno );
+                Batch.pSendRing.reset();
+                return;
             }
 
-            // check if no channel is available
-            if ( iCurChanID == INVALID_CHANNEL_ID )
+            continue;
+        }
+
+        Ring.AdvanceCq();
+        iNumPending--;
+    }
+#else
+    Q_UNUSED ( Batch )
+#endif
+}
+
+void CSocket::OnDataReceivedIoUring()
+{
+#ifdef USE_IO_URING
+    // (re-)arm the multishot receive, it stays active until the kernel ends it
+    // (e.g. if no provided buffer was available)
+    if ( !bRecvRingArmed )
+    {
+        struct io_uring_sqe* pSqe = RecvRing.GetSqe();
+
+        if ( pSqe != nullptr )
+        {
+            pSqe->opcode    = IORING_OP_RECVMSG;
+            pSqe->fd        = UdpSocket;
+            pSqe->addr      = reinterpret_cast<uint64_t> ( &RecvRingMsgHdr );
+            pSqe->len       = 1;
+            pSqe->ioprio    = IORING_RECV_MULTISHOT;
+            pSqe->flags     = IOSQE_BUFFER_SELECT;
+            pSqe->buf_group = 0;
+
+            bRecvRingArmed = true;
+        }
+    }
+
+    // wait for at least one completion, a closed socket does not wake up the
+    // ring so the wait is limited to be able to leave the receive thread
+    RecvRing.Submit ( 1, IO_URING_WAIT_TIMEOUT_MS );
+
+    int                  iNumMsgs = 0;
+    struct io_uring_cqe* pCqe;
+
+    veciRecvRingBufIDs.clear();
+
+    while ( ( iNumMsgs < iRecvBatchSize ) && ( ( pCqe = RecvRing.PeekCqe() ) != nullptr ) )
+    {
+        const int      iRes   = pCqe->res;
+        const uint32_t iFlags = pCqe->flags;
+
+        RecvRing.AdvanceCq();
+
+        if ( !( iFlags & IORING_CQE_F_MORE ) )
+        {
+            bRecvRingArmed = false;
+        }
+
+        if ( iRes < 0 )
+        {
+            if ( ( iRes == -EINVAL ) || ( iRes == -EOPNOTSUPP ) )
             {
-                // fire message for the state that no free channel is available
-                emit ServerFull ( RecHostAddr );
+                // the kernel does not support the multishot receive, use the
+                // regular receive path from now on
+                qWarning() << "io_uring multishot receive is not supported, using the regular receive path";
+                bUseIoUringRecv.store ( false, std::memory_order_relaxed );
+                break;
             }
+
+            // e.g. -ENOBUFS: the receive is armed again on the next call
+            continue;
         }
+
+        if ( !( iFlags & IORING_CQE_F_BUFFER ) )
+        {
+            continue;
+        }
+
+        const int                   iBufID = static_cast<int> ( iFlags >> IORING_CQE_BUFFER_SHIFT );
+        const uint8_t*              pBuf   = RecvRing.GetBuf ( iBufID );
+        const io_uring_recvmsg_out* pOut   = reinterpret_cast<const io_uring_recvmsg_out*> ( pBuf );
+
+        // truncated datagrams cannot be valid Jamulus packets
+        if ( !( pOut->flags & MSG_TRUNC ) && ( pOut->namelen <= sizeof ( uSockAddr ) ) && ( pOut->payloadlen > 0 ) &&
+             ( pOut->payloadlen <= MAX_SIZE_BYTES_NETW_BUF ) )
+        {
+            // the sender address follows the header, the payload follows the
+            // address area (which has the size given in the message header),
+            // the payload is used in place and copied to the jitter buffer
+            memcpy ( &vecRecBatchSockAddr[iNumMsgs], pBuf + sizeof ( io_uring_recvmsg_out ), pOut->namelen );
+
+            vecpbyRecBatchData[iNumMsgs]     = pBuf + sizeof ( io_uring_recvmsg_out ) + RecvRingMsgHdr.msg_namelen;
+            veciRecBatchNumBytes[iNumMsgs++] = static_cast<int> ( pOut->payloadlen );
+        }
+
+        veciRecvRingBufIDs.push_back ( iBufID );
+    }
+
+    if ( iNumMsgs > 0 )
+    {
+        ProcessReceivedBatch ( iNumMsgs );
     }
+
+    // the provided buffers can only be reused after the batch was processed
+    for ( const int iBufID : veciRecvRingBufIDs )
+    {
+        RecvRing.RecycleBuf ( iBufID );
+    }
+#endif
 }
@@ -28,9 +28,12 @@
 #include <QThread>
 #include <QMutex>
 #include <vector>
+#include <atomic>
+#include <memory>
 #include "global.h"
 #include "protocol.h"
 #include "util.h"
+#include "iouring.h"
 #ifndef _WIN32
 #    include <netinet/in.h>
 #    include <sys/socket.h>
@@ -46,7 +49,89 @@ class CChannel; // forward declaration of CChannel
 // number of ports we try to bind until we give up
 #define NUM_SOCKET_PORTS_TO_TRY 100
 
+// maximum number of datagrams which are received with one system call
+#define MAX_RECV_BATCH_SIZE 64
+
+// limits of a batch of packets which is sent with one system call
+#define MAX_SEND_BATCH_SIZE  64
+#define MAX_SEND_BATCH_BYTES 65536
+
+// maximum number of server sockets which receive on the same port
+#define MAX_NUM_RECV_SOCKETS 16
+
+// io_uring backend (see USE_IO_URING): number of provided receive buffers and
+// the maximum time the receive thread waits for completions (the thread checks
+// its stop condition in between)
+#define IO_URING_RECV_NUM_BUFS   256
+#define IO_URING_WAIT_TIMEOUT_MS 100
+
+// batched receive/send with recvmmsg()/sendmmsg() is only available on Linux,
+// the same is true for SO_REUSEPORT with load balancing of UDP sockets
+#if defined( __linux__ ) && !defined( ANDROID )
+#    define USE_RECVMMSG
+#    define USE_SENDMMSG
+#    define USE_RECV_SHARDING
+#endif
+
+// overlay generic, IPv4 and IPv6 sockaddr structures
+typedef union
+{
+    struct sockaddr     sa;
+    struct sockaddr_in  sa4;
+    struct sockaddr_in6 sa6;
+} uSockAddr;
+
+// audio packet of a receive batch which is handed over to the server
+struct SReceivedPacket
+{
+    const uint8_t*      pbyData;
+    int                 iNumBytes;
+    const CHostAddress* pHostAddr;
+    int                 iChanID;        // set by the server
+    bool                bNewConnection; // set by the server
+};
+
 /* Classes ********************************************************************/
+/* Batch of packets to send ------------------------------------------------- */
+// Collects the packets of one thread with their already converted destination
+// addresses, all memory is allocated in Init() so that no memory allocation
+// is done when packets are added in the real-time thread.
+class CSendBatch
+{
+public:
+    CSendBatch() : iNumPackets ( 0 ), iNumBytes ( 0 ) {}
+
+    void Init();
+
+    // returns false if the packet does not fit in the batch anymore
+    bool Add ( const CVector<uint8_t>& vecbyData, const uSockAddr& SockAddr, const int iSockAddrLen );
+
+    bool IsEmpty() const { return iNumPackets == 0; }
+    void Clear()
+    {
+        iNumPackets = 0;
+        iNumBytes   = 0;
+    }
+
+protected:
+    friend class CSocket;
+
+    CVector<uint8_t>       vecbyData; // the packets are stored one after the other
+    std::vector<int>       veciOffset;
+    std::vector<int>       veciNumBytes;
+    std::vector<uSockAddr> vecSockAddr;
+    std::vector<int>       veciSockAddrLen;
+    int                    iNumPackets;
+    int                    iNumBytes;
+#ifdef USE_SENDMMSG
+    std::vector<struct iovec>   vecIov;
+    std::vector<struct mmsghdr> vecMsgHdr;
+#endif
+#ifdef USE_IO_URING
+    std::unique_ptr<CIoUring> pSendRing; // only set if the io_uring backend is used
+#endif
+};
+
 /* Base socket class -------------------------------------------------------- */
 class CSocket : public QObject
 {
@@ -54,17 +139,45 @@ class CSocket : public QObject
 
 public:
     CSocket ( CChannel* pNewChannel, const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP, bool bEnableIPv6 );
-    CSocket ( CServer* pNServP, const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP, bool bEnableIPv6 );
+    CSocket ( CServer*       pNServP,
+              const quint16  iPortNumber,
+              const quint16  iQosNumber,
+              const QString& strServerBindIP,
+              bool           bEnableIPv6,
+              const bool     bNReusePort = false );
 
     virtual ~CSocket();
 
     void SendPacket ( const CVector<uint8_t>& vecbySendBuf, const CHostAddress& HostAddr );
 
+    // sends all packets of the batch and clears it (thread safe without a lock,
+    // each thread must use its own batch)
+    void SendBatch ( CSendBatch& Batch );
+
+    // convert the address for sending (returns false if it cannot be used with this socket)
+    bool GetSockAddr ( const CHostAddress& HostAddr, uSockAddr& SockAddr, int& iSockAddrLen ) const;
+
     bool GetAndResetbJitterBufferOKFlag();
     void Close();
 
+    // must be called before the receive thread is started (server only)
+    void   SetReceiveBatchSize ( const int iNewBatchSize );
+    int    GetReceiveBatchSize() const { return iRecvBatchSize; }
+    double GetAvgReceiveBatchSize() const;
+
+    // io_uring backend, must be called before the receive thread is started
+    // (server only, returns false if io_uring is not available)
+    bool SetUseIoUring ( const bool bEnable );
+    bool GetUseIoUring() const { return bUseIoUringRecv.load ( std::memory_order_relaxed ); }
+    void PrepareSendBatch ( CSendBatch& Batch );
+
 protected:
     void    Init ( const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP );
+    void    OnDataReceivedBatch();
+    void    OnDataReceivedIoUring();
+    void    SendBatchIoUring ( CSendBatch& Batch );
+    void    ProcessReceivedBatch ( const int iNumMsgs );
+    void    OnServerAudioDataPut ( const int iCurChanID, const bool bNewConnection, const CHostAddress& HostAddr );
     quint16 iPortNumber;
     quint16 iQosNumber;
     QString strServerBindIP;
@@ -91,6 +204,37 @@ protected:
 
     bool bEnableIPv6;
 
+    // several server sockets share the port (see USE_RECV_SHARDING)
+    bool bReusePort;
+
+    // batched receive: one system call receives up to iRecvBatchSize datagrams
+    // in the pre-allocated buffers (the audio packets are put in the jitter
+    // buffers of the server under one lock)
+    int                          iRecvBatchSize;
+    CVector<CVector<uint8_t>>    vecvecbyRecBatchBuf;
+    CVector<CHostAddress>        vecRecBatchHostAddr;
+    std::vector<uSockAddr>       vecRecBatchSockAddr;
+    std::vector<int>             veciRecBatchNumBytes;
+    std::vector<const uint8_t*>  vecpbyRecBatchData; // batch buffer or io_uring provided buffer
+    std::vector<SReceivedPacket> vecRecBatchPackets;
+#ifdef USE_RECVMMSG
+    std::vector<struct iovec>   vecRecBatchIov;
+    std::vector<struct mmsghdr> vecRecBatchMsgHdr;
+#endif
+    std::atomic<int64_t> iNumRecvCalls;
+    std::atomic<int64_t> iNumRecvPackets;
+
+    // io_uring backend: a multishot receive fills the provided buffers, the
+    // completions are handled in the receive thread
+    std::atomic<bool> bUseIoUringRecv;
+    bool              bUseIoUringSend;
+#ifdef USE_IO_URING
+    CIoUring         RecvRing;
+    struct msghdr    RecvRingMsgHdr;
+    bool             bRecvRingArmed;
+    std::vector<int> veciRecvRingBufIDs; // provided buffers of the current batch
+#endif
+
 public:
     void OnDataReceived();
 
@@ -131,8 +275,13 @@ public:
         Init();
     }
 
-    CHighPrioSocket ( CServer* pNewServer, const quint16 iPortNumber, const quint16 iQosNumber, const QString& strServerBindIP, bool bEnableIPv6 ) :
-        Socket ( pNewServer, iPortNumber, iQosNumber, strServerBindIP, bEnableIPv6 )
+    CHighPrioSocket ( CServer*       pNewServer,
+                      const quint16  iPortNumber,
+                      const quint16  iQosNumber,
+                      const QString& strServerBindIP,
+                      bool           bEnableIPv6,
+                      const bool     bReusePort = false ) :
+        Socket ( pNewServer, iPortNumber, iQosNumber, strServerBindIP, bEnableIPv6, bReusePort )
     {
         Init();
     }
@@ -148,8 +297,23 @@ public:
 
     void SendPacket ( const CVector<uint8_t>& vecbySendBuf, const CHostAddress& HostAddr ) { Socket.SendPacket ( vecbySendBuf, HostAddr ); }
 
+    void SendBatch ( CSendBatch& Batch ) { Socket.SendBatch ( Batch ); }
+
+    bool GetSockAddr ( const CHostAddress& HostAddr, uSockAddr& SockAddr, int& iSockAddrLen ) const
+    {
+        return Socket.GetSockAddr ( HostAddr, SockAddr, iSockAddrLen );
+    }
+
     bool GetAndResetbJitterBufferOKFlag() { return Socket.GetAndResetbJitterBufferOKFlag(); }
 
+    void   SetReceiveBatchSize ( const int iNewBatchSize ) { Socket.SetReceiveBatchSize ( iNewBatchSize ); }
+    int    GetReceiveBatchSize() const { return Socket.GetReceiveBatchSize(); }
+    double GetAvgReceiveBatchSize() const { return Socket.GetAvgReceiveBatchSize(); }
+
+    bool SetUseIoUring ( const bool bEnable ) { return Socket.SetUseIoUring ( bEnable ); }
+    bool GetUseIoUring() const { return Socket.GetUseIoUring(); }
+    void PrepareSendBatch ( CSendBatch& Batch ) { Socket.PrepareSendBatch ( Batch ); }
+
 protected:
     class CSocketThread : public QThread
     {
@@ -214,11 +378,3 @@ protected:
 signals:
     void InvalidPacketReceived ( CHostAddress RecHostAddr );
 };
-
-// overlay generic, IPv4 and IPv6 sockaddr structures
-typedef union
-{
-    struct sockaddr     sa;
-    struct sockaddr_in  sa4;
-    struct sockaddr_in6 sa6;
-} uSockAddr;
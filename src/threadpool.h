@@ -34,6 +34,9 @@
 #include <future>
 #include <functional>
 #include <stdexcept>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
 
 class CThreadPool
 {
@@ -119,4 +122,298 @@ inline CThreadPool::~CThreadPool()
         worker.join();
 }
 
+// Pool for the per-tick fan-out of the server: all task slots are allocated in
+// the constructor, the workers spin for a short time before they park so that
+// the next fan-out usually does not need a context switch and the calling
+// thread waits on a reusable epoch barrier instead of futures. Enqueue() and
+// RunAndWait() must always be called from the same thread.
+template<class TArg>
+class CTickWorkerPool
+{
+public:
+    typedef void ( *TTaskFct ) ( TArg* pArg, const int iStart, const int iStop, const int iNumItems );
+
+    CTickWorkerPool ( size_t threads, size_t max_tasks, int spin_count = 1000 );
+    ~CTickWorkerPool();
+
+    // add a task to the current fan-out (does not allocate memory)
+    void Enqueue ( TTaskFct pFct, TArg* pArg, const int iStart, const int iStop, const int iNumItems );
+
+    // start the enqueued tasks, take part in processing them and return if all are done
+    void RunAndWait();
+
+    // the worker threads (e.g. for setting their scheduling policy)
+    std::vector<std::thread>& GetThreads() { return workers; }
+
+private:
+    struct STask
+    {
+        TTaskFct pFct;
+        TArg*    pArg;
+        int      iStart;
+        int      iStop;
+        int      iNumItems;
+    };
+
+    // the task state is a single atomic so that a task can only be claimed for
+    // the currently published fan-out: [epoch (32 bit) | number of tasks (16 bit) | next task (16 bit)]
+    static uint32_t GetEpoch ( const uint64_t state ) { return static_cast<uint32_t> ( state >> 32 ); }
+    static int      GetNumTasks ( const uint64_t state ) { return static_cast<int> ( ( state >> 16 ) & 0xFFFF ); }
+    static int      GetNextTask ( const uint64_t state ) { return static_cast<int> ( state & 0xFFFF ); }
+
+    void WorkerLoop();
+    void ProcessTasks();
+
+    std::vector<std::thread> workers;
+    std::vector<STask>       tasks;
+    int                      num_tasks;
+    int                      spin_count;
+
+    std::atomic<uint64_t> task_state;
+    std::atomic<int>      num_pending;
+    std::atomic<int>      num_parked;
+    std::atomic<bool>     stop;
+
+    // only used for parking the workers
+    std::mutex              park_mutex;
+    std::condition_variable park_condition;
+};
+
+template<class TArg>
+CTickWorkerPool<TArg>::CTickWorkerPool ( size_t threads, size_t max_tasks, int spin_count ) :
+    tasks ( std::min<size_t> ( max_tasks, 0xFFFF ) ),
+    num_tasks ( 0 ),
+    spin_count ( spin_count ),
+    task_state ( 0 ),
+    num_pending ( 0 ),
+    num_parked ( 0 ),
+    stop ( false )
+{
+    for ( size_t i = 0; i < threads; ++i )
+    {
+        workers.emplace_back ( [this] { WorkerLoop(); } );
+    }
+}
+
+template<class TArg>
+void CTickWorkerPool<TArg>::Enqueue ( TTaskFct pFct, TArg* pArg, const int iStart, const int iStop, const int iNumItems )
+{
+    if ( num_tasks >= static_cast<int> ( tasks.size() ) )
+    {
+        // no free slot, process the task directly
+        pFct ( pArg, iStart, iStop, iNumItems );
+        return;
+    }
+
+    tasks[num_tasks++] = { pFct, pArg, iStart, iStop, iNumItems };
+}
+
+template<class TArg>
+void CTickWorkerPool<TArg>::RunAndWait()
+{
+    if ( num_tasks == 0 )
+    {
+        return;
+    }
+
+    num_pending.store ( num_tasks, std::memory_order_relaxed );
+
+    // publish the new fan-out (the slots are not touched by the workers until then)
+    const uint64_t epoch = GetEpoch ( task_state.load ( std::memory_order_relaxed ) ) + 1;
+    task_state.store ( ( epoch << 32 ) | ( static_cast<uint64_t> ( num_tasks ) << 16 ) );
+
+    // wake up parked workers (a worker checks the task state while holding the
+    // mutex before it parks, therefore no wake up can get lost)
+    if ( num_parked.load() > 0 )
+    {
+        std::unique_lock<std::mutex> lock ( park_mutex );
+        park_condition.notify_all();
+    }
+
+    // the calling thread takes part in the processing
+    ProcessTasks();
+
+    // epoch barrier: wait for the tasks which are still processed by the workers
+    while ( num_pending.load ( std::memory_order_acquire ) > 0 )
+    {
+        std::this_thread::yield();
+    }
+
+    num_tasks = 0;
+}
+
+template<class TArg>
+void CTickWorkerPool<TArg>::ProcessTasks()
+{
+    uint64_t state = task_state.load ( std::memory_order_acquire );
+
+    while ( GetNextTask ( state ) < GetNumTasks ( state ) )
+    {
+        // claim the next task of the current fan-out
+        if ( task_state.compare_exchange_weak ( state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire ) )
+        {
+            const STask& task = tasks[GetNextTask ( state )];
+
+            task.pFct ( task.pArg, task.iStart, task.iStop, task.iNumItems );
+
+            num_pending.fetch_sub ( 1, std::memory_order_acq_rel );
+            state = task_state.load ( std::memory_order_acquire );
+        }
+    }
+}
+
+template<class TArg>
+void CTickWorkerPool<TArg>::WorkerLoop()
+{
+    uint32_t last_epoch = GetEpoch ( task_state.load() );
+
+    for ( ;; )
+    {
+        // spin for a short time to catch the next fan-out without a context switch
+        for ( int i = 0; ( i < spin_count ) && ( GetEpoch ( task_state.load ( std::memory_order_acquire ) ) == last_epoch ) && !stop.load(); i++ )
+        {
+            std::this_thread::yield();
+        }
+
+        // nothing to do, park until the next fan-out
+        if ( ( GetEpoch ( task_state.load() ) == last_epoch ) && !stop.load() )
+        {
+            std::unique_lock<std::mutex> lock ( park_mutex );
+            num_parked.fetch_add ( 1 );
+            park_condition.wait ( lock, [this, last_epoch] { return stop.load() || ( GetEpoch ( task_state.load() ) != last_epoch ); } );
+            num_parked.fetch_sub ( 1 );
+        }
+
+        if ( stop.load() )
+        {
+            return;
+        }
+
+        last_epoch = GetEpoch ( task_state.load ( std::memory_order_acquire ) );
+
+        ProcessTasks();
+    }
+}
+
+// the destructor joins all threads
+template<class TArg>
+CTickWorkerPool<TArg>::~CTickWorkerPool()
+{
+    {
+        std::unique_lock<std::mutex> lock ( park_mutex );
+        stop = true;
+    }
+    park_condition.notify_all();
+    for ( std::thread& worker : workers )
+        worker.join();
+}
+
+// Single worker thread which processes items (e.g. channel IDs) posted by any
+// other thread. An item which is posted again before it was processed is only
+// queued once, therefore the queue is allocated in the constructor and can
+// never overflow.
+template<class TArg>
+class CItemWorker
+{
+public:
+    typedef void ( *TItemFct ) ( TArg* pArg, const int iItem );
+
+    CItemWorker ( TItemFct pFct, TArg* pArg, const int max_items );
+    ~CItemWorker();
+
+    // queue an item in the range [0, max_items) for processing
+    void Post ( const int iItem );
+
+    // the worker thread (e.g. for setting its scheduling policy)
+    std::thread& GetThread() { return worker; }
+
+private:
+    void WorkerLoop();
+
+    TItemFct          pFct;
+    TArg*             pArg;
+    std::vector<int>  items; // ring buffer
+    std::vector<char> pending;
+    int               read_pos;
+    int               num_items;
+    bool              stop;
+
+    std::mutex              queue_mutex;
+    std::condition_variable condition;
+    std::thread             worker;
+};
+
+template<class TArg>
+CItemWorker<TArg>::CItemWorker ( TItemFct pFct, TArg* pArg, const int max_items ) :
+    pFct ( pFct ),
+    pArg ( pArg ),
+    items ( max_items ),
+    pending ( max_items, 0 ),
+    read_pos ( 0 ),
+    num_items ( 0 ),
+    stop ( false )
+{
+    worker = std::thread ( [this] { WorkerLoop(); } );
+}
+
+template<class TArg>
+void CItemWorker<TArg>::Post ( const int iItem )
+{
+    {
+        std::unique_lock<std::mutex> lock ( queue_mutex );
+
+        if ( pending[iItem] )
+        {
+            return;
+        }
+
+        const int write_pos = ( read_pos + num_items ) % static_cast<int> ( items.size() );
+
+        pending[iItem]   = 1;
+        items[write_pos] = iItem;
+        num_items++;
+    }
+    condition.notify_one();
+}
+
+template<class TArg>
+void CItemWorker<TArg>::WorkerLoop()
+{
+    for ( ;; )
+    {
+        int iItem;
+
+        {
+            std::unique_lock<std::mutex> lock ( queue_mutex );
+            condition.wait ( lock, [this] { return stop || ( num_items > 0 ); } );
+
+            if ( stop )
+            {
+                return;
+            }
+
+            iItem    = items[read_pos];
+            read_pos = ( read_pos + 1 ) % static_cast<int> ( items.size() );
+            num_items--;
+
+            // the item may be posted again while it is processed
+            pending[iItem] = 0;
+        }
+
+        pFct ( pArg, iItem );
+    }
+}
+
+// the destructor joins the thread, items which are still queued are dropped
+template<class TArg>
+CItemWorker<TArg>::~CItemWorker()
+{
+    {
+        std::unique_lock<std::mutex> lock ( queue_mutex );
+        stop = true;
+    }
+    condition.notify_all();
+    worker.join();
+}
+
 #endif
@@ -23,10 +23,19 @@
 \******************************************************************************/
 
 #include "util.h"
+#include <climits>
+#include <cstring>
+#include <thread>
+#ifndef _WIN32
+#    include <arpa/inet.h>
+#    include <pthread.h>
+#    include <sched.h>
+#endif
 
 /* Implementation *************************************************************/
 // Input level meter implementation --------------------------------------------
-void CStereoSignalLevelMeter::Update ( const CVector<short>& vecsAudio, const int iMonoBlockSizeSam, const bool bIsStereoIn )
+template<typename TSample>
+void CStereoSignalLevelMeter::UpdateFromBlock ( const TSample* pAudio, const int iMonoBlockSizeSam, const bool bIsStereoIn, const double dScale )
 {
     // Get maximum of current block
     //
@@ -38,8 +47,8 @@ void CStereoSignalLevelMeter::Update ( const CVector<short>& vecsAudio, const in
     // With these speed optimizations we might loose some information in
     // special cases but for the average music signals the following code
     // should give good results.
-    short sMinLOrMono = 0;
-    short sMinR       = 0;
+    TSample tMinLOrMono = 0;
+    TSample tMinR       = 0;
 
     if ( bIsStereoIn )
     {
@@ -47,14 +56,14 @@ void CStereoSignalLevelMeter::Update ( const CVector<short>& vecsAudio, const in
         for ( int i = 0; i < 2 * iMonoBlockSizeSam; i += 6 ) // 2 * 3 = 6 -> stereo
         {
             // left (or mono) and right channel
-            sMinLOrMono = std::min ( sMinLOrMono, vecsAudio[i] );
-            sMinR       = std::min ( sMinR, vecsAudio[i + 1] );
+            tMinLOrMono = std::min ( tMinLOrMono, pAudio[i] );
+            tMinR       = std::min ( tMinR, pAudio[i + 1] );
         }
 
         // in case of mono out use minimum of both channels
         if ( !bIsStereoOut )
         {
-            sMinLOrMono = std::min ( sMinLOrMono, sMinR );
+            tMinLOrMono = std::min ( tMinLOrMono, tMinR );
         }
     }
     else
@@ -62,19 +71,41 @@ void CStereoSignalLevelMeter::Update ( const CVector<short>& vecsAudio, const in
         // mono in
         for ( int i = 0; i < iMonoBlockSizeSam; i += 3 )
         {
-            sMinLOrMono = std::min ( sMinLOrMono, vecsAudio[i] );
+            tMinLOrMono = std::min ( tMinLOrMono, pAudio[i] );
         }
     }
 
     // apply smoothing, if in stereo out mode, do this for two channels
-    dCurLevelLOrMono = UpdateCurLevel ( dCurLevelLOrMono, -sMinLOrMono );
+    dCurLevelLOrMono = UpdateCurLevel ( dCurLevelLOrMono, -static_cast<double> ( tMinLOrMono ) * dScale );
 
     if ( bIsStereoOut )
     {
-        dCurLevelR = UpdateCurLevel ( dCurLevelR, -sMinR );
+        dCurLevelR = UpdateCurLevel ( dCurLevelR, -static_cast<double> ( tMinR ) * dScale );
     }
 }
 
+void CStereoSignalLevelMeter::Update ( const CVector<short>& vecsAudio, const int iMonoBlockSizeSam, const bool bIsStereoIn )
+{
+    UpdateFromBlock ( &vecsAudio[0], iMonoBlockSizeSam, bIsStereoIn, 1.0 );
+}
+
+void CStereoSignalLevelMeter::Update ( const short* psAudio, const int iMonoBlockSizeSam, const bool bIsStereoIn )
+{
+    UpdateFromBlock ( psAudio, iMonoBlockSizeSam, bIsStereoIn, 1.0 );
+}
+
+void CStereoSignalLevelMeter::Update ( const CVector<float>& vecfAudio, const int iMonoBlockSizeSam, const bool bIsStereoIn )
+{
+    // the meter works on the int16 scale
+    UpdateFromBlock ( &vecfAudio[0], iMonoBlockSizeSam, bIsStereoIn, _MAXSHORT );
+}
+
+void CStereoSignalLevelMeter::Update ( const float* pfAudio, const int iMonoBlockSizeSam, const bool bIsStereoIn )
+{
+    // the meter works on the int16 scale
+    UpdateFromBlock ( pfAudio, iMonoBlockSizeSam, bIsStereoIn, _MAXSHORT );
+}
+
 double CStereoSignalLevelMeter::UpdateCurLevel ( double dCurLevel, const double dMax )
 {
     // decrease max with time
@@ -463,7 +494,7 @@ void CHighPrecisionTimer::OnTimer()
     }
 }
 #else // Mac and Linux
-CHighPrecisionTimer::CHighPrecisionTimer ( const bool bUseDoubleSystemFrameSize ) : bRun ( false )
+CHighPrecisionTimer::CHighPrecisionTimer ( const bool bUseDoubleSystemFrameSize ) : bRun ( false ), bRealTimePriority ( false )
 {
     // calculate delay in ns
     uint64_t iNsDelay;
@@ -525,8 +556,85 @@ void CHighPrecisionTimer::Stop()
     wait ( 5000 );
 }
 
+static sched_param GetTimerSchedParam()
+{
+    // use the upper quarter of the SCHED_FIFO priority range
+    const int   iMinPriority = sched_get_priority_min ( SCHED_FIFO );
+    const int   iMaxPriority = sched_get_priority_max ( SCHED_FIFO );
+    sched_param Param;
+
+    Param.sched_priority = iMinPriority + ( iMaxPriority - iMinPriority ) * 3 / 4;
+
+    return Param;
+}
+
+bool CHighPrecisionTimer::SetRealTimePriority ( const bool bNRealTimePriority )
+{
+    if ( bNRealTimePriority )
+    {
+        // The timer thread may not be running yet. To report the outcome right
+        // away, the policy is applied to a short-lived probe thread (this fails
+        // the same way as for the timer thread if the rtprio limit or the
+        // CAP_SYS_NICE capability is missing, the calling thread keeps its policy).
+        int iErr = 0;
+
+        std::thread ProbeThread ( [&iErr]() {
+            const sched_param Param = GetTimerSchedParam();
+
+            iErr = pthread_setschedparam ( pthread_self(), SCHED_FIFO, &Param );
+        } );
+
+        ProbeThread.join();
+
+        if ( iErr != 0 )
+        {
+            qWarning() << "could not set real-time (SCHED_FIFO) priority:" << strerror ( iErr );
+            return false;
+        }
+    }
+
+    bRealTimePriority = bNRealTimePriority;
+
+    return true;
+}
+
+bool CHighPrecisionTimer::ApplyRealTimePriority ( std::thread& Thread ) const
+{
+    if ( !bRealTimePriority )
+    {
+        return false;
+    }
+
+    const sched_param Param = GetTimerSchedParam();
+
+    const int iErr = pthread_setschedparam ( Thread.native_handle(), SCHED_FIFO, &Param );
+
+    if ( iErr != 0 )
+    {
+        qWarning() << "could not set real-time (SCHED_FIFO) priority for a worker thread:" << strerror ( iErr );
+        return false;
+    }
+
+    return true;
+}
+
 void CHighPrecisionTimer::run()
 {
+    // QThread::TimeCriticalPriority has no effect for the default scheduling
+    // policy, a real-time priority must be requested explicitly (this usually
+    // requires an appropriate rtprio limit or the CAP_SYS_NICE capability)
+    if ( bRealTimePriority )
+    {
+        const sched_param Param = GetTimerSchedParam();
+
+        const int iErr = pthread_setschedparam ( pthread_self(), SCHED_FIFO, &Param );
+
+        if ( iErr != 0 )
+        {
+            qWarning() << "could not set real-time (SCHED_FIFO) priority for the timer thread:" << strerror ( iErr );
+        }
+    }
+
     // loop until the thread shall be terminated
     while ( bRun )
     {
@@ -560,6 +668,64 @@ void CHighPrecisionTimer::run()
 }
 #endif
 
+// CTickLatenessHistogram implementation ***************************************
+void CTickLatenessHistogram::Reset()
+{
+    for ( int i = 0; i < NUM_TICK_LATENESS_BINS; i++ )
+    {
+        viCounts[i].store ( 0 );
+    }
+
+    iMaxLatenessUs.store ( 0 );
+}
+
+void CTickLatenessHistogram::Start ( const int64_t iNewTickPeriodNs )
+{
+    // note that the counts are kept, only the tick grid is restarted
+    iTickPeriodNs = iNewTickPeriodNs;
+    iNextTickNs   = 0;
+    ElapsedTimer.start();
+}
+
+void CTickLatenessHistogram::Update()
+{
+    const int64_t iCurTimeNs  = ElapsedTimer.nsecsElapsed();
+    int64_t       iLatenessNs = iCurTimeNs - iNextTickNs;
+
+    // if the tick is earlier than expected (e.g. timer resolution, clock
+    // drift), the tick grid is aligned to the current tick
+    if ( iLatenessNs < 0 )
+    {
+        iLatenessNs = 0;
+        iNextTickNs = iCurTimeNs;
+    }
+
+    iNextTickNs += iTickPeriodNs;
+
+    const int iLatenessUs = static_cast<int> ( std::min<int64_t> ( iLatenessNs / 1000, INT_MAX ) );
+    int       iBin        = 0;
+
+    while ( ( iBin < NUM_TICK_LATENESS_BINS - 1 ) && ( iLatenessUs >= GetBinUpperBoundUs ( iBin ) ) )
+    {
+        iBin++;
+    }
+
+    viCounts[iBin].fetch_add ( 1, std::memory_order_relaxed );
+
+    if ( iLatenessUs > iMaxLatenessUs.load ( std::memory_order_relaxed ) )
+    {
+        iMaxLatenessUs.store ( iLatenessUs, std::memory_order_relaxed );
+    }
+}
+
+int CTickLatenessHistogram::GetBinUpperBoundUs ( const int iBin )
+{
+    // the last bin has no upper bound
+    static const int viBoundsUs[NUM_TICK_LATENESS_BINS] = { 100, 250, 500, 1000, 2000, 5000, 10000, -1 };
+
+    return viBoundsUs[iBin];
+}
+
 /******************************************************************************\
 * GUI Utilities                                                                *
 \******************************************************************************/
@@ -1190,39 +1356,211 @@ int CHostAddress::Compare ( const CHostAddress& other ) const
 
     // compare protocols before addresses
 
-    QAbstractSocket::NetworkLayerProtocol thisProto  = InetAddr.protocol();
-    QAbstractSocket::NetworkLayerProtocol otherProto = other.InetAddr.protocol();
+    if ( iProto != other.iProto )
+    {
+        return (int) iProto - (int) other.iProto;
+    }
+
+    // now we know both addresses are the same protocol, IPv4 addresses are
+    // compared in their IPv4-mapped form
+    return memcmp ( &SockAddr6.sin6_addr, &other.SockAddr6.sin6_addr, sizeof ( SockAddr6.sin6_addr ) );
+}
+
+void CHostAddress::CopyFrom ( const CHostAddress& NHAddr )
+{
+    // a copy always has a valid QHostAddress
+    InetAddr         = NHAddr.bInetAddrPending ? NHAddr.GetInetAddrFromKey() : NHAddr.InetAddr;
+    iPort            = NHAddr.iPort;
+    SockAddr6        = NHAddr.SockAddr6;
+    iProto           = NHAddr.iProto;
+    bInetAddrPending = false;
+    iHash            = NHAddr.iHash;
+}
 
-    if ( thisProto != otherProto )
+void CHostAddress::UpdateKey()
+{
+    memset ( &SockAddr6, 0, sizeof ( SockAddr6 ) );
+
+    SockAddr6.sin6_family = AF_INET6;
+    SockAddr6.sin6_port   = htons ( iPort );
+
+    if ( InetAddr.protocol() == QAbstractSocket::IPv4Protocol )
     {
-        return (int) thisProto - (int) otherProto;
+        uint32_t* addr = (uint32_t*) &SockAddr6.sin6_addr;
+
+        addr[2] = htonl ( 0xFFFF );
+        addr[3] = htonl ( InetAddr.toIPv4Address() );
+        iProto  = PR_IPV4;
     }
+    else if ( InetAddr.protocol() == QAbstractSocket::IPv6Protocol )
+    {
+        const Q_IPV6ADDR Addr = InetAddr.toIPv6Address();
 
-    // now we know both addresses are the same protocol
+        memcpy ( &SockAddr6.sin6_addr, &Addr, sizeof ( SockAddr6.sin6_addr ) );
 
-    if ( thisProto == QAbstractSocket::IPv6Protocol )
+        // an IPv4-mapped address is the same peer as the IPv4 address (see SetSockAddr())
+        if ( IN6_IS_ADDR_V4MAPPED ( &SockAddr6.sin6_addr ) )
+        {
+            iProto   = PR_IPV4;
+            InetAddr = GetInetAddrFromKey();
+        }
+        else
+        {
+            iProto = PR_IPV6;
+        }
+    }
+    else
     {
-        // compare IPv6 addresses
-        Q_IPV6ADDR thisAddr  = InetAddr.toIPv6Address();
-        Q_IPV6ADDR otherAddr = other.InetAddr.toIPv6Address();
+        iProto = PR_OTHER;
+    }
+
+    bInetAddrPending = false;
+
+    UpdateHash();
+}
 
-        return memcmp ( &thisAddr, &otherAddr, sizeof ( Q_IPV6ADDR ) );
+void CHostAddress::SetInetAddr ( const QHostAddress& NInetAddr )
+{
+    InetAddr = NInetAddr;
+
+    UpdateKey();
+}
+
+void CHostAddress::SetPort ( const quint16 iNPort )
+{
+    // the address part of the key is not changed (it may still be pending)
+    iPort               = iNPort;
+    SockAddr6.sin6_port = htons ( iPort );
+
+    UpdateHash();
+}
+
+void CHostAddress::SetSockAddr ( const struct sockaddr* pSockAddr )
+{
+    if ( pSockAddr->sa_family == AF_INET6 )
+    {
+        SockAddr6 = *reinterpret_cast<const struct sockaddr_in6*> ( pSockAddr );
+
+        // IPv4 clients on a dual-stack socket use IPv4-mapped addresses
+        iProto = IN6_IS_ADDR_V4MAPPED ( &SockAddr6.sin6_addr ) ? PR_IPV4 : PR_IPV6;
     }
+    else
+    {
+        const struct sockaddr_in* pSockAddr4 = reinterpret_cast<const struct sockaddr_in*> ( pSockAddr );
+
+        memset ( &SockAddr6, 0, sizeof ( SockAddr6 ) );
+
+        SockAddr6.sin6_family = AF_INET6;
+        SockAddr6.sin6_port   = pSockAddr4->sin_port;
+
+        uint32_t* addr = (uint32_t*) &SockAddr6.sin6_addr;
 
-    // compare IPv4 addresses
-    quint32 thisAddr  = InetAddr.toIPv4Address();
-    quint32 otherAddr = other.InetAddr.toIPv4Address();
+        addr[2] = htonl ( 0xFFFF );
+        addr[3] = pSockAddr4->sin_addr.s_addr;
+        iProto  = PR_IPV4;
+    }
+
+    // the flow info and scope are not part of the compare key
+    SockAddr6.sin6_flowinfo = 0;
+    SockAddr6.sin6_scope_id = 0;
+
+    iPort            = ntohs ( SockAddr6.sin6_port );
+    bInetAddrPending = true;
 
-    return thisAddr < otherAddr ? -1 : thisAddr > otherAddr ? 1 : 0;
+    UpdateHash();
+}
+
+void CHostAddress::ResolveInetAddr()
+{
+    if ( bInetAddrPending )
+    {
+        InetAddr         = GetInetAddrFromKey();
+        bInetAddrPending = false;
+    }
+}
+
+QHostAddress CHostAddress::GetInetAddrFromKey() const
+{
+    if ( iProto == PR_IPV4 )
+    {
+        return QHostAddress ( ntohl ( ( (const uint32_t*) &SockAddr6.sin6_addr )[3] ) );
+    }
+
+    return QHostAddress ( (const quint8*) &SockAddr6.sin6_addr );
+}
+
+void CHostAddress::GetKey ( quint64& iAddrHi, quint64& iAddrLo, quint32& iPortProto ) const
+{
+    memcpy ( &iAddrHi, &SockAddr6.sin6_addr, sizeof ( iAddrHi ) );
+    memcpy ( &iAddrLo, ( (const uint8_t*) &SockAddr6.sin6_addr ) + sizeof ( iAddrHi ), sizeof ( iAddrLo ) );
+
+    iPortProto = ( static_cast<quint32> ( iPort ) << 8 ) | iProto;
+}
+
+void CHostAddress::UpdateHash()
+{
+    // mix both halves of the address and the port
+    quint64 iAddrHi;
+    quint64 iAddrLo;
+    quint32 iPortProto;
+
+    GetKey ( iAddrHi, iAddrLo, iPortProto );
+
+    quint64 iKey = ( iAddrHi * Q_UINT64_C ( 0x9E3779B97F4A7C15 ) ) ^ ( ( iAddrLo + iPort ) * Q_UINT64_C ( 0xC2B2AE3D27D4EB4F ) );
+
+    iKey ^= iKey >> 29;
+    iHash = static_cast<uint32_t> ( iKey ^ ( iKey >> 32 ) );
+}
+
+bool CHostAddress::GetSockAddr ( struct sockaddr* pSockAddr, int& iSockAddrLen, const bool bDualStack ) const
+{
+    if ( iProto == PR_IPV4 )
+    {
+        if ( bDualStack )
+        {
+            // Linux and Mac allow to pass an AF_INET address to a dual-stack socket,
+            // but Windows does not. So use a V4MAPPED address in an AF_INET6 sockaddr,
+            // which works on all platforms.
+            *reinterpret_cast<struct sockaddr_in6*> ( pSockAddr ) = SockAddr6;
+
+            iSockAddrLen = sizeof ( SockAddr6 );
+        }
+        else
+        {
+            struct sockaddr_in* pSockAddr4 = reinterpret_cast<struct sockaddr_in*> ( pSockAddr );
+
+            memset ( pSockAddr4, 0, sizeof ( *pSockAddr4 ) );
+
+            pSockAddr4->sin_family      = AF_INET;
+            pSockAddr4->sin_port        = SockAddr6.sin6_port;
+            pSockAddr4->sin_addr.s_addr = ( (const uint32_t*) &SockAddr6.sin6_addr )[3];
+
+            iSockAddrLen = sizeof ( *pSockAddr4 );
+        }
+
+        return true;
+    }
+    else if ( ( iProto == PR_IPV6 ) && bDualStack )
+    {
+        *reinterpret_cast<struct sockaddr_in6*> ( pSockAddr ) = SockAddr6;
+
+        iSockAddrLen = sizeof ( SockAddr6 );
+        return true;
+    }
+
+    // an IPv6 address cannot be used with an IPv4 socket
+    return false;
 }
 
 QString CHostAddress::toString ( const EStringMode eStringMode ) const
 {
-    QString strReturn = InetAddr.toString();
+    const QHostAddress CurInetAddr = GetInetAddr();
+
+    QString strReturn = CurInetAddr.toString();
 
     // special case: for local host address, we do not replace the last byte
     if ( ( ( eStringMode == SM_IP_NO_LAST_BYTE ) || ( eStringMode == SM_IP_NO_LAST_BYTE_PORT ) ) &&
-         ( InetAddr != QHostAddress ( QHostAddress::LocalHost ) ) && ( InetAddr != QHostAddress ( QHostAddress::LocalHostIPv6 ) ) )
+         ( CurInetAddr != QHostAddress ( QHostAddress::LocalHost ) ) && ( CurInetAddr != QHostAddress ( QHostAddress::LocalHostIPv6 ) ) )
     {
         // replace last part by an "x"
         if ( strReturn.contains ( "." ) )
@@ -25,6 +25,9 @@
 #pragma once
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
 #ifdef _WIN32
 #    include <winsock2.h>
 #    include <ws2tcpip.h>
@@ -39,6 +42,10 @@
 // using mach nanosleep for Linux
 #    include <sys/time.h>
 #endif
+#ifndef _WIN32
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#endif
 #include <QCoreApplication>
 #include <QUdpSocket>
 #include <QHostAddress>
@@ -364,6 +371,160 @@ void CMovingAv<TData>::Add ( const TData tNewD )
     }
 }
 
+/******************************************************************************\
+* CSpscQueue Class (lock-free Single Producer, Single Consumer queue)          *
+\******************************************************************************/
+// Hands over items from exactly one producer thread to exactly one consumer
+// thread without any lock. The memory is allocated in Init() so that Put() and
+// Get() can be used in the real-time thread.
+template<class TData>
+class CSpscQueue
+{
+public:
+    CSpscQueue() : iSize ( 0 ), iReadPos ( 0 ), iWritePos ( 0 ) {}
+
+    void Init ( const int iNewCapacity );
+
+    bool Put ( const TData& tNewD );
+    bool Get ( TData& tOutD );
+
+    bool IsEmpty() const { return iReadPos.load ( std::memory_order_acquire ) == iWritePos.load ( std::memory_order_acquire ); }
+
+protected:
+    CVector<TData>   vecMemory;
+    int              iSize;
+    std::atomic<int> iReadPos;
+    std::atomic<int> iWritePos;
+};
+
+template<class TData>
+void CSpscQueue<TData>::Init ( const int iNewCapacity )
+{
+    // one element always stays unused to distinguish between full and empty
+    iSize = iNewCapacity + 1;
+    vecMemory.Init ( iSize );
+    iReadPos.store ( 0 );
+    iWritePos.store ( 0 );
+}
+
+template<class TData>
+bool CSpscQueue<TData>::Put ( const TData& tNewD )
+{
+    const int iCurWritePos = iWritePos.load ( std::memory_order_relaxed );
+    int       iNewWritePos = iCurWritePos + 1;
+
+    if ( iNewWritePos >= iSize )
+    {
+        iNewWritePos = 0;
+    }
+
+    // check if the queue is full
+    if ( iNewWritePos == iReadPos.load ( std::memory_order_acquire ) )
+    {
+        return false;
+    }
+
+    vecMemory[iCurWritePos] = tNewD;
+
+    // publish the new element to the consumer
+    iWritePos.store ( iNewWritePos, std::memory_order_release );
+    return true;
+}
+
+template<class TData>
+bool CSpscQueue<TData>::Get ( TData& tOutD )
+{
+    const int iCurReadPos = iReadPos.load ( std::memory_order_relaxed );
+
+    // check if the queue is empty
+    if ( iCurReadPos == iWritePos.load ( std::memory_order_acquire ) )
+    {
+        return false;
+    }
+
+    tOutD = vecMemory[iCurReadPos];
+
+    // release the element to the producer
+    iReadPos.store ( iCurReadPos + 1 >= iSize ? 0 : iCurReadPos + 1, std::memory_order_release );
+    return true;
+}
+
+// Same as CSpscQueue but for byte packets of variable size (up to the slot
+// size) which are written and read in place, i.e. the consumer uses the packet
+// directly in the ring and releases it with Pop() afterwards. Each packet
+// carries a tag of the producer which is handed to the consumer unchanged.
+class CSpscPacketRing
+{
+public:
+    CSpscPacketRing() : iNumSlots ( 0 ), iSlotSize ( 0 ), iReadPos ( 0 ), iWritePos ( 0 ) {}
+
+    void Init ( const int iNewNumPackets, const int iNewSlotSize )
+    {
+        // one slot always stays unused to distinguish between full and empty
+        iNumSlots = iNewNumPackets + 1;
+        iSlotSize = iNewSlotSize;
+        vecbyMemory.Init ( iNumSlots * iSlotSize );
+        veciNumBytes.Init ( iNumSlots );
+        veciTags.Init ( iNumSlots );
+        iReadPos.store ( 0 );
+        iWritePos.store ( 0 );
+    }
+
+    bool IsInitialized() const { return iNumSlots > 0; }
+
+    // producer side, returns false if the packet is too large or the ring is full
+    bool Put ( const uint8_t* pbyData, const int iNumBytes, const uint32_t iTag )
+    {
+        const int iCurWritePos = iWritePos.load ( std::memory_order_relaxed );
+        const int iNewWritePos = iCurWritePos + 1 >= iNumSlots ? 0 : iCurWritePos + 1;
+
+        if ( ( iNumBytes > iSlotSize ) || ( iNewWritePos == iReadPos.load ( std::memory_order_acquire ) ) )
+        {
+            return false;
+        }
+
+        std::copy ( pbyData, pbyData + iNumBytes, &vecbyMemory[iCurWritePos * iSlotSize] );
+        veciNumBytes[iCurWritePos] = iNumBytes;
+        veciTags[iCurWritePos]     = iTag;
+
+        // publish the new packet to the consumer
+        iWritePos.store ( iNewWritePos, std::memory_order_release );
+        return true;
+    }
+
+    // consumer side, returns nullptr if the ring is empty
+    const uint8_t* Front ( int& iNumBytes, uint32_t& iTag ) const
+    {
+        const int iCurReadPos = iReadPos.load ( std::memory_order_relaxed );
+
+        if ( iCurReadPos == iWritePos.load ( std::memory_order_acquire ) )
+        {
+            return nullptr;
+        }
+
+        iNumBytes = veciNumBytes[iCurReadPos];
+        iTag      = veciTags[iCurReadPos];
+        return &vecbyMemory[iCurReadPos * iSlotSize];
+    }
+
+    void Pop()
+    {
+        // release the slot of the front packet to the producer
+        const int iCurReadPos = iReadPos.load ( std::memory_order_relaxed );
+
+        iReadPos.store ( iCurReadPos + 1 >= iNumSlots ? 0 : iCurReadPos + 1, std::memory_order_release );
+    }
+
+protected:
+    CVector<uint8_t>  vecbyMemory;
+    CVector<int>      veciNumBytes;
+    CVector<uint32_t> veciTags;
+    int               iNumSlots;
+    int               iSlotSize;
+    std::atomic<int>  iReadPos;
+    std::atomic<int>  iWritePos;
+};
+
 /******************************************************************************\
 * GUI Utilities                                                                *
 \******************************************************************************/
@@ -714,6 +875,9 @@ public:
     }
 
     void Update ( const CVector<short>& vecsAudio, const int iInSize, const bool bIsStereoIn );
+    void Update ( const CVector<float>& vecfAudio, const int iInSize, const bool bIsStereoIn ); // float samples in the range [-1, 1]
+    void Update ( const short* psAudio, const int iInSize, const bool bIsStereoIn );
+    void Update ( const float* pfAudio, const int iInSize, const bool bIsStereoIn ); // float samples in the range [-1, 1]
 
     double        GetLevelForMeterdBLeftOrMono() { return CalcLogResultForMeter ( dCurLevelLOrMono ); }
     double        GetLevelForMeterdBRight() { return CalcLogResultForMeter ( dCurLevelR ); }
@@ -726,6 +890,9 @@ public:
     }
 
 protected:
+    template<typename TSample>
+    void UpdateFromBlock ( const TSample* pAudio, const int iMonoBlockSizeSam, const bool bIsStereoIn, const double dScale );
+
     double UpdateCurLevel ( double dCurLevel, const double dMax );
 
     double dCurLevelLOrMono;
@@ -745,29 +912,78 @@ public:
         SM_IP_NO_LAST_BYTE_PORT
     };
 
-    CHostAddress() : InetAddr ( static_cast<quint32> ( 0 ) ), iPort ( 0 ) {}
+    CHostAddress() : InetAddr ( static_cast<quint32> ( 0 ) ), iPort ( 0 ) { UpdateKey(); }
 
-    CHostAddress ( const QHostAddress NInetAddr, const quint16 iNPort ) : InetAddr ( NInetAddr ), iPort ( iNPort ) {}
+    CHostAddress ( const QHostAddress NInetAddr, const quint16 iNPort ) : InetAddr ( NInetAddr ), iPort ( iNPort ) { UpdateKey(); }
 
-    CHostAddress ( const CHostAddress& NHAddr ) : InetAddr ( NHAddr.InetAddr ), iPort ( NHAddr.iPort ) {}
+    CHostAddress ( const CHostAddress& NHAddr ) { CopyFrom ( NHAddr ); }
 
     // copy operator
     CHostAddress& operator= ( const CHostAddress& NHAddr )
     {
-        InetAddr = NHAddr.InetAddr;
-        iPort    = NHAddr.iPort;
+        CopyFrom ( NHAddr );
         return *this;
     }
 
     // compare operator
-    bool operator== ( const CHostAddress& CompAddr ) const { return ( ( CompAddr.InetAddr == InetAddr ) && ( CompAddr.iPort == iPort ) ); }
+    bool operator== ( const CHostAddress& CompAddr ) const
+    {
+        return ( CompAddr.iPort == iPort ) && ( CompAddr.iProto == iProto ) &&
+               ( memcmp ( &CompAddr.SockAddr6.sin6_addr, &SockAddr6.sin6_addr, sizeof ( SockAddr6.sin6_addr ) ) == 0 );
+    }
 
     int Compare ( const CHostAddress& other ) const;
 
     QString toString ( const EStringMode eStringMode = SM_IP_PORT ) const;
 
+    // Sets the address of a received datagram. Only the native form and the
+    // compare key are updated, the QHostAddress is created on demand (see
+    // ResolveInetAddr()) so that the receive path does not need any QHostAddress work.
+    void SetSockAddr ( const struct sockaddr* pSockAddr );
+
+    // creates the QHostAddress for an address which was set by SetSockAddr()
+    // (GetInetAddr() does this on demand without storing it)
+    void ResolveInetAddr();
+
+    QHostAddress GetInetAddr() const { return bInetAddrPending ? GetInetAddrFromKey() : InetAddr; }
+    quint16      GetPort() const { return iPort; }
+
+    // the setters update the compare key (an IPv4-mapped address is stored as
+    // the plain IPv4 address, the same way as for a received datagram)
+    void SetInetAddr ( const QHostAddress& NInetAddr );
+    void SetPort ( const quint16 iNPort );
+
+    // native form for sendto() (the buffer must hold a sockaddr_in6), IPv4
+    // addresses are IPv4-mapped for a dual-stack socket
+    bool GetSockAddr ( struct sockaddr* pSockAddr, int& iSockAddrLen, const bool bDualStack ) const;
+
+    uint32_t GetHash() const { return iHash; }
+
+    // the compare key as plain integers (e.g. for lock-free tables)
+    void GetKey ( quint64& iAddrHi, quint64& iAddrLo, quint32& iPortProto ) const;
+
+protected:
+    enum EProto
+    {
+        PR_IPV4,
+        PR_IPV6,
+        PR_OTHER
+    };
+
+    void         CopyFrom ( const CHostAddress& NHAddr );
+    QHostAddress GetInetAddrFromKey() const;
+    void         UpdateKey();
+    void         UpdateHash();
+
     QHostAddress InetAddr;
     quint16      iPort;
+
+    // the compare key: the address in IPv6 notation (IPv4 addresses are
+    // stored IPv4-mapped) which is at the same time the native form of the address
+    struct sockaddr_in6 SockAddr6;
+    uint8_t             iProto;
+    bool                bInetAddrPending;
+    uint32_t            iHash;
 };
 
 // Instrument picture data base ------------------------------------------------
@@ -1296,6 +1512,10 @@ public:
     void Stop();
     bool isActive() const { return Timer.isActive(); }
 
+    // the timer runs in the main event loop, a real-time priority is not supported
+    bool SetRealTimePriority ( const bool ) { return false; }
+    bool ApplyRealTimePriority ( std::thread& ) const { return false; }
+
 protected:
     QTimer       Timer;
     CVector<int> veciTimeOutIntervals;
@@ -1322,10 +1542,19 @@ public:
     void Stop();
     bool isActive() { return bRun; }
 
+    // request SCHED_FIFO scheduling for the timer thread (takes effect on the
+    // next start of the timer), returns false if the policy cannot be applied
+    bool SetRealTimePriority ( const bool bNRealTimePriority );
+
+    // apply the real-time priority of the timer thread to another thread which
+    // the timer thread waits for (only if the real-time priority is requested)
+    bool ApplyRealTimePriority ( std::thread& Thread ) const;
+
 protected:
     virtual void run();
 
     bool     bRun;
+    bool     bRealTimePriority;
 
 #    if defined( __APPLE__ ) || defined( __MACOSX )
     uint64_t Delay;
@@ -1343,6 +1572,33 @@ signals:
 /******************************************************************************\
 * Statistics                                                                   *
 \******************************************************************************/
+// Tick lateness histogram -----------------------------------------------------
+// Measures how late each tick is processed compared to the ideal tick grid.
+// Update() is called by the processing thread, the counts may be read by any
+// other thread at the same time.
+#define NUM_TICK_LATENESS_BINS 8
+
+class CTickLatenessHistogram
+{
+public:
+    CTickLatenessHistogram() : iTickPeriodNs ( 0 ), iNextTickNs ( 0 ) { Reset(); }
+
+    void Reset();
+    void Start ( const int64_t iNewTickPeriodNs );
+    void Update();
+
+    static int GetBinUpperBoundUs ( const int iBin );
+    uint32_t   GetCount ( const int iBin ) const { return viCounts[iBin].load ( std::memory_order_relaxed ); }
+    int        GetMaxLatenessUs() const { return iMaxLatenessUs.load ( std::memory_order_relaxed ); }
+
+protected:
+    QElapsedTimer         ElapsedTimer;
+    int64_t               iTickPeriodNs;
+    int64_t               iNextTickNs;
+    std::atomic<uint32_t> viCounts[NUM_TICK_LATENESS_BINS];
+    std::atomic<int>      iMaxLatenessUs;
+};
+
 // Error rate measurement ------------------------------------------------------
 class CErrorRate
 {
@@ -0,0 +1,341 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+ * Benchmark of the channel lookup of the server: CChannelMap::Find() is
+ * compared with the binary search over the sorted channel order under a mutex
+ * (the lookup before CChannelMap). The addresses are set like received
+ * datagrams (CHostAddress::SetSockAddr()), a quarter of them are IPv6.
+ *
+ * Every reader thread looks up the connected channels (hits) and unknown
+ * addresses (misses) in random order. In the churn run a writer thread
+ * connects and disconnects additional channels at the same time. The program
+ * exits with a non-zero code if a lookup returns a wrong channel ID.
+ *
+ * Usage: channel_map [number of channels, default 100]
+ *                    [number of lookups per reader thread, default 1000000]
+ *                    [number of reader threads, default 1]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <QMutex>
+#include "channelmap.h"
+
+/* Definitions ****************************************************************/
+// number of channels which are connected and disconnected in the churn run
+#define BENCH_NUM_CHURN_CHANNELS 8
+
+/* Implementation *************************************************************/
+typedef std::chrono::steady_clock TClock;
+
+// The lookup before CChannelMap: the channel IDs are kept sorted by address and
+// the lookup is a binary search which holds the channel order mutex.
+class CSortedChannelList
+{
+public:
+    CSortedChannelList() : iCurNumChannels ( 0 ) {}
+
+    int Find ( const CHostAddress& Addr )
+    {
+        QMutexLocker locker ( &Mutex );
+
+        int l = 0, r = iCurNumChannels;
+
+        while ( r > l )
+        {
+            const int t   = ( r + l ) / 2;
+            const int cmp = Addr.Compare ( vecAddresses[veciChannelOrder[t]] );
+
+            if ( cmp == 0 )
+            {
+                return veciChannelOrder[t];
+            }
+
+            if ( cmp > 0 )
+            {
+                l = t + 1;
+            }
+            else
+            {
+                r = t;
+            }
+        }
+
+        return INVALID_INDEX;
+    }
+
+    void Insert ( const CHostAddress& Addr, const int iChanID )
+    {
+        QMutexLocker locker ( &Mutex );
+
+        vecAddresses[iChanID] = Addr;
+
+        int i = iCurNumChannels++;
+
+        while ( ( i > 0 ) && ( Addr.Compare ( vecAddresses[veciChannelOrder[i - 1]] ) < 0 ) )
+        {
+            veciChannelOrder[i] = veciChannelOrder[i - 1];
+            i--;
+        }
+
+        veciChannelOrder[i] = iChanID;
+    }
+
+    void Remove ( const int iChanID )
+    {
+        QMutexLocker locker ( &Mutex );
+
+        int i = 0;
+
+        while ( ( i < iCurNumChannels ) && ( veciChannelOrder[i] != iChanID ) )
+        {
+            i++;
+        }
+
+        if ( i < iCurNumChannels )
+        {
+            iCurNumChannels--;
+
+            for ( ; i < iCurNumChannels; i++ )
+            {
+                veciChannelOrder[i] = veciChannelOrder[i + 1];
+            }
+        }
+    }
+
+protected:
+    QMutex       Mutex;
+    CHostAddress vecAddresses[MAX_NUM_CHANNELS];
+    int          veciChannelOrder[MAX_NUM_CHANNELS];
+    int          iCurNumChannels;
+};
+
+// address like it is set by the receive path of the socket
+static CHostAddress RandomAddress ( std::mt19937& RandGen )
+{
+    CHostAddress Addr;
+    const quint16 iPort = static_cast<quint16> ( 1024 + RandGen() % 64000 );
+
+    if ( RandGen() % 4 == 0 )
+    {
+        struct sockaddr_in6 SockAddr6;
+        memset ( &SockAddr6, 0, sizeof ( SockAddr6 ) );
+
+        SockAddr6.sin6_family = AF_INET6;
+        SockAddr6.sin6_port   = htons ( iPort );
+
+        // global unicast address
+        uint8_t* pbyAddr = reinterpret_cast<uint8_t*> ( &SockAddr6.sin6_addr );
+        pbyAddr[0]       = 0x20;
+        pbyAddr[1]       = 0x01;
+
+        for ( int i = 2; i < 16; i++ )
+        {
+            pbyAddr[i] = static_cast<uint8_t> ( RandGen() );
+        }
+
+        Addr.SetSockAddr ( reinterpret_cast<const struct sockaddr*> ( &SockAddr6 ) );
+    }
+    else
+    {
+        struct sockaddr_in SockAddr4;
+        memset ( &SockAddr4, 0, sizeof ( SockAddr4 ) );
+
+        SockAddr4.sin_family      = AF_INET;
+        SockAddr4.sin_port        = htons ( iPort );
+        SockAddr4.sin_addr.s_addr = htonl ( 0x0A000000 | ( RandGen() & 0xFFFFFF ) );
+
+        Addr.SetSockAddr ( reinterpret_cast<const struct sockaddr*> ( &SockAddr4 ) );
+    }
+
+    return Addr;
+}
+
+template<class TMap>
+static void LookUp ( TMap*                            pMap,
+                     const std::vector<CHostAddress>* pvecAddresses,
+                     const int                        iNumChannels,
+                     const int                        iNumLookups,
+                     const unsigned int               iSeed,
+                     double*                          pdNsPerLookup,
+                     long*                            piNumErrors )
+{
+    // the lookup order is prepared in advance so that only the lookups are timed,
+    // the addresses after the connected channels are never mapped
+    std::mt19937     RandGen ( iSeed );
+    std::vector<int> veciOrder ( iNumLookups );
+
+    for ( int i = 0; i < iNumLookups; i++ )
+    {
+        veciOrder[i] = static_cast<int> ( RandGen() % pvecAddresses->size() );
+    }
+
+    long iNumErrors = 0;
+
+    const TClock::time_point Start = TClock::now();
+
+    for ( int i = 0; i < iNumLookups; i++ )
+    {
+        const int iIdx    = veciOrder[i];
+        const int iChanID = pMap->Find ( ( *pvecAddresses )[iIdx] );
+
+        if ( iChanID != ( ( iIdx < iNumChannels ) ? iIdx : INVALID_INDEX ) )
+        {
+            iNumErrors++;
+        }
+    }
+
+    *pdNsPerLookup = std::chrono::duration<double, std::nano> ( TClock::now() - Start ).count() / iNumLookups;
+    *piNumErrors   = iNumErrors;
+}
+
+template<class TMap>
+static long RunBench ( const char* strName, const int iNumChannels, const int iNumLookups, const int iNumReaders, const bool bChurn )
+{
+    // connected channels, unknown addresses and the churn channels
+    std::mt19937              RandGen ( 1 );
+    std::vector<CHostAddress> vecAddresses;
+    std::vector<CHostAddress> vecChurnAddresses;
+
+    for ( int i = 0; i < 2 * iNumChannels; i++ )
+    {
+        vecAddresses.push_back ( RandomAddress ( RandGen ) );
+    }
+
+    for ( int i = 0; i < BENCH_NUM_CHURN_CHANNELS; i++ )
+    {
+        vecChurnAddresses.push_back ( RandomAddress ( RandGen ) );
+    }
+
+    std::unique_ptr<TMap> pMap ( new TMap );
+
+    for ( int i = 0; i < iNumChannels; i++ )
+    {
+        pMap->Insert ( vecAddresses[i], i );
+    }
+
+    // the writer connects and disconnects the churn channels until all readers are done
+    std::atomic<bool> bStop ( false );
+    long              iNumChurns = 0;
+    std::thread       Writer;
+
+    if ( bChurn )
+    {
+        Writer = std::thread ( [&] {
+            while ( !bStop.load() )
+            {
+                for ( int i = 0; i < BENCH_NUM_CHURN_CHANNELS; i++ )
+                {
+                    pMap->Insert ( vecChurnAddresses[i], iNumChannels + i );
+                }
+
+                for ( int i = 0; i < BENCH_NUM_CHURN_CHANNELS; i++ )
+                {
+                    pMap->Remove ( iNumChannels + i );
+                }
+
+                iNumChurns++;
+                std::this_thread::yield();
+            }
+        } );
+    }
+
+    std::vector<std::thread> vecReaders;
+    std::vector<double>      vecdNsPerLookup ( iNumReaders );
+    std::vector<long>        veciNumErrors ( iNumReaders );
+
+    for ( int i = 0; i < iNumReaders; i++ )
+    {
+        vecReaders.push_back ( std::thread ( LookUp<TMap>,
+                                             pMap.get(),
+                                             &vecAddresses,
+                                             iNumChannels,
+                                             iNumLookups,
+                                             static_cast<unsigned int> ( 100 + i ),
+                                             &vecdNsPerLookup[i],
+                                             &veciNumErrors[i] ) );
+    }
+
+    for ( std::thread& Reader : vecReaders )
+    {
+        Reader.join();
+    }
+
+    bStop = true;
+
+    if ( Writer.joinable() )
+    {
+        Writer.join();
+    }
+
+    double dNsPerLookup = 0;
+    long   iNumErrors   = 0;
+
+    for ( int i = 0; i < iNumReaders; i++ )
+    {
+        dNsPerLookup += vecdNsPerLookup[i] / iNumReaders;
+        iNumErrors += veciNumErrors[i];
+    }
+
+    printf ( "%-16s %-6s %14.1f %10ld %8ld\n", strName, bChurn ? "churn" : "stable", dNsPerLookup, iNumChurns, iNumErrors );
+
+    return iNumErrors;
+}
+
+int main ( int argc, char** argv )
+{
+    const int iNumChannels = ( argc > 1 ) ? atoi ( argv[1] ) : 100;
+    const int iNumLookups  = ( argc > 2 ) ? atoi ( argv[2] ) : 1000000;
+    const int iNumReaders  = ( argc > 3 ) ? atoi ( argv[3] ) : 1;
+
+    if ( ( iNumChannels < 1 ) || ( iNumChannels > MAX_NUM_CHANNELS - BENCH_NUM_CHURN_CHANNELS ) || ( iNumLookups < 1 ) || ( iNumReaders < 1 ) )
+    {
+        fprintf ( stderr,
+                  "usage: %s [channels, 1..%d] [lookups per reader thread] [reader threads]\n",
+                  argv[0],
+                  MAX_NUM_CHANNELS - BENCH_NUM_CHURN_CHANNELS );
+        return 2;
+    }
+
+    printf ( "%d channels, %d lookups per reader thread (half of them misses), %d reader threads\n", iNumChannels, iNumLookups, iNumReaders );
+    printf ( "%-16s %-6s %14s %10s %8s\n", "lookup", "run", "ns per lookup", "churns", "errors" );
+
+    long iNumErrors = 0;
+
+    for ( int iChurn = 0; iChurn < 2; iChurn++ )
+    {
+        iNumErrors += RunBench<CSortedChannelList> ( "binary search", iNumChannels, iNumLookups, iNumReaders, iChurn != 0 );
+        iNumErrors += RunBench<CChannelMap> ( "channel map", iNumChannels, iNumLookups, iNumReaders, iChurn != 0 );
+    }
+
+    return ( iNumErrors == 0 ) ? 0 : 1;
+}
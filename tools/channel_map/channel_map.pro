@@ -0,0 +1,26 @@
+# Benchmark of the channel lookup of the server, build and run with:
+#   qmake tools/channel_map/channel_map.pro && make && ./channel_map
+
+TARGET = channel_map
+TEMPLATE = app
+
+CONFIG += console \
+    c++17 \
+    thread
+CONFIG -= app_bundle
+
+QT = core \
+    network
+
+DEFINES += HEADLESS \
+    APP_VERSION=\\\"channel_map\\\"
+
+INCLUDEPATH += ../../src
+
+# util.h is listed for the moc run of its QObject classes (util.cpp provides CHostAddress)
+HEADERS += ../../src/channelmap.h \
+    ../../src/util.h
+
+SOURCES += channel_map.cpp \
+    ../../src/channelmap.cpp \
+    ../../src/util.cpp
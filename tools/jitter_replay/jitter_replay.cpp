@@ -0,0 +1,345 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+ * Offline comparison of the auto jitter buffer engines: an arrival trace is
+ * replayed through a CNetBufWithStats with the simulation buffers and through
+ * one with the histogram jitter estimator. The playout clock requests one block
+ * per block duration, starting with the first arrival.
+ *
+ * In a second run the auto setting is applied to the jitter buffer size (as the
+ * channel does) and the achieved buffer delay of the regular playout (one block
+ * per frame) is compared with the adaptive playout (CAdaptivePlayout) which
+ * time-scales a synthetic test signal.
+ *
+ * Trace format: one arrival time in milliseconds per line (one block per
+ * packet), lines starting with '#' are ignored.
+ *
+ * Usage: jitter_replay <trace file | -> [block duration in ms, default 2.667]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "buffer.h"
+#include "playout.h"
+
+/* Definitions ****************************************************************/
+// arbitrary size of the coded blocks (the engines only count blocks)
+#define REPLAY_BLOCK_SIZE 16
+
+// interval of the auto setting output in playout blocks
+#define REPLAY_OUTPUT_INTERVAL_MS 1000.0
+
+// sample rate of the synthetic test signal of the playout comparison
+#define REPLAY_SAMPLE_RATE_HZ 48000
+
+/* Implementation *************************************************************/
+struct SReplayResult
+{
+    std::vector<int> veciAutoSetting; // one value per output interval
+    CVector<double>  vecdErrRates;
+    double           dAvgSetting;
+    int              iNumSettingChanges;
+    double           dTimeNsPerBlock;
+};
+
+struct SPlayoutResult
+{
+    double  dAvgDelayMs;  // from the arrival to the output of a block
+    double  dConcealRate; // blocks which were not available on time
+    int64_t iNumCompressed;
+    int64_t iNumStretched;
+};
+
+static bool ReadTrace ( const char* strFileName, std::vector<double>& vecdArrivalMs )
+{
+    FILE* pFile = ( strcmp ( strFileName, "-" ) == 0 ) ? stdin : fopen ( strFileName, "r" );
+
+    if ( pFile == nullptr )
+    {
+        return false;
+    }
+
+    char strLine[256];
+
+    while ( fgets ( strLine, sizeof ( strLine ), pFile ) != nullptr )
+    {
+        char* pEnd;
+
+        if ( strLine[0] == '#' )
+        {
+            continue;
+        }
+
+        const double dArrivalMs = strtod ( strLine, &pEnd );
+
+        if ( pEnd != strLine )
+        {
+            vecdArrivalMs.push_back ( dArrivalMs );
+        }
+    }
+
+    if ( pFile != stdin )
+    {
+        fclose ( pFile );
+    }
+
+    std::sort ( vecdArrivalMs.begin(), vecdArrivalMs.end() );
+
+    return !vecdArrivalMs.empty();
+}
+
+static void ReplayTrace ( const std::vector<double>& vecdArrivalMs, const double dBlockMs, const bool bUseJitterHistogram, SReplayResult& Result )
+{
+    CNetBufWithStats NetBuf;
+    CVector<uint8_t> vecbyData ( REPLAY_BLOCK_SIZE, 0 );
+    double           dLimit, dMaxUpLimit;
+
+    // the statistic constants of the 128 samples frame size are used for blocks
+    // longer than 2 ms
+    NetBuf.SetUseDoubleSystemFrameSize ( dBlockMs > 2.0 );
+    NetBuf.SetUseJitterHistogram ( bUseJitterHistogram );
+    NetBuf.Init ( REPLAY_BLOCK_SIZE, MAX_NET_BUF_SIZE_NUM_BL, false );
+
+    const int iOutputInterval = std::max ( 1, static_cast<int> ( REPLAY_OUTPUT_INTERVAL_MS / dBlockMs ) );
+    size_t    iArrivalIdx     = 0;
+    int64_t   iNumBlocks      = 0;
+    int64_t   iSettingSum     = 0;
+    int       iLastSetting    = NetBuf.GetAutoSetting();
+    double    dPlayoutMs      = vecdArrivalMs.front();
+
+    Result.veciAutoSetting.clear();
+    Result.iNumSettingChanges = 0;
+
+    const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+
+    while ( iArrivalIdx < vecdArrivalMs.size() )
+    {
+        // all packets which arrived before the current playout time are put first
+        while ( ( iArrivalIdx < vecdArrivalMs.size() ) && ( vecdArrivalMs[iArrivalIdx] <= dPlayoutMs ) )
+        {
+            NetBuf.Put ( &vecbyData[0], REPLAY_BLOCK_SIZE );
+            iArrivalIdx++;
+        }
+
+        NetBuf.Get ( vecbyData, REPLAY_BLOCK_SIZE );
+
+        const int iCurSetting = NetBuf.GetAutoSetting();
+
+        if ( iCurSetting != iLastSetting )
+        {
+            Result.iNumSettingChanges++;
+            iLastSetting = iCurSetting;
+        }
+
+        iSettingSum += iCurSetting;
+
+        if ( ( ++iNumBlocks % iOutputInterval ) == 0 )
+        {
+            Result.veciAutoSetting.push_back ( iCurSetting );
+        }
+
+        dPlayoutMs += dBlockMs;
+    }
+
+    const std::chrono::steady_clock::time_point tEnd = std::chrono::steady_clock::now();
+
+    Result.dAvgSetting     = static_cast<double> ( iSettingSum ) / iNumBlocks;
+    Result.dTimeNsPerBlock = static_cast<double> ( std::chrono::duration_cast<std::chrono::nanoseconds> ( tEnd - tStart ).count() ) / iNumBlocks;
+
+    NetBuf.GetErrorRates ( Result.vecdErrRates, dLimit, dMaxUpLimit );
+}
+
+static int16_t TestSignal ( const int64_t iSample )
+{
+    // two partials with a slow vibrato, roughly like a sung vowel
+    const double dTime = static_cast<double> ( iSample ) / REPLAY_SAMPLE_RATE_HZ;
+    const double dF0   = 220.0 * ( 1.0 + 0.01 * sin ( 2 * M_PI * 5.0 * dTime ) );
+
+    return static_cast<int16_t> ( 8000 * sin ( 2 * M_PI * dF0 * dTime ) + 3000 * sin ( 2 * M_PI * 3 * dF0 * dTime ) );
+}
+
+static void ReplayPlayout ( const std::vector<double>& vecdArrivalMs, const double dBlockMs, const bool bUseAdaptivePlayout, SPlayoutResult& Result )
+{
+    CNetBufWithStats          NetBuf;
+    CAdaptivePlayout<int16_t> Playout;
+    CVector<uint8_t>          vecbyPacket ( REPLAY_BLOCK_SIZE + 1, 0 ); // the sequence number is appended
+    CVector<uint8_t>          vecbyData ( REPLAY_BLOCK_SIZE, 0 );
+
+    // the block duration is also the frame duration (the server case without
+    // conversion buffer and the client with the smallest sound card buffer)
+    const int iFrameSize = std::max ( 1, static_cast<int> ( dBlockMs * REPLAY_SAMPLE_RATE_HZ / 1000 + 0.5 ) );
+
+    CVector<int16_t> vecsFrame ( iFrameSize );
+
+    // the packets are numbered in the order of the trace like the channel does
+    // it with the sequence numbers
+    NetBuf.SetUseDoubleSystemFrameSize ( dBlockMs > 2.0 );
+    NetBuf.Init ( REPLAY_BLOCK_SIZE, DEF_NET_BUF_SIZE_NUM_BL, true );
+    Playout.Init ( 1, iFrameSize );
+    Playout.SetFormat ( 1, iFrameSize, iFrameSize );
+
+    size_t  iArrivalIdx   = 0;
+    int64_t iNumGets      = 0;
+    int64_t iNumConcealed = 0;
+    int64_t iNumPlayed    = 0;
+    double  dDelayMsSum   = 0;
+    int     iCurBufSize   = DEF_NET_BUF_SIZE_NUM_BL;
+    double  dPlayoutMs    = vecdArrivalMs.front();
+
+    while ( iArrivalIdx < vecdArrivalMs.size() )
+    {
+        while ( ( iArrivalIdx < vecdArrivalMs.size() ) && ( vecdArrivalMs[iArrivalIdx] <= dPlayoutMs ) )
+        {
+            const uint32_t iBlockIdx = static_cast<uint32_t> ( iArrivalIdx );
+
+            memcpy ( &vecbyPacket[0], &iBlockIdx, sizeof ( iBlockIdx ) );
+            vecbyPacket[REPLAY_BLOCK_SIZE] = static_cast<uint8_t> ( iBlockIdx );
+            NetBuf.Put ( &vecbyPacket[0], REPLAY_BLOCK_SIZE + 1 );
+            iArrivalIdx++;
+        }
+
+        const int iNumBlocks = bUseAdaptivePlayout ? Playout.PrepareFrame ( NetBuf.GetFillLevel() ) : 1;
+
+        for ( int iB = 0; iB < iNumBlocks; iB++ )
+        {
+            const bool bOk        = NetBuf.Get ( vecbyData, REPLAY_BLOCK_SIZE );
+            int16_t*   pBlockData = bUseAdaptivePlayout ? Playout.GetBlockWritePtr() : &vecsFrame[0];
+            uint32_t   iBlockIdx;
+
+            memcpy ( &iBlockIdx, &vecbyData[0], sizeof ( iBlockIdx ) );
+
+            for ( int i = 0; i < iFrameSize; i++ )
+            {
+                // the concealment is modelled as silence
+                pBlockData[i] = bOk ? TestSignal ( static_cast<int64_t> ( iBlockIdx ) * iFrameSize + i ) : 0;
+            }
+
+            iNumGets++;
+
+            if ( bOk )
+            {
+                // the delay is the time from the arrival to the output of the first
+                // sample of the block (the time-scale operation is neglected)
+                const int iOutputPos = bUseAdaptivePlayout ? Playout.GetBufferedSamples() : 0;
+
+                dDelayMsSum += dPlayoutMs + iOutputPos * 1000.0 / REPLAY_SAMPLE_RATE_HZ - vecdArrivalMs[iBlockIdx];
+                iNumPlayed++;
+            }
+            else
+            {
+                iNumConcealed++;
+            }
+
+            if ( bUseAdaptivePlayout )
+            {
+                Playout.BlockWritten();
+            }
+        }
+
+        if ( bUseAdaptivePlayout )
+        {
+            Playout.GetFrame ( &vecsFrame[0] );
+        }
+
+        // apply the auto setting like the channel does
+        if ( NetBuf.GetAutoSetting() != iCurBufSize )
+        {
+            iCurBufSize = NetBuf.GetAutoSetting();
+            NetBuf.Init ( REPLAY_BLOCK_SIZE, iCurBufSize, true, true );
+        }
+
+        dPlayoutMs += dBlockMs;
+    }
+
+    Result.dAvgDelayMs    = dDelayMsSum / std::max<int64_t> ( 1, iNumPlayed );
+    Result.dConcealRate   = static_cast<double> ( iNumConcealed ) / std::max<int64_t> ( 1, iNumGets );
+    Result.iNumCompressed = Playout.GetNumCompressed();
+    Result.iNumStretched  = Playout.GetNumStretched();
+}
+
+int main ( int argc, char** argv )
+{
+    if ( argc < 2 )
+    {
+        fprintf ( stderr, "usage: %s <trace file | -> [block duration in ms]\n", argv[0] );
+        return 1;
+    }
+
+    const double        dBlockMs = ( argc > 2 ) ? atof ( argv[2] ) : 128.0 / 48.0;
+    std::vector<double> vecdArrivalMs;
+
+    if ( ( dBlockMs <= 0.0 ) || !ReadTrace ( argv[1], vecdArrivalMs ) )
+    {
+        fprintf ( stderr, "cannot read the trace or invalid block duration\n" );
+        return 1;
+    }
+
+    SReplayResult SimResult;
+    SReplayResult HistResult;
+
+    ReplayTrace ( vecdArrivalMs, dBlockMs, false, SimResult );
+    ReplayTrace ( vecdArrivalMs, dBlockMs, true, HistResult );
+
+    // auto setting over time
+    printf ( "# time [s], simulation buffers, histogram\n" );
+
+    for ( size_t i = 0; i < SimResult.veciAutoSetting.size(); i++ )
+    {
+        printf ( "%g %d %d\n", ( i + 1 ) * REPLAY_OUTPUT_INTERVAL_MS / 1000.0, SimResult.veciAutoSetting[i], HistResult.veciAutoSetting[i] );
+    }
+
+    // summary
+    printf ( "# engine      avg. setting  changes  ns/block\n" );
+    printf ( "# simulation  %12.2f  %7d  %8.1f\n", SimResult.dAvgSetting, SimResult.iNumSettingChanges, SimResult.dTimeNsPerBlock );
+    printf ( "# histogram   %12.2f  %7d  %8.1f\n", HistResult.dAvgSetting, HistResult.iNumSettingChanges, HistResult.dTimeNsPerBlock );
+    printf ( "# final error rates per simulated buffer size (simulation / histogram):\n" );
+
+    for ( int i = 0; i < SimResult.vecdErrRates.Size(); i++ )
+    {
+        printf ( "#   %2d: %.6f / %.6f\n", i + 2, SimResult.vecdErrRates[i], HistResult.vecdErrRates[i] );
+    }
+
+    // buffer delay of the regular and the adaptive playout
+    SPlayoutResult RegularResult;
+    SPlayoutResult AdaptiveResult;
+
+    ReplayPlayout ( vecdArrivalMs, dBlockMs, false, RegularResult );
+    ReplayPlayout ( vecdArrivalMs, dBlockMs, true, AdaptiveResult );
+
+    printf ( "# playout     avg. delay [ms]  concealed  compressed  stretched\n" );
+    printf ( "# regular     %15.2f  %9.4f\n", RegularResult.dAvgDelayMs, RegularResult.dConcealRate );
+    printf ( "# adaptive    %15.2f  %9.4f  %10lld  %9lld\n",
+             AdaptiveResult.dAvgDelayMs,
+             AdaptiveResult.dConcealRate,
+             static_cast<long long> ( AdaptiveResult.iNumCompressed ),
+             static_cast<long long> ( AdaptiveResult.iNumStretched ) );
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+# Offline comparison of the auto jitter buffer engines, build with:
+#   qmake tools/jitter_replay/jitter_replay.pro && make
+
+TARGET = jitter_replay
+TEMPLATE = app
+
+CONFIG += console \
+    c++17
+CONFIG -= app_bundle
+
+QT = core \
+    network
+
+DEFINES += HEADLESS \
+    APP_VERSION=\\\"replay\\\"
+
+INCLUDEPATH += ../../src
+
+# util.h is not listed since its QObject classes are not used (no moc run)
+HEADERS += ../../src/buffer.h \
+    ../../src/playout.h
+
+SOURCES += jitter_replay.cpp \
+    ../../src/buffer.cpp
@@ -0,0 +1,531 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+ * Offline verification of the server mixer kernels: the kernel set of every
+ * instruction set which is available on this CPU is run on random and edge
+ * case input and the output is compared bit by bit with the scalar kernels.
+ * The delay-pan kernels are compared with the per-sample loops which they
+ * replaced. The program exits with a non-zero code on any mismatch.
+ *
+ * In the bench mode the time per call of the delay-pan kernels is compared with
+ * the per-sample loops for all delays of the panning range.
+ *
+ * Usage: mix_kernels [check] [number of random rounds, default 200]
+ *        mix_kernels bench [number of calls per kernel, default 200000]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "mixkernels.h"
+
+/* Definitions ****************************************************************/
+// maximum number of (stereo) samples per kernel call, larger than any frame
+#define CHECK_MAX_NUM_SAMPLES 300
+
+// same as in global.h (the delay-pan loops are tested up to the frame size)
+#define CHECK_MAX_DELAY_PANNING_SAMPLES 64
+
+/* Implementation *************************************************************/
+static std::mt19937 RandGen ( 1 );
+static long         iNumChecks     = 0;
+static long         iNumMismatches = 0;
+
+static bool BitEqual ( const void* pA, const void* pB, const size_t iNumBytes ) { return memcmp ( pA, pB, iNumBytes ) == 0; }
+
+static void Report ( const bool bEqual, const char* strArch, const char* strKernel, const int iNumSamples, const int iOffset )
+{
+    iNumChecks++;
+
+    if ( !bEqual )
+    {
+        iNumMismatches++;
+        printf ( "MISMATCH %s %s: %d samples, offset %d\n", strArch, strKernel, iNumSamples, iOffset );
+    }
+}
+
+// Random input with a share of edge case values (full scale, zero, values at
+// and beyond the clipping and saturation limits).
+static void FillInput ( std::vector<int16_t>& vecsIn )
+{
+    static const int16_t vsEdge[] = { -32768, -32767, -1, 0, 1, 32766, 32767 };
+
+    std::uniform_int_distribution<int> Dist ( -32768, 32767 );
+    std::uniform_int_distribution<int> Pick ( 0, 9 );
+
+    for ( size_t i = 0; i < vecsIn.size(); i++ )
+    {
+        const bool bEdge = ( Pick ( RandGen ) == 0 );
+
+        vecsIn[i] = bEdge ? vsEdge[RandGen() % ( sizeof ( vsEdge ) / sizeof ( vsEdge[0] ) )] : static_cast<int16_t> ( Dist ( RandGen ) );
+    }
+}
+
+static void FillInput ( std::vector<float>& vecfIn )
+{
+    static const float vfEdge[] = { -std::numeric_limits<float>::infinity(),
+                                    -1e9f,
+                                    -32769.0f,
+                                    -32768.5f,
+                                    -32768.0f,
+                                    -32767.9f,
+                                    -1.0001f,
+                                    -1.0f,
+                                    -0.5f,
+                                    -0.0f,
+                                    0.0f,
+                                    std::numeric_limits<float>::denorm_min(),
+                                    0.9999f,
+                                    1.0f,
+                                    1.0001f,
+                                    32766.9f,
+                                    32767.0f,
+                                    32767.5f,
+                                    32768.0f,
+                                    1e9f,
+                                    std::numeric_limits<float>::infinity() };
+
+    std::uniform_real_distribution<float> DistSmall ( -1.5f, 1.5f );
+    std::uniform_real_distribution<float> DistLarge ( -40000.0f, 40000.0f );
+    std::uniform_int_distribution<int>    Pick ( 0, 9 );
+
+    for ( size_t i = 0; i < vecfIn.size(); i++ )
+    {
+        const int iPick = Pick ( RandGen );
+
+        if ( iPick == 0 )
+        {
+            vecfIn[i] = vfEdge[RandGen() % ( sizeof ( vfEdge ) / sizeof ( vfEdge[0] ) )];
+        }
+        else
+        {
+            vecfIn[i] = ( iPick < 5 ) ? DistSmall ( RandGen ) : DistLarge ( RandGen );
+        }
+    }
+}
+
+// finite input for the accumulation (infinite samples do not occur in the mix)
+template<typename TSample>
+static void FillSource ( std::vector<TSample>& vecIn )
+{
+    FillInput ( vecIn );
+
+    for ( size_t i = 0; i < vecIn.size(); i++ )
+    {
+        if ( !std::isfinite ( static_cast<float> ( vecIn[i] ) ) )
+        {
+            vecIn[i] = 0;
+        }
+    }
+}
+
+static float RandomGain()
+{
+    static const float vfEdge[] = { 0.0f, 1.0f, -1.0f, 0.5f, 0.70710677f, 2.0f, 1e-20f };
+
+    std::uniform_real_distribution<float> Dist ( 0.0f, 2.0f );
+
+    return ( RandGen() % 4 == 0 ) ? vfEdge[RandGen() % ( sizeof ( vfEdge ) / sizeof ( vfEdge[0] ) )] : Dist ( RandGen );
+}
+
+template<typename TSample>
+static void CheckAccum ( const CMixKernels& Ref,
+                         const CMixKernels& Test,
+                         const char*        strArch,
+                         const char*        strType,
+                         const int          iNumSamples,
+                         const int          iOffset )
+{
+    const CMixKernels::CAccumKernels<TSample>& R = Ref.Accum<TSample>();
+    const CMixKernels::CAccumKernels<TSample>& T = Test.Accum<TSample>();
+
+    // the offset creates unaligned input and output pointers
+    std::vector<TSample> vecIn ( 2 * iNumSamples + iOffset + 1 );
+    std::vector<float>   vecfMixRef ( 2 * iNumSamples + iOffset + 1 );
+    std::vector<float>   vecfMixTest;
+
+    FillSource ( vecIn );
+    FillSource ( vecfMixRef );
+
+    // the mix target already contains other sources
+    for ( size_t i = 0; i < vecfMixRef.size(); i++ )
+    {
+        vecfMixRef[i] = std::fmod ( vecfMixRef[i], 100000.0f );
+    }
+
+    const float fGainL = RandomGain();
+    const float fGainR = RandomGain();
+    char        strKernel[64];
+
+    const TSample* pIn = &vecIn[iOffset];
+
+    vecfMixTest = vecfMixRef;
+    R.MonoToMono ( &vecfMixRef[iOffset], pIn, iNumSamples, fGainL );
+    T.MonoToMono ( &vecfMixTest[iOffset], pIn, iNumSamples, fGainL );
+    snprintf ( strKernel, sizeof ( strKernel ), "%s MonoToMono", strType );
+    Report ( BitEqual ( &vecfMixRef[0], &vecfMixTest[0], vecfMixRef.size() * sizeof ( float ) ), strArch, strKernel, iNumSamples, iOffset );
+
+    vecfMixTest = vecfMixRef;
+    R.StereoToMono ( &vecfMixRef[iOffset], pIn, iNumSamples, fGainL );
+    T.StereoToMono ( &vecfMixTest[iOffset], pIn, iNumSamples, fGainL );
+    snprintf ( strKernel, sizeof ( strKernel ), "%s StereoToMono", strType );
+    Report ( BitEqual ( &vecfMixRef[0], &vecfMixTest[0], vecfMixRef.size() * sizeof ( float ) ), strArch, strKernel, iNumSamples, iOffset );
+
+    vecfMixTest = vecfMixRef;
+    R.MonoToStereo ( &vecfMixRef[iOffset], pIn, iNumSamples, fGainL, fGainR );
+    T.MonoToStereo ( &vecfMixTest[iOffset], pIn, iNumSamples, fGainL, fGainR );
+    snprintf ( strKernel, sizeof ( strKernel ), "%s MonoToStereo", strType );
+    Report ( BitEqual ( &vecfMixRef[0], &vecfMixTest[0], vecfMixRef.size() * sizeof ( float ) ), strArch, strKernel, iNumSamples, iOffset );
+
+    vecfMixTest = vecfMixRef;
+    R.StereoToStereo ( &vecfMixRef[iOffset], pIn, iNumSamples, fGainL, fGainR );
+    T.StereoToStereo ( &vecfMixTest[iOffset], pIn, iNumSamples, fGainL, fGainR );
+    snprintf ( strKernel, sizeof ( strKernel ), "%s StereoToStereo", strType );
+    Report ( BitEqual ( &vecfMixRef[0], &vecfMixTest[0], vecfMixRef.size() * sizeof ( float ) ), strArch, strKernel, iNumSamples, iOffset );
+}
+
+static void CheckOutput ( const CMixKernels& Ref, const CMixKernels& Test, const char* strArch, const int iNumValues, const int iOffset )
+{
+    std::vector<float>   vecfIn ( iNumValues + iOffset + 1 );
+    std::vector<int16_t> vecsOutRef ( vecfIn.size(), 0x5555 );
+    std::vector<int16_t> vecsOutTest ( vecfIn.size(), 0x5555 );
+    std::vector<float>   vecfOutRef ( vecfIn.size(), -7.0f );
+    std::vector<float>   vecfOutTest ( vecfIn.size(), -7.0f );
+
+    FillInput ( vecfIn );
+
+    Ref.Saturate ( &vecsOutRef[iOffset], &vecfIn[iOffset], iNumValues );
+    Test.Saturate ( &vecsOutTest[iOffset], &vecfIn[iOffset], iNumValues );
+    Report ( vecsOutRef == vecsOutTest, strArch, "Saturate", iNumValues, iOffset );
+
+    Ref.Clip ( &vecfOutRef[iOffset], &vecfIn[iOffset], iNumValues );
+    Test.Clip ( &vecfOutTest[iOffset], &vecfIn[iOffset], iNumValues );
+    Report ( BitEqual ( &vecfOutRef[0], &vecfOutTest[0], vecfOutRef.size() * sizeof ( float ) ), strArch, "Clip", iNumValues, iOffset );
+}
+
+// The per-sample delay-pan loops of the server before the specialised kernels.
+template<typename TSample>
+static void DelayPanReference ( float*         pfOut,
+                                const TSample* pIn,
+                                const TSample* pInPrev,
+                                const int      iNumSrcChannels,
+                                const int      iNumSamples,
+                                const int      iDelayL,
+                                const int      iDelayR,
+                                const float    fGainL,
+                                const float    fGainR )
+{
+    if ( iNumSrcChannels == 1 )
+    {
+        for ( int i = 0, k = 0; i < iNumSamples; i++, k += 2 )
+        {
+            int iLpan = i - iDelayL;
+            int iRpan = i - iDelayR;
+
+            if ( iLpan < 0 )
+            {
+                iLpan = iLpan + iNumSamples;
+                pfOut[k] += pInPrev[iLpan] * fGainL;
+            }
+            else
+            {
+                pfOut[k] += pIn[iLpan] * fGainL;
+            }
+
+            if ( iRpan < 0 )
+            {
+                iRpan = iRpan + iNumSamples;
+                pfOut[k + 1] += pInPrev[iRpan] * fGainR;
+            }
+            else
+            {
+                pfOut[k + 1] += pIn[iRpan] * fGainR;
+            }
+        }
+    }
+    else
+    {
+        for ( int i = 0; i < ( 2 * iNumSamples ); i++ )
+        {
+            int         iPan  = ( ( i & 1 ) == 0 ) ? i - 2 * iDelayL : i - 2 * iDelayR;
+            const float fGain = ( ( i & 1 ) == 0 ) ? fGainL : fGainR;
+
+            if ( iPan < 0 )
+            {
+                iPan = iPan + 2 * iNumSamples;
+                pfOut[i] += pInPrev[iPan] * fGain;
+            }
+            else
+            {
+                pfOut[i] += pIn[iPan] * fGain;
+            }
+        }
+    }
+}
+
+template<typename TSample>
+static CMixKernels::TDelayPanFct<TSample> GetDelayPanFct ( const int iNumSrcChannels, const bool bUnity )
+{
+    if ( iNumSrcChannels == 1 )
+    {
+        return bUnity ? CMixKernels::DelayPanToStereo<TSample, 1, true> : CMixKernels::DelayPanToStereo<TSample, 1, false>;
+    }
+
+    return bUnity ? CMixKernels::DelayPanToStereo<TSample, 2, true> : CMixKernels::DelayPanToStereo<TSample, 2, false>;
+}
+
+template<typename TSample>
+static void CheckDelayPan ( const char* strType, const int iNumSamples )
+{
+    std::vector<TSample> vecIn ( 2 * iNumSamples );
+    std::vector<TSample> vecInPrev ( 2 * iNumSamples );
+    std::vector<float>   vecfMixRef ( 2 * iNumSamples );
+    std::vector<float>   vecfMixTest;
+
+    for ( int iNumSrcChannels = 1; iNumSrcChannels <= 2; iNumSrcChannels++ )
+    {
+        for ( int iDelay = -( CHECK_MAX_DELAY_PANNING_SAMPLES - 1 ); iDelay < CHECK_MAX_DELAY_PANNING_SAMPLES; iDelay++ )
+        {
+            const int iDelayL = ( iDelay > 0 ) ? iDelay : 0;
+            const int iDelayR = ( iDelay < 0 ) ? -iDelay : 0;
+
+            // the delay cannot exceed the frame (64 samples frames with the maximum delay)
+            if ( std::max ( iDelayL, iDelayR ) > iNumSamples )
+            {
+                continue;
+            }
+
+            for ( int iUnity = 0; iUnity < 2; iUnity++ )
+            {
+                const float fGain  = iUnity ? 1.0f : RandomGain();
+                const float fGainL = iUnity ? 1.0f : fGain;
+                const float fGainR = iUnity ? 1.0f : RandomGain();
+
+                FillSource ( vecIn );
+                FillSource ( vecInPrev );
+                FillSource ( vecfMixRef );
+                vecfMixTest = vecfMixRef;
+
+                DelayPanReference ( &vecfMixRef[0], &vecIn[0], &vecInPrev[0], iNumSrcChannels, iNumSamples, iDelayL, iDelayR, fGainL, fGainR );
+
+                const CMixKernels::TDelayPanFct<TSample> DelayPanToStereo = GetDelayPanFct<TSample> ( iNumSrcChannels, iUnity != 0 );
+
+                DelayPanToStereo ( &vecfMixTest[0], &vecIn[0], &vecInPrev[0], iNumSamples, iDelayL, iDelayR, fGainL, fGainR );
+
+                char strKernel[64];
+                snprintf ( strKernel,
+                           sizeof ( strKernel ),
+                           "%s DelayPanToStereo<%d, %s> delay %d",
+                           strType,
+                           iNumSrcChannels,
+                           iUnity ? "true" : "false",
+                           iDelay );
+                Report ( BitEqual ( &vecfMixRef[0], &vecfMixTest[0], vecfMixRef.size() * sizeof ( float ) ), "generic", strKernel, iNumSamples, 0 );
+            }
+        }
+    }
+}
+
+// Time per call of the per-sample loops and of the delay-pan kernel, the delay
+// is changed on every call so that all branches of the loops are taken.
+template<typename TSample>
+static void BenchDelayPan ( const char* strType, const int iNumSrcChannels, const bool bUnity, const int iNumSamples, const int iNumCalls )
+{
+    typedef std::chrono::steady_clock TClock;
+
+    std::vector<TSample> vecIn ( 2 * iNumSamples );
+    std::vector<TSample> vecInPrev ( 2 * iNumSamples );
+    std::vector<float>   vecfMix ( 2 * iNumSamples, 0.0f );
+
+    FillSource ( vecIn );
+    FillSource ( vecInPrev );
+
+    const float fGainL = bUnity ? 1.0f : 0.8f;
+    const float fGainR = bUnity ? 1.0f : 0.6f;
+    const int   iRange = 2 * std::min ( CHECK_MAX_DELAY_PANNING_SAMPLES - 1, iNumSamples ) + 1;
+
+    const CMixKernels::TDelayPanFct<TSample> DelayPanToStereo = GetDelayPanFct<TSample> ( iNumSrcChannels, bUnity );
+
+    double dNsPerCall[2];
+
+    for ( int iVariant = 0; iVariant < 2; iVariant++ )
+    {
+        const TClock::time_point Start = TClock::now();
+
+        for ( int iCall = 0; iCall < iNumCalls; iCall++ )
+        {
+            const int iDelay  = iCall % iRange - iRange / 2;
+            const int iDelayL = ( iDelay > 0 ) ? iDelay : 0;
+            const int iDelayR = ( iDelay < 0 ) ? -iDelay : 0;
+
+            if ( iVariant == 0 )
+            {
+                DelayPanReference ( &vecfMix[0], &vecIn[0], &vecInPrev[0], iNumSrcChannels, iNumSamples, iDelayL, iDelayR, fGainL, fGainR );
+            }
+            else
+            {
+                DelayPanToStereo ( &vecfMix[0], &vecIn[0], &vecInPrev[0], iNumSamples, iDelayL, iDelayR, fGainL, fGainR );
+            }
+
+            // keep the mix in a finite range
+            if ( ( iCall & 255 ) == 255 )
+            {
+                std::fill ( vecfMix.begin(), vecfMix.end(), 0.0f );
+            }
+        }
+
+        dNsPerCall[iVariant] = std::chrono::duration<double, std::nano> ( TClock::now() - Start ).count() / iNumCalls;
+    }
+
+    // the mix is printed so that the calls cannot be optimized away
+    printf ( "%-6s %-6s %-5s %8d %12.1f %12.1f %8.2fx  (%g)\n",
+             strType,
+             ( iNumSrcChannels == 1 ) ? "mono" : "stereo",
+             bUnity ? "unity" : "gain",
+             iNumSamples,
+             dNsPerCall[0],
+             dNsPerCall[1],
+             dNsPerCall[0] / dNsPerCall[1],
+             static_cast<double> ( vecfMix[0] ) );
+}
+
+static int RunBench ( const int iNumCalls )
+{
+    printf ( "delay-pan time per call in ns:\n" );
+    printf ( "%-6s %-6s %-5s %8s %12s %12s %9s\n", "type", "source", "gain", "samples", "per-sample", "kernel", "speedup" );
+
+    for ( int iNumSamples = 64; iNumSamples <= 128; iNumSamples += 64 )
+    {
+        for ( int iNumSrcChannels = 1; iNumSrcChannels <= 2; iNumSrcChannels++ )
+        {
+            for ( int iUnity = 1; iUnity >= 0; iUnity-- )
+            {
+                BenchDelayPan<int16_t> ( "int16", iNumSrcChannels, iUnity != 0, iNumSamples, iNumCalls );
+                BenchDelayPan<float> ( "float", iNumSrcChannels, iUnity != 0, iNumSamples, iNumCalls );
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int RunCheck ( const int iNumRounds )
+{
+    CMixKernels Ref;
+    Ref.SetArch ( CMixKernels::KA_SCALAR );
+
+    const CMixKernels::EKernelArch eDetected = CMixKernels::DetectArch();
+
+    printf ( "detected kernel set: %s\n", CMixKernels::GetArchName ( eDetected ) );
+
+    // all sets up to the detected one are supported by the CPU (on x86 the AVX2
+    // capable CPUs also support SSE2)
+    std::vector<CMixKernels::EKernelArch> vecArchs;
+
+    if ( eDetected == CMixKernels::KA_NEON )
+    {
+        vecArchs.push_back ( CMixKernels::KA_NEON );
+    }
+    else
+    {
+        if ( eDetected >= CMixKernels::KA_SSE2 )
+        {
+            vecArchs.push_back ( CMixKernels::KA_SSE2 );
+        }
+
+        if ( eDetected >= CMixKernels::KA_AVX2 )
+        {
+            vecArchs.push_back ( CMixKernels::KA_AVX2 );
+        }
+    }
+
+    for ( size_t iA = 0; iA < vecArchs.size(); iA++ )
+    {
+        CMixKernels Test;
+        Test.SetArch ( vecArchs[iA] );
+
+        const char* strArch = CMixKernels::GetArchName ( Test.GetArch() );
+
+        if ( Test.GetArch() != vecArchs[iA] )
+        {
+            printf ( "kernel set %s is not available in this build\n", CMixKernels::GetArchName ( vecArchs[iA] ) );
+            continue;
+        }
+
+        // all lengths around the vector widths and the frame sizes, then random lengths
+        for ( int iRound = 0; iRound < CHECK_MAX_NUM_SAMPLES + iNumRounds; iRound++ )
+        {
+            const int iNumSamples = ( iRound < CHECK_MAX_NUM_SAMPLES ) ? iRound : static_cast<int> ( RandGen() % CHECK_MAX_NUM_SAMPLES );
+            const int iOffset     = static_cast<int> ( RandGen() % 8 );
+
+            CheckAccum<int16_t> ( Ref, Test, strArch, "int16", iNumSamples, iOffset );
+            CheckAccum<float> ( Ref, Test, strArch, "float", iNumSamples, iOffset );
+            CheckOutput ( Ref, Test, strArch, 2 * iNumSamples, iOffset );
+        }
+    }
+
+    // the delay-pan kernels are not instruction set specific
+    for ( int iNumSamples = 64; iNumSamples <= 128; iNumSamples += 64 )
+    {
+        for ( int iRound = 0; iRound < std::max ( 1, iNumRounds / 50 ); iRound++ )
+        {
+            CheckDelayPan<int16_t> ( "int16", iNumSamples );
+            CheckDelayPan<float> ( "float", iNumSamples );
+        }
+    }
+
+    printf ( "%ld checks, %ld mismatches\n", iNumChecks, iNumMismatches );
+
+    return ( iNumMismatches == 0 ) ? 0 : 1;
+}
+
+int main ( int argc, char** argv )
+{
+    int  iArg   = 1;
+    bool bBench = false;
+
+    if ( ( argc > iArg ) && ( ( strcmp ( argv[iArg], "check" ) == 0 ) || ( strcmp ( argv[iArg], "bench" ) == 0 ) ) )
+    {
+        bBench = ( strcmp ( argv[iArg], "bench" ) == 0 );
+        iArg++;
+    }
+
+    const int iNumRounds = ( argc > iArg ) ? atoi ( argv[iArg] ) : ( bBench ? 200000 : 200 );
+
+    if ( ( iNumRounds < 0 ) || ( bBench && ( iNumRounds == 0 ) ) )
+    {
+        fprintf ( stderr, "usage: %s [check] [number of random rounds]\n", argv[0] );
+        fprintf ( stderr, "       %s bench [number of calls per kernel]\n", argv[0] );
+        return 2;
+    }
+
+    return bBench ? RunBench ( iNumRounds ) : RunCheck ( iNumRounds );
+}
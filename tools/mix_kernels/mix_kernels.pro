@@ -0,0 +1,17 @@
+# Bit-exactness check and delay-pan benchmark of the server mixer kernels, build and run with:
+#   qmake tools/mix_kernels/mix_kernels.pro && make && ./mix_kernels [check | bench]
+
+TARGET = mix_kernels
+TEMPLATE = app
+
+CONFIG += console \
+    c++17
+CONFIG -= app_bundle \
+    qt
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/mixkernels.h
+
+SOURCES += mix_kernels.cpp \
+    ../../src/mixkernels.cpp
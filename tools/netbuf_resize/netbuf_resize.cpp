@@ -0,0 +1,589 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+ * Randomized comparison of the preserving CNetBuf::Init() (which rotates the
+ * slot mapping) with the copying implementation it replaced. Both buffers get
+ * the same random sequence of Put(), Get()/GetInPlace() and preserving Init()
+ * calls with a grown or shrunk buffer size, with and without sequence numbers.
+ * Rarely the sequence number mode or the block size is changed by a
+ * non-preserving Init() (as on a change of the network transport properties).
+ * The sequence numbers of the packets jitter around the sender counter and
+ * sometimes jump so that the buffer window is moved in both directions.
+ *
+ * After every call the return values, the received blocks, the fill level and
+ * the next block availability must be equal. The block of the last
+ * GetInPlace() call (the spare slot) must not change until the next Get() or
+ * GetInPlace() call, also not by an Init() (which may reallocate the memory
+ * several times if the block size changes) or Put(). The program exits with a
+ * non-zero code on a mismatch or if a case was not covered (grow and shrink,
+ * each with a wrapped get position and with a pending GetInPlace() block, and
+ * a pending block which survives two reallocations). Build with
+ * -fsanitize=address to detect a pending block in freed memory.
+ *
+ * Usage: netbuf_resize [number of rounds, default 2000]
+ *                      [number of calls per round, default 500]
+ *                      [random seed, default 1]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "buffer.h"
+
+/* Definitions ****************************************************************/
+// range of the block size in bytes (coded audio block)
+#define TEST_MIN_BLOCK_SIZE 8
+#define TEST_MAX_BLOCK_SIZE 24
+
+/* Implementation *************************************************************/
+// The network buffer before the slot mapping: one memory per block position,
+// the preserving Init() copies the blocks to a temporary memory and back.
+class CCopyingNetBuf
+{
+public:
+    CCopyingNetBuf() : iSequenceNumberAtGetPos ( 0 ), bIsInitialized ( false ) {}
+
+    void Init ( const int iNewBlockSize, const int iNewNumBlocks, const bool bNUseSequenceNumber, const bool bPreserve )
+    {
+        bUseSequenceNumber = bNUseSequenceNumber;
+
+        if ( bPreserve && bIsInitialized && ( iBlockSize == iNewBlockSize ) )
+        {
+            std::vector<std::vector<uint8_t>> vecvecTempMemory = vecvecMemory;
+
+            if ( !bNUseSequenceNumber )
+            {
+                int iPreviousDataCnt = 0;
+
+                while ( Get ( vecvecTempMemory[iPreviousDataCnt], iBlockSize ) )
+                {
+                    iPreviousDataCnt++;
+                }
+
+                Resize ( iNewNumBlocks, iNewBlockSize );
+
+                int iDataCnt = 0;
+
+                while ( ( iDataCnt < iPreviousDataCnt ) && Put ( &vecvecTempMemory[iDataCnt][0], iBlockSize ) )
+                {
+                    iDataCnt++;
+                }
+            }
+            else
+            {
+                std::vector<int> veciTempBlockValid ( iNumBlocksMemory );
+                const uint8_t    iOldSequenceNumberAtGetPos = iSequenceNumberAtGetPos;
+                const int        iOldNumBlocksMemory        = iNumBlocksMemory;
+
+                for ( int iCurPos = 0; iCurPos < iOldNumBlocksMemory; iCurPos++ )
+                {
+                    const int iOldPos = ( iBlockGetPos + iCurPos ) % iOldNumBlocksMemory;
+
+                    veciTempBlockValid[iCurPos] = veciBlockValid[iOldPos];
+                    vecvecTempMemory[iCurPos]   = vecvecMemory[iOldPos];
+                }
+
+                Resize ( iNewNumBlocks, iNewBlockSize );
+
+                iSequenceNumberAtGetPos = iOldSequenceNumberAtGetPos;
+
+                for ( int iCurPos = 0; iCurPos < std::min ( iNewNumBlocks, iOldNumBlocksMemory ); iCurPos++ )
+                {
+                    veciBlockValid[iCurPos] = veciTempBlockValid[iCurPos];
+                    vecvecMemory[iCurPos]   = vecvecTempMemory[iCurPos];
+                }
+            }
+        }
+        else
+        {
+            Resize ( iNewNumBlocks, iNewBlockSize );
+        }
+
+        bIsInitialized = true;
+    }
+
+    bool Put ( const uint8_t* pbyData, const int iInSize )
+    {
+        if ( bUseSequenceNumber )
+        {
+            if ( ( iInSize % ( iBlockSize + 1 ) ) != 0 )
+            {
+                return false;
+            }
+
+            const int iNumBlocks = iInSize / iBlockSize;
+
+            for ( int iBlock = 0; iBlock < iNumBlocks; iBlock++ )
+            {
+                const int iBlockOffset = iBlock * ( iBlockSize + 1 );
+                int       iSeqNumDiff  = pbyData[iBlockOffset + iBlockSize] - static_cast<int> ( iSequenceNumberAtGetPos );
+
+                if ( iSeqNumDiff < -128 )
+                {
+                    iSeqNumDiff += 256;
+                }
+                else if ( iSeqNumDiff >= 128 )
+                {
+                    iSeqNumDiff -= 256;
+                }
+
+                if ( iSeqNumDiff < 0 )
+                {
+                    // too late: move the window to the past
+                    for ( int i = iSeqNumDiff; i < 0; i++ )
+                    {
+                        veciBlockValid[iBlockGetPos] = 0;
+                        iSequenceNumberAtGetPos--;
+                        iBlockGetPos = ( iBlockGetPos + iNumBlocksMemory - 1 ) % iNumBlocksMemory;
+                    }
+
+                    iBlockPutPos = iBlockGetPos;
+                }
+                else if ( iSeqNumDiff >= iNumBlocksMemory )
+                {
+                    // too early: move the window to the future
+                    for ( int i = 0; i < iSeqNumDiff - iNumBlocksMemory + 1; i++ )
+                    {
+                        veciBlockValid[iBlockGetPos] = 0;
+                        iSequenceNumberAtGetPos++;
+                        iBlockGetPos = ( iBlockGetPos + 1 ) % iNumBlocksMemory;
+                    }
+
+                    iBlockPutPos = ( iBlockGetPos + iNumBlocksMemory - 1 ) % iNumBlocksMemory;
+                }
+                else
+                {
+                    iBlockPutPos = ( iBlockGetPos + iSeqNumDiff ) % iNumBlocksMemory;
+                }
+
+                std::copy ( pbyData + iBlockOffset, pbyData + iBlockOffset + iBlockSize, vecvecMemory[iBlockPutPos].begin() );
+                veciBlockValid[iBlockPutPos] = 1;
+            }
+        }
+        else
+        {
+            if ( ( GetAvailSpace() < iInSize ) || ( ( iInSize % iBlockSize ) != 0 ) )
+            {
+                return false;
+            }
+
+            for ( int iBlock = 0; iBlock < iInSize / iBlockSize; iBlock++ )
+            {
+                std::copy ( pbyData + iBlock * iBlockSize, pbyData + ( iBlock + 1 ) * iBlockSize, vecvecMemory[iBlockPutPos].begin() );
+                iBlockPutPos = ( iBlockPutPos + 1 ) % iNumBlocksMemory;
+            }
+
+            eBufState = ( iBlockPutPos == iBlockGetPos ) ? BS_FULL : BS_OK;
+        }
+
+        return true;
+    }
+
+    bool Get ( std::vector<uint8_t>& vecbyData, const int iOutSize )
+    {
+        if ( ( iOutSize == 0 ) || ( iOutSize != iBlockSize ) || ( GetAvailData() < iOutSize ) )
+        {
+            return false;
+        }
+
+        bool bReturn = true;
+
+        if ( bUseSequenceNumber )
+        {
+            bReturn                      = ( veciBlockValid[iBlockGetPos] > 0 );
+            veciBlockValid[iBlockGetPos] = 0;
+        }
+
+        if ( bReturn )
+        {
+            vecbyData = vecvecMemory[iBlockGetPos];
+        }
+
+        iBlockGetPos = ( iBlockGetPos + 1 ) % iNumBlocksMemory;
+        iSequenceNumberAtGetPos++;
+        eBufState = ( iBlockPutPos == iBlockGetPos ) ? BS_EMPTY : BS_OK;
+
+        return bReturn;
+    }
+
+    bool IsNextBlockAvailable ( const int iOutSize ) const
+    {
+        if ( ( iOutSize == 0 ) || ( iOutSize != iBlockSize ) || ( GetAvailData() < iOutSize ) )
+        {
+            return false;
+        }
+
+        return !bUseSequenceNumber || ( veciBlockValid[iBlockGetPos] > 0 );
+    }
+
+    int GetFillLevel() const
+    {
+        if ( !bUseSequenceNumber )
+        {
+            return GetAvailData() / iBlockSize;
+        }
+
+        for ( int iNumBlocks = iNumBlocksMemory; iNumBlocks > 0; iNumBlocks-- )
+        {
+            if ( veciBlockValid[( iBlockGetPos + iNumBlocks - 1 ) % iNumBlocksMemory] > 0 )
+            {
+                return iNumBlocks;
+            }
+        }
+
+        return 0;
+    }
+
+protected:
+    enum EBufState
+    {
+        BS_OK,
+        BS_FULL,
+        BS_EMPTY
+    };
+
+    void Resize ( const int iNewNumBlocks, const int iNewBlockSize )
+    {
+        vecvecMemory.assign ( iNewNumBlocks, std::vector<uint8_t> ( iNewBlockSize ) );
+        veciBlockValid.assign ( iNewNumBlocks, 0 );
+
+        iBlockGetPos     = 0;
+        iBlockPutPos     = 0;
+        eBufState        = BS_EMPTY;
+        iBlockSize       = iNewBlockSize;
+        iNumBlocksMemory = iNewNumBlocks;
+    }
+
+    int GetAvailSpace() const
+    {
+        int iAvBlocks = iBlockGetPos - iBlockPutPos;
+
+        if ( iAvBlocks < 0 )
+        {
+            iAvBlocks += iNumBlocksMemory;
+        }
+        else if ( ( iAvBlocks == 0 ) && ( eBufState == BS_EMPTY ) )
+        {
+            iAvBlocks = iNumBlocksMemory;
+        }
+
+        return iAvBlocks * iBlockSize;
+    }
+
+    int GetAvailData() const
+    {
+        int iAvBlocks = iNumBlocksMemory;
+
+        if ( !bUseSequenceNumber )
+        {
+            iAvBlocks = iBlockPutPos - iBlockGetPos;
+
+            if ( iAvBlocks < 0 )
+            {
+                iAvBlocks += iNumBlocksMemory;
+            }
+            else if ( ( iAvBlocks == 0 ) && ( eBufState == BS_FULL ) )
+            {
+                iAvBlocks = iNumBlocksMemory;
+            }
+        }
+
+        return iAvBlocks * iBlockSize;
+    }
+
+    std::vector<std::vector<uint8_t>> vecvecMemory;
+    std::vector<int>                  veciBlockValid;
+    int                               iNumBlocksMemory;
+    int                               iBlockGetPos;
+    int                               iBlockPutPos;
+    int                               iBlockSize;
+    uint8_t                           iSequenceNumberAtGetPos;
+    EBufState                         eBufState;
+    bool                              bUseSequenceNumber;
+    bool                              bIsInitialized;
+};
+
+// gives access to the get position of the buffer under test
+class CTestNetBuf : public CNetBuf
+{
+public:
+    int GetBlockGetPos() const { return iBlockGetPos; }
+    int GetNumBlocks() const { return iNumBlocksMemory; }
+};
+
+struct SCoverage
+{
+    SCoverage() : iNumCalls ( 0 ), iNumMismatches ( 0 )
+    {
+        memset ( iNumInits, 0, sizeof ( iNumInits ) );
+        memset ( iNumWrapped, 0, sizeof ( iNumWrapped ) );
+        memset ( iNumPending, 0, sizeof ( iNumPending ) );
+        iNumReallocPending = 0;
+    }
+
+    long iNumCalls;
+    long iNumMismatches;
+    long iNumInits[2]; // shrink, grow
+    long iNumWrapped[2];
+    long iNumPending[2];
+    long iNumReallocPending; // pending block after the second reallocation
+};
+
+static void RunRound ( std::mt19937& RandGen, const int iNumCalls, SCoverage* pCoverage )
+{
+    const int iBlockSizeRange    = TEST_MAX_BLOCK_SIZE - TEST_MIN_BLOCK_SIZE + 1;
+    bool      bUseSequenceNumber = ( RandGen() % 2 ) != 0;
+    int       iBlockSize         = TEST_MIN_BLOCK_SIZE + static_cast<int> ( RandGen() % iBlockSizeRange );
+    const int iSizeRange         = MAX_NET_BUF_SIZE_NUM_BL - MIN_NET_BUF_SIZE_NUM_BL + 1;
+
+    CTestNetBuf    NetBuf;
+    CCopyingNetBuf RefBuf;
+
+    const int iInitNumBlocks = MIN_NET_BUF_SIZE_NUM_BL + static_cast<int> ( RandGen() % iSizeRange );
+
+    NetBuf.Init ( iBlockSize, iInitNumBlocks, bUseSequenceNumber );
+    RefBuf.Init ( iBlockSize, iInitNumBlocks, bUseSequenceNumber, false );
+
+    std::vector<uint8_t> vecbyPacket;
+    std::vector<uint8_t> vecbyRefBlock ( iBlockSize );
+    CVector<uint8_t>     vecbyBlock ( iBlockSize );
+    const uint8_t*       pbyPending = nullptr; // block of the last GetInPlace() call
+    std::vector<uint8_t> vecbyPending ( iBlockSize );
+    int                  iPendingSize      = 0;
+    int                  iNumPendingAllocs = 0; // reallocations since the pending block was returned
+    uint8_t              iSenderSeqNum = static_cast<uint8_t> ( RandGen() );
+    uint8_t              iContent      = 0;
+
+    for ( int iCall = 0; iCall < iNumCalls; iCall++ )
+    {
+        // the calls are counted for the mode before the call
+        SCoverage&         Coverage = pCoverage[bUseSequenceNumber ? 1 : 0];
+        const unsigned int iAction  = RandGen() % 200;
+        bool               bMatches = true;
+
+        if ( iAction < 2 )
+        {
+            // the transport properties changed (the sequence number at the get
+            // position is kept by the non-preserving Init())
+            bUseSequenceNumber = !bUseSequenceNumber;
+
+            NetBuf.Init ( iBlockSize, NetBuf.GetNumBlocks(), bUseSequenceNumber );
+            RefBuf.Init ( iBlockSize, NetBuf.GetNumBlocks(), bUseSequenceNumber, false );
+        }
+        else if ( iAction < 6 )
+        {
+            // the codec changed, the memory is reallocated for the new block size
+            iBlockSize = TEST_MIN_BLOCK_SIZE + ( iBlockSize - TEST_MIN_BLOCK_SIZE + 1 + static_cast<int> ( RandGen() % ( iBlockSizeRange - 1 ) ) ) %
+                                                   iBlockSizeRange;
+
+            vecbyRefBlock.resize ( iBlockSize );
+            vecbyBlock.Init ( iBlockSize );
+
+            if ( ( pbyPending != nullptr ) && ( ++iNumPendingAllocs == 2 ) )
+            {
+                Coverage.iNumReallocPending++;
+            }
+
+            NetBuf.Init ( iBlockSize, NetBuf.GetNumBlocks(), bUseSequenceNumber );
+            RefBuf.Init ( iBlockSize, NetBuf.GetNumBlocks(), bUseSequenceNumber, false );
+        }
+        else if ( iAction < 90 )
+        {
+            // one or two blocks, with sequence numbers one block per packet is typical
+            const int iNumBlocks = bUseSequenceNumber ? 1 : 1 + static_cast<int> ( RandGen() % 2 );
+            const int iStride    = bUseSequenceNumber ? iBlockSize + 1 : iBlockSize;
+
+            vecbyPacket.resize ( iNumBlocks * iStride );
+
+            for ( int iBlock = 0; iBlock < iNumBlocks; iBlock++ )
+            {
+                for ( int i = 0; i < iBlockSize; i++ )
+                {
+                    vecbyPacket[iBlock * iStride + i] = iContent++;
+                }
+
+                if ( bUseSequenceNumber )
+                {
+                    // jitter, rarely a jump far out of the buffer window
+                    int iOffset = static_cast<int> ( RandGen() % 9 ) - 4;
+
+                    if ( RandGen() % 50 == 0 )
+                    {
+                        iOffset = ( RandGen() % 2 ? 1 : -1 ) * ( MAX_NET_BUF_SIZE_NUM_BL + static_cast<int> ( RandGen() % 20 ) );
+                    }
+
+                    vecbyPacket[iBlock * iStride + iBlockSize] = static_cast<uint8_t> ( iSenderSeqNum + iOffset );
+                    iSenderSeqNum++;
+                }
+            }
+
+            bMatches = NetBuf.Put ( &vecbyPacket[0], iNumBlocks * iStride ) == RefBuf.Put ( &vecbyPacket[0], iNumBlocks * iStride );
+        }
+        else if ( iAction < 180 )
+        {
+            const bool bRefReturn = RefBuf.Get ( vecbyRefBlock, iBlockSize );
+
+            if ( iAction < 160 )
+            {
+                const uint8_t* pbyBlock = nullptr;
+                const bool     bReturn  = NetBuf.GetInPlace ( pbyBlock, iBlockSize );
+
+                bMatches = ( bReturn == bRefReturn ) && ( ( pbyBlock != nullptr ) == bReturn );
+
+                if ( bMatches && bReturn )
+                {
+                    bMatches = ( memcmp ( pbyBlock, &vecbyRefBlock[0], iBlockSize ) == 0 );
+                    vecbyPending.assign ( pbyBlock, pbyBlock + iBlockSize );
+                }
+
+                pbyPending        = bReturn ? pbyBlock : nullptr;
+                iPendingSize      = iBlockSize;
+                iNumPendingAllocs = 0;
+            }
+            else
+            {
+                const bool bReturn = NetBuf.Get ( vecbyBlock, iBlockSize );
+
+                bMatches = ( bReturn == bRefReturn ) && ( !bReturn || ( memcmp ( &vecbyBlock[0], &vecbyRefBlock[0], iBlockSize ) == 0 ) );
+
+                pbyPending = nullptr;
+            }
+        }
+        else
+        {
+            int iNewNumBlocks = MIN_NET_BUF_SIZE_NUM_BL + static_cast<int> ( RandGen() % iSizeRange );
+
+            if ( iNewNumBlocks == NetBuf.GetNumBlocks() )
+            {
+                iNewNumBlocks = ( iNewNumBlocks == MAX_NET_BUF_SIZE_NUM_BL ) ? MIN_NET_BUF_SIZE_NUM_BL : iNewNumBlocks + 1;
+            }
+
+            const int iGrow = ( iNewNumBlocks > NetBuf.GetNumBlocks() ) ? 1 : 0;
+
+            Coverage.iNumInits[iGrow]++;
+            Coverage.iNumWrapped[iGrow] += ( NetBuf.GetBlockGetPos() != 0 ) ? 1 : 0;
+            Coverage.iNumPending[iGrow] += ( pbyPending != nullptr ) ? 1 : 0;
+
+            NetBuf.Init ( iBlockSize, iNewNumBlocks, bUseSequenceNumber, true );
+            RefBuf.Init ( iBlockSize, iNewNumBlocks, bUseSequenceNumber, true );
+        }
+
+        // the pending block must stay untouched until the next Get()/GetInPlace()
+        if ( ( pbyPending != nullptr ) && ( memcmp ( pbyPending, &vecbyPending[0], iPendingSize ) != 0 ) )
+        {
+            bMatches = false;
+        }
+
+        if ( ( NetBuf.GetFillLevel() != RefBuf.GetFillLevel() ) ||
+             ( NetBuf.IsNextBlockAvailable ( iBlockSize ) != RefBuf.IsNextBlockAvailable ( iBlockSize ) ) )
+        {
+            bMatches = false;
+        }
+
+        Coverage.iNumCalls++;
+
+        if ( !bMatches )
+        {
+            Coverage.iNumMismatches++;
+        }
+    }
+}
+
+int main ( int argc, char** argv )
+{
+    const int          iNumRounds = ( argc > 1 ) ? atoi ( argv[1] ) : 2000;
+    const int          iNumCalls  = ( argc > 2 ) ? atoi ( argv[2] ) : 500;
+    const unsigned int iSeed      = ( argc > 3 ) ? static_cast<unsigned int> ( atoi ( argv[3] ) ) : 1;
+
+    if ( ( iNumRounds < 1 ) || ( iNumCalls < 1 ) )
+    {
+        fprintf ( stderr, "usage: %s [rounds] [calls per round] [seed]\n", argv[0] );
+        return 2;
+    }
+
+    printf ( "%d rounds, %d calls per round, seed %u\n", iNumRounds, iNumCalls, iSeed );
+    printf ( "%-12s %10s %8s %8s %10s %10s %10s %10s %12s %10s\n",
+             "mode",
+             "calls",
+             "shrinks",
+             "grows",
+             "shr wrap",
+             "grow wrap",
+             "shr pend",
+             "grow pend",
+             "realloc pend",
+             "mismatch" );
+
+    std::mt19937 RandGen ( iSeed );
+    SCoverage    vecCoverage[2]; // without, with sequence numbers
+
+    for ( int iRound = 0; iRound < iNumRounds; iRound++ )
+    {
+        RunRound ( RandGen, iNumCalls, vecCoverage );
+    }
+
+    bool bFailed = false;
+
+    for ( int iSeqNum = 0; iSeqNum < 2; iSeqNum++ )
+    {
+        const SCoverage& Coverage = vecCoverage[iSeqNum];
+
+        printf ( "%-12s %10ld %8ld %8ld %10ld %10ld %10ld %10ld %12ld %10ld\n",
+                 iSeqNum ? "seq numbers" : "plain",
+                 Coverage.iNumCalls,
+                 Coverage.iNumInits[0],
+                 Coverage.iNumInits[1],
+                 Coverage.iNumWrapped[0],
+                 Coverage.iNumWrapped[1],
+                 Coverage.iNumPending[0],
+                 Coverage.iNumPending[1],
+                 Coverage.iNumReallocPending,
+                 Coverage.iNumMismatches );
+
+        for ( int iGrow = 0; iGrow < 2; iGrow++ )
+        {
+            if ( ( Coverage.iNumWrapped[iGrow] == 0 ) || ( Coverage.iNumPending[iGrow] == 0 ) )
+            {
+                fprintf ( stderr, "%s: a %s case was not covered\n", iSeqNum ? "seq numbers" : "plain", iGrow ? "grow" : "shrink" );
+                bFailed = true;
+            }
+        }
+
+        if ( Coverage.iNumReallocPending == 0 )
+        {
+            fprintf ( stderr, "%s: a pending block was never reallocated twice\n", iSeqNum ? "seq numbers" : "plain" );
+            bFailed = true;
+        }
+
+        if ( Coverage.iNumMismatches > 0 )
+        {
+            bFailed = true;
+        }
+    }
+
+    return bFailed ? 1 : 0;
+}
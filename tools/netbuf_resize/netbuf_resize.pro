@@ -0,0 +1,24 @@
+# Randomized comparison of the preserving jitter buffer resize with the copying
+# implementation, build and run with:
+#   qmake tools/netbuf_resize/netbuf_resize.pro && make && ./netbuf_resize
+
+TARGET = netbuf_resize
+TEMPLATE = app
+
+CONFIG += console \
+    c++17
+CONFIG -= app_bundle
+
+QT = core \
+    network
+
+DEFINES += HEADLESS \
+    APP_VERSION=\\\"netbuf_resize\\\"
+
+INCLUDEPATH += ../../src
+
+# util.h is not listed since its QObject classes are not used (no moc run)
+HEADERS += ../../src/buffer.h
+
+SOURCES += netbuf_resize.cpp \
+    ../../src/buffer.cpp
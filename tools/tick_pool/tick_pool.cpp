@@ -0,0 +1,247 @@
+/******************************************************************************\
+ * Copyright (c) 2023
+ *
+ * Author(s):
+ *  The Jamulus Development Team
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+/*
+ * Benchmark of the per-tick fan-out of the server: the channels are split into
+ * one block per thread (as in CServer::OnTimer()) and every tick runs two
+ * fan-outs (decode and mix/encode) with a synthetic per-channel work load.
+ * The fan-out through CThreadPool with one future per block (the processing
+ * before CTickWorkerPool) is compared with CTickWorkerPool. The ticks are
+ * paced with the tick period so that the wake up of idle workers is included.
+ *
+ * The program prints the latency of a fan-out (enqueue until all blocks are
+ * done) and exits with a non-zero code if a channel was not processed exactly
+ * once per fan-out.
+ *
+ * Usage: tick_pool [number of threads, default: number of cores]
+ *                  [number of channels, default 32]
+ *                  [work per channel in us, default 5]
+ *                  [number of ticks, default 5000]
+ *                  [tick period in us, 0: back to back, default 1333]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+#include "threadpool.h"
+
+/* Definitions ****************************************************************/
+// number of fan-outs per tick (decode and mix/encode)
+#define BENCH_NUM_FAN_OUTS_PER_TICK 2
+
+// ticks which are not measured (thread start, first allocations)
+#define BENCH_NUM_WARM_UP_TICKS 100
+
+/* Implementation *************************************************************/
+typedef std::chrono::steady_clock TClock;
+
+struct SBenchState
+{
+    std::vector<int> veciNumProcessed; // per channel, each channel is in one block only
+    int              iWorkNs;
+};
+
+static void ProcessChannels ( SBenchState* pState, const int iStart, const int iStop, const int iNumChannels )
+{
+    (void) iNumChannels;
+
+    for ( int i = iStart; i <= iStop; i++ )
+    {
+        // busy wait for the work of one channel (decoding or mixing/encoding)
+        const TClock::time_point End = TClock::now() + std::chrono::nanoseconds ( pState->iWorkNs );
+
+        while ( TClock::now() < End )
+        {
+        }
+
+        pState->veciNumProcessed[i]++;
+    }
+}
+
+class CFuturesFanOut
+{
+public:
+    CFuturesFanOut ( const int iNumThreads ) : ThreadPool ( static_cast<size_t> ( iNumThreads ) ) { Futures.reserve ( iNumThreads ); }
+
+    void Enqueue ( SBenchState* pState, const int iStart, const int iStop, const int iNumChannels )
+    {
+        Futures.push_back ( ThreadPool.enqueue ( ProcessChannels, pState, iStart, iStop, iNumChannels ) );
+    }
+
+    void RunAndWait()
+    {
+        for ( auto& Future : Futures )
+        {
+            Future.wait();
+        }
+        Futures.clear();
+    }
+
+protected:
+    CThreadPool                    ThreadPool;
+    std::vector<std::future<void>> Futures;
+};
+
+class CTickPoolFanOut
+{
+public:
+    // the calling thread takes part in the processing (as in the server)
+    CTickPoolFanOut ( const int iNumThreads ) : ThreadPool ( static_cast<size_t> ( iNumThreads - 1 ), static_cast<size_t> ( iNumThreads ) ) {}
+
+    void Enqueue ( SBenchState* pState, const int iStart, const int iStop, const int iNumChannels )
+    {
+        ThreadPool.Enqueue ( ProcessChannels, pState, iStart, iStop, iNumChannels );
+    }
+
+    void RunAndWait() { ThreadPool.RunAndWait(); }
+
+protected:
+    CTickWorkerPool<SBenchState> ThreadPool;
+};
+
+template<class TFanOut>
+static int RunBench ( const char* strName,
+                      const int   iNumThreads,
+                      const int   iNumChannels,
+                      const int   iWorkNs,
+                      const int   iNumTicks,
+                      const int   iTickPeriodUs )
+{
+    TFanOut     FanOut ( iNumThreads );
+    SBenchState State;
+
+    State.veciNumProcessed.assign ( iNumChannels, 0 );
+    State.iWorkNs = iWorkNs;
+
+    // same block partitioning as the server
+    const int iNumBlocks   = std::min ( iNumChannels, iNumThreads );
+    const int iMTBlockSize = ( iNumChannels - 1 ) / iNumBlocks + 1;
+
+    std::vector<double> vecdLatencyUs;
+    vecdLatencyUs.reserve ( iNumTicks * BENCH_NUM_FAN_OUTS_PER_TICK );
+
+    int                iNumErrors = 0;
+    TClock::time_point NextTick   = TClock::now();
+
+    for ( int iTick = -BENCH_NUM_WARM_UP_TICKS; iTick < iNumTicks; iTick++ )
+    {
+        if ( iTickPeriodUs > 0 )
+        {
+            NextTick += std::chrono::microseconds ( iTickPeriodUs );
+            std::this_thread::sleep_until ( NextTick );
+        }
+
+        for ( int iFanOut = 0; iFanOut < BENCH_NUM_FAN_OUTS_PER_TICK; iFanOut++ )
+        {
+            const TClock::time_point Start = TClock::now();
+
+            for ( int iBlockCnt = 0; iBlockCnt < iNumBlocks; iBlockCnt++ )
+            {
+                const int iStartChanCnt = iBlockCnt * iMTBlockSize;
+                const int iStopChanCnt  = std::min ( ( iBlockCnt + 1 ) * iMTBlockSize - 1, iNumChannels - 1 );
+
+                FanOut.Enqueue ( &State, iStartChanCnt, iStopChanCnt, iNumChannels );
+            }
+
+            FanOut.RunAndWait();
+
+            const TClock::time_point Stop = TClock::now();
+
+            // all channels must be processed exactly once by this fan-out
+            for ( int i = 0; i < iNumChannels; i++ )
+            {
+                if ( State.veciNumProcessed[i] != 1 )
+                {
+                    iNumErrors++;
+                }
+
+                State.veciNumProcessed[i] = 0;
+            }
+
+            if ( iTick >= 0 )
+            {
+                vecdLatencyUs.push_back ( std::chrono::duration<double, std::micro> ( Stop - Start ).count() );
+            }
+        }
+    }
+
+    std::sort ( vecdLatencyUs.begin(), vecdLatencyUs.end() );
+
+    const size_t iNumValues = vecdLatencyUs.size();
+    double       dSumUs     = 0;
+
+    for ( const double dLatencyUs : vecdLatencyUs )
+    {
+        dSumUs += dLatencyUs;
+    }
+
+    printf ( "%-16s %10.1f %10.1f %10.1f %10.1f %10.1f %8d\n",
+             strName,
+             dSumUs / iNumValues,
+             vecdLatencyUs[iNumValues / 2],
+             vecdLatencyUs[iNumValues * 99 / 100],
+             vecdLatencyUs[iNumValues * 999 / 1000],
+             vecdLatencyUs[iNumValues - 1],
+             iNumErrors );
+
+    return iNumErrors;
+}
+
+int main ( int argc, char** argv )
+{
+    const int iNumCores     = std::max ( static_cast<int> ( std::thread::hardware_concurrency() ), 1 );
+    const int iNumThreads   = ( argc > 1 ) ? atoi ( argv[1] ) : iNumCores;
+    const int iNumChannels  = ( argc > 2 ) ? atoi ( argv[2] ) : 32;
+    const int iWorkUs       = ( argc > 3 ) ? atoi ( argv[3] ) : 5;
+    const int iNumTicks     = ( argc > 4 ) ? atoi ( argv[4] ) : 5000;
+    const int iTickPeriodUs = ( argc > 5 ) ? atoi ( argv[5] ) : 1333;
+
+    if ( ( iNumThreads < 1 ) || ( iNumChannels < 1 ) || ( iWorkUs < 0 ) || ( iNumTicks < 1 ) || ( iTickPeriodUs < 0 ) )
+    {
+        fprintf ( stderr, "usage: %s [threads] [channels] [work per channel in us] [ticks] [tick period in us]\n", argv[0] );
+        return 2;
+    }
+
+    printf ( "%d threads (%d cores), %d channels, %d us work per channel, %d ticks, tick period %d us\n",
+             iNumThreads,
+             iNumCores,
+             iNumChannels,
+             iWorkUs,
+             iNumTicks,
+             iTickPeriodUs );
+
+    printf ( "fan-out latency in us:\n" );
+    printf ( "%-16s %10s %10s %10s %10s %10s %8s\n", "pool", "mean", "p50", "p99", "p99.9", "max", "errors" );
+
+    int iNumErrors = 0;
+
+    iNumErrors += RunBench<CFuturesFanOut> ( "futures", iNumThreads, iNumChannels, iWorkUs * 1000, iNumTicks, iTickPeriodUs );
+    iNumErrors += RunBench<CTickPoolFanOut> ( "tick pool", iNumThreads, iNumChannels, iWorkUs * 1000, iNumTicks, iTickPeriodUs );
+
+    return ( iNumErrors == 0 ) ? 0 : 1;
+}
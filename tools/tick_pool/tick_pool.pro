@@ -0,0 +1,17 @@
+# Benchmark of the server tick fan-out (futures vs. tick worker pool), build and run with:
+#   qmake tools/tick_pool/tick_pool.pro && make && ./tick_pool
+
+TARGET = tick_pool
+TEMPLATE = app
+
+CONFIG += console \
+    c++17 \
+    thread
+CONFIG -= app_bundle \
+    qt
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/threadpool.h
+
+SOURCES += tick_pool.cpp